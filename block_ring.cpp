@@ -0,0 +1,281 @@
+#include "block_ring.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Start of the shared mapping. The slot array follows the header, and the
+ * block data starts on the next page, one page-rounded stride per slot.
+ * Positions count blocks since the ring was created and never wrap.
+ */
+struct BlockRingHeader {
+    std::atomic<uint64_t> magic;                 // Set last by the producer
+    uint64_t block_bytes;
+    uint64_t block_stride;                       // block_bytes rounded up to a page
+    uint64_t blocks;
+    uint64_t data_offset;                        // Byte of the mapping where slot 0's data starts
+    uint64_t register_size;
+    uint64_t polynomial;
+    uint64_t initial_state;                      // Register at byte 0 of the stream
+    int64_t producer_pid;                        // Checked by waiting consumers
+    alignas(64) std::atomic<uint64_t> produce_pos;
+    std::atomic<uint32_t> filled_seq;            // Futex: bumped after publishing or closing
+    std::atomic<uint32_t> consumers_waiting;
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> claim_pos;
+    alignas(64) std::atomic<uint64_t> released;
+    std::atomic<uint32_t> freed_seq;             // Futex: bumped after releasing or closing
+    std::atomic<uint32_t> producer_waiting;
+    alignas(64) std::atomic<uint64_t> producer_waits;
+    std::atomic<uint64_t> consumer_waits;
+};
+
+/**
+ * Per-slot state: sequence p means free for block p, p + 1 means holding
+ * block p. Each slot has a cache line of its own.
+ */
+struct alignas(64) BlockRingSlot {
+    std::atomic<uint64_t> sequence;
+    uint64_t stream_offset;
+};
+
+namespace {
+
+constexpr uint64_t RING_MAGIC = 0x474E49524B4C4246ULL;  // "FBLKRING"
+constexpr size_t PAGE_BYTES = 4096;
+
+// How often a waiting consumer checks that the producer is still there
+constexpr long CONSUMER_WAIT_NS = 100 * 1000 * 1000;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared counters must be lock-free");
+
+size_t pageRound(size_t bytes) {
+    return (bytes + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+}
+
+void validateName(const std::string& name) {
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+        throw std::invalid_argument("Shared memory name must be '/' followed by a name without '/': " + name);
+    }
+}
+
+BlockRingStats readStats(const BlockRingHeader& header) {
+    return BlockRingStats{header.produce_pos.load(), header.released.load(),
+                          header.producer_waits.load(), header.consumer_waits.load()};
+}
+
+} // namespace
+
+BlockRingProducer::BlockRingProducer(const std::string& shm_name, const LFSR& stream, uint64_t offset,
+                                     const BlockRingOptions& options)
+    : name(shm_name), generator(stream), next_offset(offset) {
+    validateName(shm_name);
+    if (options.block_bytes == 0 || options.blocks == 0 ||
+        options.blocks > (SIZE_MAX / 2) / pageRound(options.block_bytes)) {
+        throw std::invalid_argument("Block ring needs non-zero block size and count");
+    }
+    const size_t stride = pageRound(options.block_bytes);
+    const size_t data_offset = pageRound(sizeof(BlockRingHeader) + options.blocks * sizeof(BlockRingSlot));
+    map_bytes = data_offset + options.blocks * stride;
+
+    int fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw systemError("Cannot create shared memory " + shm_name, errno);
+    }
+    void* mapping = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(map_bytes)) == 0) {
+        mapping = ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(shm_name.c_str());
+        throw systemError("Cannot map shared memory " + shm_name, error);
+    }
+
+    header = new (mapping) BlockRingHeader();
+    header->block_bytes = options.block_bytes;
+    header->block_stride = stride;
+    header->blocks = options.blocks;
+    header->data_offset = data_offset;
+    header->register_size = stream.getSize();
+    header->polynomial = stream.getPolynomial();
+    header->initial_state = stream.getState();
+    header->producer_pid = ::getpid();
+    slots = reinterpret_cast<BlockRingSlot*>(static_cast<uint8_t*>(mapping) + sizeof(BlockRingHeader));
+    for (size_t i = 0; i < options.blocks; i++) {
+        BlockRingSlot* slot = new (&slots[i]) BlockRingSlot();
+        slot->sequence.store(i);
+    }
+    data = static_cast<uint8_t*>(mapping) + data_offset;
+
+    generator.jumpBytes(offset);
+
+    // Consumers check the magic first, so it goes in once the rest is set
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+}
+
+BlockRingProducer::~BlockRingProducer() {
+    close();
+    ::munmap(header, map_bytes);
+    ::shm_unlink(name.c_str());
+}
+
+bool BlockRingProducer::produce() {
+    const uint64_t position = header->produce_pos.load(std::memory_order_relaxed);
+    BlockRingSlot& slot = slots[position % header->blocks];
+    for (;;) {
+        if (header->closed.load()) {
+            return false;
+        }
+        if (slot.sequence.load(std::memory_order_acquire) == position) {
+            break;
+        }
+        header->producer_waits.fetch_add(1, std::memory_order_relaxed);
+        uint32_t seq = header->freed_seq.load();
+        header->producer_waiting.store(1);
+        if (slot.sequence.load() != position && !header->closed.load()) {
+            futexWait(header->freed_seq, seq);
+        }
+        header->producer_waiting.store(0);
+    }
+
+    const size_t bytes = static_cast<size_t>(header->block_bytes);
+    generator.fill(data + (position % header->blocks) * header->block_stride, bytes);
+    slot.stream_offset = next_offset;
+    next_offset += bytes;
+    slot.sequence.store(position + 1, std::memory_order_release);
+    header->produce_pos.store(position + 1);
+    publish(header->filled_seq, header->consumers_waiting);
+    return true;
+}
+
+void BlockRingProducer::close() {
+    if (header->closed.exchange(1) == 0) {
+        header->filled_seq.fetch_add(1);
+        futexWake(header->filled_seq);
+        header->freed_seq.fetch_add(1);
+        futexWake(header->freed_seq);
+    }
+}
+
+BlockRingStats BlockRingProducer::getStats() const {
+    return readStats(*header);
+}
+
+BlockRingConsumer::BlockRingConsumer(const std::string& shm_name)
+    : stream(2, 1, 1) {  // Replaced once the header is mapped
+    validateName(shm_name);
+    int fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        throw systemError("Cannot open shared memory " + shm_name, errno);
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(BlockRingHeader)) {
+        map_bytes = static_cast<size_t>(info.st_size);
+        mapping = ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw systemError("Cannot map shared memory " + shm_name, error);
+    }
+
+    header = static_cast<BlockRingHeader*>(mapping);
+    if (header->magic.load(std::memory_order_acquire) != RING_MAGIC || header->blocks == 0 ||
+        header->data_offset + header->blocks * header->block_stride != map_bytes ||
+        header->block_bytes > header->block_stride) {
+        ::munmap(mapping, map_bytes);
+        throw std::runtime_error("Not a block ring, or not yet initialized: " + shm_name);
+    }
+    slots = reinterpret_cast<BlockRingSlot*>(static_cast<uint8_t*>(mapping) + sizeof(BlockRingHeader));
+    data = static_cast<uint8_t*>(mapping) + header->data_offset;
+    try {
+        stream = LFSR(static_cast<uint8_t>(header->register_size), header->polynomial, header->initial_state);
+    } catch (...) {
+        ::munmap(mapping, map_bytes);
+        throw;
+    }
+}
+
+BlockRingConsumer::~BlockRingConsumer() {
+    ::munmap(header, map_bytes);
+}
+
+bool BlockRingConsumer::acquire(BlockView& view) {
+    const uint64_t blocks = header->blocks;
+    uint64_t position = header->claim_pos.load();
+    for (;;) {
+        BlockRingSlot& slot = slots[position % blocks];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position + 1) {
+            if (header->claim_pos.compare_exchange_weak(position, position + 1)) {
+                view.sequence = position;
+                view.stream_offset = slot.stream_offset;
+                view.data = data + (position % blocks) * header->block_stride;
+                view.bytes = static_cast<size_t>(header->block_bytes);
+                view.slot = static_cast<size_t>(position % blocks);
+                return true;
+            }
+            continue;  // Another consumer won; position now holds the new claim
+        }
+        if (sequence > position + 1) {
+            // Claimed and already recycled; the counter has moved on
+            position = header->claim_pos.load();
+            continue;
+        }
+
+        // Nothing published at this position yet. The producer publishes
+        // before it closes, so after seeing closed one more look settles it
+        if (header->closed.load()) {
+            if (slot.sequence.load() == position + 1) {
+                continue;
+            }
+            return false;
+        }
+        header->consumer_waits.fetch_add(1, std::memory_order_relaxed);
+        uint32_t seq = header->filled_seq.load();
+        header->consumers_waiting.fetch_add(1);
+        if (slot.sequence.load() != position + 1 && header->claim_pos.load() == position &&
+            !header->closed.load()) {
+            // Wake up now and then to notice a producer that died
+            // without closing the ring
+            timespec timeout{0, CONSUMER_WAIT_NS};
+            futexWait(header->filled_seq, seq, &timeout);
+            if (::kill(static_cast<pid_t>(header->producer_pid), 0) != 0 && errno == ESRCH) {
+                header->closed.store(1);
+            }
+        }
+        header->consumers_waiting.fetch_sub(1);
+        position = header->claim_pos.load();
+    }
+}
+
+void BlockRingConsumer::release(const BlockView& view) {
+    slots[view.slot].sequence.store(view.sequence + header->blocks, std::memory_order_release);
+    header->released.fetch_add(1);
+    publish(header->freed_seq, header->producer_waiting);
+}
+
+bool BlockRingConsumer::verify(const BlockView& view) const {
+    LFSR generator = stream;
+    generator.jumpBytes(view.stream_offset);
+    std::vector<uint8_t> expected(view.bytes);
+    generator.fill(expected.data(), view.bytes);
+    return std::memcmp(expected.data(), view.data, view.bytes) == 0;
+}
+
+BlockRingStats BlockRingConsumer::getStats() const {
+    return readStats(*header);
+}
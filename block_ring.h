@@ -0,0 +1,193 @@
+#ifndef BLOCK_RING_H
+#define BLOCK_RING_H
+
+#include "lfsr.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of a ring in shared memory, defined in block_ring.cpp
+struct BlockRingHeader;
+struct BlockRingSlot;
+
+/**
+ * @struct BlockRingOptions
+ * @brief Geometry of a BlockRingProducer's ring
+ */
+struct BlockRingOptions {
+    size_t block_bytes = 1 << 20;  // Bytes of sequence per block
+    size_t blocks = 16;            // Blocks the ring holds
+};
+
+/**
+ * @struct BlockView
+ * @brief A block claimed by BlockRingConsumer::acquire()
+ */
+struct BlockView {
+    uint64_t sequence;        // Block number, counting from 0 at the producer's offset
+    uint64_t stream_offset;   // Byte of the register stream the block starts at
+    const uint8_t* data;      // Generated bytes, page-aligned
+    size_t bytes;             // Length of data
+    size_t slot;              // Ring slot, used by release()
+};
+
+/**
+ * @struct BlockRingStats
+ * @brief Counters kept in the shared mapping
+ */
+struct BlockRingStats {
+    uint64_t blocks_produced;   // Blocks published
+    uint64_t blocks_released;   // Blocks handed back by consumers
+    uint64_t producer_waits;    // Times the producer found its next slot still claimed
+    uint64_t consumer_waits;    // Times a consumer found no block to claim
+};
+
+/**
+ * @class BlockRingProducer
+ * @brief Fills a POSIX shared-memory ring with consecutive blocks of a stream
+ *
+ * The ring lives in a shm_open() object that any number of consumer
+ * processes map with BlockRingConsumer. Each block is claimed by exactly
+ * one consumer, so the ring fans work out without copying through pipes
+ * or sockets.
+ *
+ * Slots carry sequence numbers in the style of a bounded MPMC queue: the
+ * slot for block p is free when its sequence is p, holds block p when it
+ * is p + 1, and becomes free for block p + N (N slots) when the consumer
+ * releases it. Consumers claim blocks with a compare-and-swap on a shared
+ * counter and may release them in any order; nobody takes a lock. Waiting
+ * sides sleep on futexes in the mapping.
+ *
+ * Blocks are consecutive pieces of one stream, generated with LFSR::fill(),
+ * and each carries its byte offset in the stream. The register's
+ * polynomial and initial state are stored in the ring too, so a consumer
+ * can regenerate any block by jump-ahead to check or reproduce it.
+ *
+ * A consumer that dies holding a block stalls the producer once it comes
+ * back around to that slot. A producer process that exits without
+ * closing the ring is noticed by waiting consumers, which then treat the
+ * ring as closed.
+ */
+class BlockRingProducer {
+private:
+    std::string name;
+    BlockRingHeader* header = nullptr;
+    BlockRingSlot* slots = nullptr;
+    uint8_t* data = nullptr;
+    size_t map_bytes = 0;
+    LFSR generator;            // Register at the start of the next block
+    uint64_t next_offset;      // Stream byte of the next block
+
+public:
+    /**
+     * @brief Constructor: create the shared-memory ring
+     * @param shm_name Name for shm_open(), starting with '/'
+     * @param stream Register at byte 0 of the stream, not modified
+     * @param offset Stream byte of the first block
+     * @param options Block size and ring length
+     * @throw std::invalid_argument if the name or geometry is invalid
+     * @throw std::runtime_error if the object exists or cannot be created
+     */
+    BlockRingProducer(const std::string& shm_name, const LFSR& stream, uint64_t offset = 0,
+                      const BlockRingOptions& options = BlockRingOptions());
+
+    BlockRingProducer(const BlockRingProducer&) = delete;
+    BlockRingProducer& operator=(const BlockRingProducer&) = delete;
+
+    /**
+     * @brief Destructor: close the ring and remove its name
+     *
+     * Consumers that already mapped the ring drain the remaining blocks.
+     */
+    ~BlockRingProducer();
+
+    /**
+     * @brief Generate and publish the next block
+     * @return false if the ring was closed
+     *
+     * Blocks while the slot is still claimed by a consumer.
+     */
+    bool produce();
+
+    /**
+     * @brief Publish no more blocks
+     *
+     * Consumers see the end of the stream once they have drained the
+     * ring. May be called from another thread to end a waiting produce().
+     */
+    void close();
+
+    /**
+     * @brief Get counters of the ring
+     * @return Counters as seen by all processes
+     */
+    BlockRingStats getStats() const;
+};
+
+/**
+ * @class BlockRingConsumer
+ * @brief Claims blocks from a ring created by BlockRingProducer
+ */
+class BlockRingConsumer {
+private:
+    BlockRingHeader* header = nullptr;
+    BlockRingSlot* slots = nullptr;
+    uint8_t* data = nullptr;
+    size_t map_bytes = 0;
+    LFSR stream;               // Register at byte 0 of the stream
+
+public:
+    /**
+     * @brief Constructor: map an existing ring
+     * @param shm_name Name the producer was created with
+     * @throw std::runtime_error if the ring does not exist or is malformed
+     */
+    explicit BlockRingConsumer(const std::string& shm_name);
+
+    BlockRingConsumer(const BlockRingConsumer&) = delete;
+    BlockRingConsumer& operator=(const BlockRingConsumer&) = delete;
+
+    /**
+     * @brief Destructor: unmap the ring
+     */
+    ~BlockRingConsumer();
+
+    /**
+     * @brief Claim the next unclaimed block
+     * @param view Receives the block
+     * @return false once the producer has closed, or its process has
+     *         exited, and the ring is drained
+     *
+     * Blocks while no block is available, checking every 100 ms that the
+     * producer process is still running. The data stays valid until the
+     * block is released.
+     */
+    bool acquire(BlockView& view);
+
+    /**
+     * @brief Hand a claimed block back to the producer
+     * @param view Block from acquire()
+     */
+    void release(const BlockView& view);
+
+    /**
+     * @brief Regenerate a block and compare it with its data
+     * @param view Block from acquire()
+     * @return true if the data is the stream at view.stream_offset
+     */
+    bool verify(const BlockView& view) const;
+
+    /**
+     * @brief Get the register the blocks are generated from
+     * @return Register at byte 0 of the stream
+     */
+    const LFSR& getStream() const { return stream; }
+
+    /**
+     * @brief Get counters of the ring
+     * @return Counters as seen by all processes
+     */
+    BlockRingStats getStats() const;
+};
+
+#endif // BLOCK_RING_H
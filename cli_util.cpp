@@ -0,0 +1,25 @@
+#include "cli_util.h"
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+
+uint64_t parseSize(const std::string& text, const char* option) {
+    errno = 0;
+    char* end = nullptr;
+    uint64_t value = std::strtoull(text.c_str(), &end, 0);
+    if (end == text.c_str() || errno != 0 || text[0] == '-') {
+        throw std::invalid_argument(std::string("Invalid value for ") + option + ": " + text);
+    }
+    int shift = 0;
+    switch (*end) {
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+        case 't': case 'T': shift = 40; end++; break;
+        default: break;
+    }
+    if (*end != '\0' || (shift != 0 && value > (~0ULL >> shift))) {
+        throw std::invalid_argument(std::string("Invalid value for ") + option + ": " + text);
+    }
+    return value << shift;
+}
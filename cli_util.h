@@ -0,0 +1,21 @@
+#ifndef CLI_UTIL_H
+#define CLI_UTIL_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * @file cli_util.h
+ * @brief Option parsing shared by the command-line tools
+ */
+
+/**
+ * @brief Parse an unsigned number with an optional binary size suffix
+ * @param text Number in decimal, or hex with 0x, then K, M, G or T
+ * @param option Option name for the error message
+ * @return Parsed value
+ * @throw std::invalid_argument if the text is not a number
+ */
+uint64_t parseSize(const std::string& text, const char* option);
+
+#endif // CLI_UTIL_H
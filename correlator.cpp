@@ -0,0 +1,143 @@
+#include "correlator.h"
+#include "gf2poly.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CORRELATOR_HAVE_AVX 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Blocks transformed together by correlateBatch()
+constexpr size_t GROUP_BLOCKS = 8;
+
+// Rows of the transform kept in cache while its first stages run
+constexpr size_t LOCAL_FLOATS = 8192;
+
+// (x, y) <- (x + y, x - y) element-wise
+void butterflyScalar(float* x, float* y, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        float a = x[k], b = y[k];
+        x[k] = a + b;
+        y[k] = a - b;
+    }
+}
+
+#ifdef CORRELATOR_HAVE_AVX
+__attribute__((target("avx")))
+void butterflyAVX(float* x, float* y, size_t count) {
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256 a = _mm256_loadu_ps(x + k);
+        __m256 b = _mm256_loadu_ps(y + k);
+        _mm256_storeu_ps(x + k, _mm256_add_ps(a, b));
+        _mm256_storeu_ps(y + k, _mm256_sub_ps(a, b));
+    }
+    butterflyScalar(x + k, y + k, count - k);
+}
+#endif
+
+} // namespace
+
+MSequenceCorrelator::MSequenceCorrelator(const LFSR& reference)
+    : degree(reference.getSize()), length(0), use_avx(false) {
+
+    if (degree > 24) {
+        throw std::invalid_argument("Correlator register size must be at most 24 bits");
+    }
+    length = static_cast<uint32_t>(reference.getMaxPeriod());
+    const uint64_t polynomial = reference.getPolynomial();
+
+    // State t is the window of sequence bits t .. t+n-1: the initial
+    // state followed by the register's output
+    LFSR generator = reference;
+    std::vector<uint64_t> output((length + 63) / 64);
+    generator.fillBlocks(output.data(), output.size());
+
+    input_index.resize(length);
+    const uint64_t start = reference.getState();
+    uint64_t state = start;
+    for (uint32_t t = 0; t < length; t++) {
+        if (t > 0 && state == start) {
+            throw std::invalid_argument("Correlator register must have period 2^n - 1");
+        }
+        input_index[t] = static_cast<uint32_t>(state);
+        uint64_t next = (output[t / 64] >> (t % 64)) & 1;
+        state = (state >> 1) | (next << (degree - 1));
+    }
+
+    // Output bit t + k is <x^(k+n) mod P, state t>; shift tau pairs
+    // sample t with bit t - tau, i.e. k = N - tau
+    output_index.resize(length);
+    uint64_t functional = polynomial;
+    for (uint32_t k = 0; k < length; k++) {
+        output_index[(length - k) % length] = static_cast<uint32_t>(functional);
+        functional = gf2MulX(functional, polynomial, degree);
+    }
+
+#ifdef CORRELATOR_HAVE_AVX
+    use_avx = __builtin_cpu_supports("avx");
+#endif
+}
+
+void MSequenceCorrelator::transform(float* data, size_t width) const {
+    const size_t rows = size_t(1) << degree;
+    auto butterfly = butterflyScalar;
+#ifdef CORRELATOR_HAVE_AVX
+    if (use_avx) butterfly = butterflyAVX;
+#endif
+
+    // Stages with short spans run chunk by chunk while the chunk is in
+    // cache; the remaining stages sweep the whole array
+    size_t local_rows = 2;
+    while (local_rows < rows && 2 * local_rows * width <= LOCAL_FLOATS) {
+        local_rows <<= 1;
+    }
+    for (size_t base = 0; base < rows; base += local_rows) {
+        for (size_t h = 1; h < local_rows; h <<= 1) {
+            for (size_t i = base; i < base + local_rows; i += 2 * h) {
+                butterfly(data + i * width, data + (i + h) * width, h * width);
+            }
+        }
+    }
+    for (size_t h = local_rows; h < rows; h <<= 1) {
+        for (size_t i = 0; i < rows; i += 2 * h) {
+            butterfly(data + i * width, data + (i + h) * width, h * width);
+        }
+    }
+}
+
+void MSequenceCorrelator::correlate(const float* samples, float* out) const {
+    correlateBatch(samples, 1, out);
+}
+
+void MSequenceCorrelator::correlateBatch(const float* samples, size_t blocks, float* out) const {
+    const size_t rows = size_t(1) << degree;
+    std::vector<float> work(rows * std::min(blocks, GROUP_BLOCKS));
+
+    for (size_t first = 0; first < blocks; first += GROUP_BLOCKS) {
+        const size_t width = std::min(GROUP_BLOCKS, blocks - first);
+        const float* in = samples + first * length;
+        float* result = out + first * length;
+
+        // Row 0 (the all-zero state) never receives a sample
+        std::fill(work.begin(), work.begin() + width, 0.0f);
+        for (uint32_t t = 0; t < length; t++) {
+            float* row = &work[size_t(input_index[t]) * width];
+            for (size_t b = 0; b < width; b++) {
+                row[b] = in[b * length + t];
+            }
+        }
+
+        transform(work.data(), width);
+
+        for (uint32_t tau = 0; tau < length; tau++) {
+            const float* row = &work[size_t(output_index[tau]) * width];
+            for (size_t b = 0; b < width; b++) {
+                result[b * length + tau] = row[b];
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CORRELATOR_H
+#define CORRELATOR_H
+
+#include "lfsr.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class MSequenceCorrelator
+ * @brief All-shift correlation against an m-sequence in O(N log N)
+ *
+ * Correlates real-valued blocks of N = 2^n - 1 samples with every cyclic
+ * shift of the reference register's output (bit 0 as +1, bit 1 as -1)
+ * using the fast M-sequence transform. Each output bit is a linear
+ * function of the register state at any earlier step, so scattering the
+ * samples by register state turns the correlation into a Walsh-Hadamard
+ * transform of length 2^n; each shift is then read from the transform
+ * bin of the functional that yields the paired bit from state t.
+ *
+ * Blocks are transformed in groups of eight, interleaved so that every
+ * butterfly stage works on contiguous rows of floats.
+ */
+class MSequenceCorrelator {
+private:
+    int degree;                          // n
+    uint32_t length;                     // N = 2^n - 1
+    std::vector<uint32_t> input_index;   // Transform bin of sample t (register state)
+    std::vector<uint32_t> output_index;  // Transform bin holding shift tau
+    bool use_avx;                        // AVX butterflies are available
+
+    /**
+     * @brief In-place Walsh-Hadamard transform of interleaved rows
+     * @param data 2^n rows of width floats
+     * @param width Floats per row
+     */
+    void transform(float* data, size_t width) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param reference Register producing the reference sequence from
+     *        its current state
+     * @throw std::invalid_argument if the register is longer than 24 bits
+     *        or does not have period 2^n - 1
+     */
+    explicit MSequenceCorrelator(const LFSR& reference);
+
+    /**
+     * @brief Correlate one block
+     * @param samples N samples
+     * @param out N results, out[tau] = sum over t of
+     *        samples[t] * (-1)^c[(t - tau) mod N], so a copy of the
+     *        sequence delayed by d chips peaks at out[d]
+     */
+    void correlate(const float* samples, float* out) const;
+
+    /**
+     * @brief Correlate consecutive blocks
+     * @param samples blocks * N samples, block after block
+     * @param blocks Number of blocks
+     * @param out blocks * N results, in the same layout
+     */
+    void correlateBatch(const float* samples, size_t blocks, float* out) const;
+
+    /**
+     * @brief Get sequence period
+     * @return N, the block length
+     */
+    uint32_t getLength() const { return length; }
+};
+
+#endif // CORRELATOR_H
@@ -0,0 +1,419 @@
+#include "crc.h"
+#include "gf2poly.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC_HAVE_CLMUL 1
+#include <immintrin.h>
+#endif
+
+const CRCParameters CRC8_SMBUS =
+    {"CRC-8/SMBUS", 8, 0x07, 0x00, false, false, 0x00, 0xF4};
+const CRCParameters CRC16_ARC =
+    {"CRC-16/ARC", 16, 0x8005, 0x0000, true, true, 0x0000, 0xBB3D};
+const CRCParameters CRC16_CCITT_FALSE =
+    {"CRC-16/CCITT-FALSE", 16, 0x1021, 0xFFFF, false, false, 0x0000, 0x29B1};
+const CRCParameters CRC32_ISO_HDLC =
+    {"CRC-32", 32, 0x04C11DB7, 0xFFFFFFFF, true, true, 0xFFFFFFFF, 0xCBF43926};
+const CRCParameters CRC32_ISCSI =
+    {"CRC-32C", 32, 0x1EDC6F41, 0xFFFFFFFF, true, true, 0xFFFFFFFF, 0xE3069283};
+const CRCParameters CRC32_BZIP2 =
+    {"CRC-32/BZIP2", 32, 0x04C11DB7, 0xFFFFFFFF, false, false, 0xFFFFFFFF, 0xFC891918};
+const CRCParameters CRC64_XZ =
+    {"CRC-64/XZ", 64, 0x42F0E1EBA9EA3693ULL, ~0ULL, true, true, ~0ULL, 0x995DC9BBDF1939FAULL};
+const CRCParameters CRC64_ECMA_182 =
+    {"CRC-64/ECMA-182", 64, 0x42F0E1EBA9EA3693ULL, 0, false, false, 0, 0x6C40DF5F0B497347ULL};
+
+namespace {
+
+// Smallest chunk worth handing to its own thread
+constexpr size_t MIN_PARALLEL_CHUNK = 1 << 16;
+
+uint64_t widthMask(int width) {
+    return width >= 64 ? ~0ULL : (1ULL << width) - 1;
+}
+
+uint64_t reflect(uint64_t value, int width) {
+    uint64_t result = 0;
+    for (int i = 0; i < width; i++) {
+        result |= ((value >> i) & 1) << (width - 1 - i);
+    }
+    return result;
+}
+
+uint64_t loadLE64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+uint64_t loadBE64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+#ifdef CRC_HAVE_CLMUL
+
+// Fold a 128-bit remainder forward by the distance its constants encode
+__attribute__((target("pclmul,sse2")))
+inline __m128i foldBlock(__m128i value, __m128i constants) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x00),
+                         _mm_clmulepi64_si128(value, constants, 0x11));
+}
+
+// In the reflected domain the low qword holds the higher-degree half, so
+// it is multiplied by x^(D+63) and the high qword by x^(D-1); the missing
+// factor x comes from the one-bit offset of a reflected product.
+__attribute__((target("pclmul,sse2")))
+size_t foldReflected(uint64_t reg, const uint8_t* data, size_t len,
+                     const uint64_t k512[2], const uint64_t k128[2], uint8_t remainder[16]) {
+    const __m128i c512 = _mm_set_epi64x(static_cast<long long>(k512[1]), static_cast<long long>(k512[0]));
+    const __m128i c128 = _mm_set_epi64x(static_cast<long long>(k128[1]), static_cast<long long>(k128[0]));
+    const __m128i* blocks = reinterpret_cast<const __m128i*>(data);
+    
+    // The register enters as a XOR into the first input bytes
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128(blocks), _mm_cvtsi64_si128(static_cast<long long>(reg)));
+    __m128i x1 = _mm_loadu_si128(blocks + 1);
+    __m128i x2 = _mm_loadu_si128(blocks + 2);
+    __m128i x3 = _mm_loadu_si128(blocks + 3);
+    size_t offset = 64;
+    
+    for (; offset + 64 <= len; offset += 64) {
+        blocks = reinterpret_cast<const __m128i*>(data + offset);
+        x0 = _mm_xor_si128(foldBlock(x0, c512), _mm_loadu_si128(blocks));
+        x1 = _mm_xor_si128(foldBlock(x1, c512), _mm_loadu_si128(blocks + 1));
+        x2 = _mm_xor_si128(foldBlock(x2, c512), _mm_loadu_si128(blocks + 2));
+        x3 = _mm_xor_si128(foldBlock(x3, c512), _mm_loadu_si128(blocks + 3));
+    }
+    
+    __m128i x = _mm_xor_si128(foldBlock(x0, c128), x1);
+    x = _mm_xor_si128(foldBlock(x, c128), x2);
+    x = _mm_xor_si128(foldBlock(x, c128), x3);
+    
+    for (; offset + 16 <= len; offset += 16) {
+        x = _mm_xor_si128(foldBlock(x, c128), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset)));
+    }
+    
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(remainder), x);
+    return offset;
+}
+
+// Non-reflected CRCs fold the same way on byte-swapped blocks, where the
+// high qword holds the higher-degree half and products need no shift:
+// the constants are x^D for the low qword and x^(D+64) for the high one.
+__attribute__((target("ssse3")))
+inline __m128i loadSwapped(const uint8_t* data, __m128i swap) {
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), swap);
+}
+
+__attribute__((target("pclmul,ssse3")))
+size_t foldNormal(uint64_t reg, const uint8_t* data, size_t len,
+                  const uint64_t k512[2], const uint64_t k128[2], uint8_t remainder[16]) {
+    const __m128i c512 = _mm_set_epi64x(static_cast<long long>(k512[1]), static_cast<long long>(k512[0]));
+    const __m128i c128 = _mm_set_epi64x(static_cast<long long>(k128[1]), static_cast<long long>(k128[0]));
+    const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    
+    __m128i x0 = _mm_xor_si128(loadSwapped(data, swap), _mm_set_epi64x(static_cast<long long>(reg), 0));
+    __m128i x1 = loadSwapped(data + 16, swap);
+    __m128i x2 = loadSwapped(data + 32, swap);
+    __m128i x3 = loadSwapped(data + 48, swap);
+    size_t offset = 64;
+    
+    for (; offset + 64 <= len; offset += 64) {
+        x0 = _mm_xor_si128(foldBlock(x0, c512), loadSwapped(data + offset, swap));
+        x1 = _mm_xor_si128(foldBlock(x1, c512), loadSwapped(data + offset + 16, swap));
+        x2 = _mm_xor_si128(foldBlock(x2, c512), loadSwapped(data + offset + 32, swap));
+        x3 = _mm_xor_si128(foldBlock(x3, c512), loadSwapped(data + offset + 48, swap));
+    }
+    
+    __m128i x = _mm_xor_si128(foldBlock(x0, c128), x1);
+    x = _mm_xor_si128(foldBlock(x, c128), x2);
+    x = _mm_xor_si128(foldBlock(x, c128), x3);
+    
+    for (; offset + 16 <= len; offset += 16) {
+        x = _mm_xor_si128(foldBlock(x, c128), loadSwapped(data + offset, swap));
+    }
+    
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(remainder), _mm_shuffle_epi8(x, swap));
+    return offset;
+}
+
+#endif // CRC_HAVE_CLMUL
+
+} // namespace
+
+CRC::CRC(const CRCParameters& parameters)
+    : params(parameters), tables(16), fold512{0, 0}, fold128{0, 0}, use_clmul(false) {
+    
+    const int width = params.width;
+    if (width < 1 || width > 64) {
+        throw std::invalid_argument("CRC width must be between 1 and 64 bits");
+    }
+    
+    // Reflected CRCs run LSB-aligned with the reflected polynomial,
+    // the others MSB-aligned in a 64-bit register.
+    if (params.reflect_in) {
+        const uint64_t poly = reflect(params.polynomial, width);
+        for (int b = 0; b < 256; b++) {
+            uint64_t reg = b;
+            for (int i = 0; i < 8; i++) {
+                reg = (reg >> 1) ^ ((reg & 1) ? poly : 0);
+            }
+            tables[0][b] = reg;
+        }
+        for (int k = 1; k < 16; k++) {
+            for (int b = 0; b < 256; b++) {
+                uint64_t prev = tables[k - 1][b];
+                tables[k][b] = (prev >> 8) ^ tables[0][prev & 0xFF];
+            }
+        }
+    } else {
+        const uint64_t poly = (params.polynomial & widthMask(width)) << (64 - width);
+        for (int b = 0; b < 256; b++) {
+            uint64_t reg = static_cast<uint64_t>(b) << 56;
+            for (int i = 0; i < 8; i++) {
+                reg = (reg << 1) ^ ((reg >> 63) ? poly : 0);
+            }
+            tables[0][b] = reg;
+        }
+        for (int k = 1; k < 16; k++) {
+            for (int b = 0; b < 256; b++) {
+                uint64_t prev = tables[k - 1][b];
+                tables[k][b] = (prev << 8) ^ tables[0][prev >> 56];
+            }
+        }
+    }
+    
+#ifdef CRC_HAVE_CLMUL
+    const uint64_t poly_normal = params.polynomial & widthMask(width);
+    if (params.reflect_in && __builtin_cpu_supports("pclmul")) {
+        fold512[0] = reflect(gf2PowX(512 + 63, poly_normal, width), 64);
+        fold512[1] = reflect(gf2PowX(512 - 1, poly_normal, width), 64);
+        fold128[0] = reflect(gf2PowX(128 + 63, poly_normal, width), 64);
+        fold128[1] = reflect(gf2PowX(128 - 1, poly_normal, width), 64);
+        use_clmul = true;
+    } else if (!params.reflect_in && __builtin_cpu_supports("pclmul") &&
+               __builtin_cpu_supports("ssse3")) {
+        fold512[0] = gf2PowX(512, poly_normal, width);
+        fold512[1] = gf2PowX(512 + 64, poly_normal, width);
+        fold128[0] = gf2PowX(128, poly_normal, width);
+        fold128[1] = gf2PowX(128 + 64, poly_normal, width);
+        use_clmul = true;
+    }
+#endif
+}
+
+uint64_t CRC::updateTables(uint64_t reg, const uint8_t* data, size_t len) const {
+    const auto& t = tables;
+    size_t i = 0;
+    
+    if (params.reflect_in) {
+        for (; i + 16 <= len; i += 16) {
+            uint64_t a = reg ^ loadLE64(data + i);
+            uint64_t b = loadLE64(data + i + 8);
+            reg = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^
+                  t[13][(a >> 16) & 0xFF] ^ t[12][(a >> 24) & 0xFF] ^
+                  t[11][(a >> 32) & 0xFF] ^ t[10][(a >> 40) & 0xFF] ^
+                  t[9][(a >> 48) & 0xFF] ^ t[8][a >> 56] ^
+                  t[7][b & 0xFF] ^ t[6][(b >> 8) & 0xFF] ^
+                  t[5][(b >> 16) & 0xFF] ^ t[4][(b >> 24) & 0xFF] ^
+                  t[3][(b >> 32) & 0xFF] ^ t[2][(b >> 40) & 0xFF] ^
+                  t[1][(b >> 48) & 0xFF] ^ t[0][b >> 56];
+        }
+        for (; i + 8 <= len; i += 8) {
+            uint64_t a = reg ^ loadLE64(data + i);
+            reg = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^
+                  t[5][(a >> 16) & 0xFF] ^ t[4][(a >> 24) & 0xFF] ^
+                  t[3][(a >> 32) & 0xFF] ^ t[2][(a >> 40) & 0xFF] ^
+                  t[1][(a >> 48) & 0xFF] ^ t[0][a >> 56];
+        }
+        for (; i < len; i++) {
+            reg = t[0][(reg ^ data[i]) & 0xFF] ^ (reg >> 8);
+        }
+    } else {
+        for (; i + 16 <= len; i += 16) {
+            uint64_t a = reg ^ loadBE64(data + i);
+            uint64_t b = loadBE64(data + i + 8);
+            reg = t[15][a >> 56] ^ t[14][(a >> 48) & 0xFF] ^
+                  t[13][(a >> 40) & 0xFF] ^ t[12][(a >> 32) & 0xFF] ^
+                  t[11][(a >> 24) & 0xFF] ^ t[10][(a >> 16) & 0xFF] ^
+                  t[9][(a >> 8) & 0xFF] ^ t[8][a & 0xFF] ^
+                  t[7][b >> 56] ^ t[6][(b >> 48) & 0xFF] ^
+                  t[5][(b >> 40) & 0xFF] ^ t[4][(b >> 32) & 0xFF] ^
+                  t[3][(b >> 24) & 0xFF] ^ t[2][(b >> 16) & 0xFF] ^
+                  t[1][(b >> 8) & 0xFF] ^ t[0][b & 0xFF];
+        }
+        for (; i + 8 <= len; i += 8) {
+            uint64_t a = reg ^ loadBE64(data + i);
+            reg = t[7][a >> 56] ^ t[6][(a >> 48) & 0xFF] ^
+                  t[5][(a >> 40) & 0xFF] ^ t[4][(a >> 32) & 0xFF] ^
+                  t[3][(a >> 24) & 0xFF] ^ t[2][(a >> 16) & 0xFF] ^
+                  t[1][(a >> 8) & 0xFF] ^ t[0][a & 0xFF];
+        }
+        for (; i < len; i++) {
+            reg = t[0][(reg >> 56) ^ data[i]] ^ (reg << 8);
+        }
+    }
+    return reg;
+}
+
+uint64_t CRC::updateFolded(uint64_t reg, const uint8_t* data, size_t len) const {
+#ifdef CRC_HAVE_CLMUL
+    // Folding keeps the message congruent modulo P, so the 16-byte
+    // remainder run through the tables from a zero register gives the
+    // same CRC as the bytes it replaced.
+    uint8_t remainder[16];
+    size_t consumed = params.reflect_in
+        ? foldReflected(reg, data, len, fold512, fold128, remainder)
+        : foldNormal(reg, data, len, fold512, fold128, remainder);
+    reg = updateTables(0, remainder, sizeof(remainder));
+    return updateTables(reg, data + consumed, len - consumed);
+#else
+    return updateTables(reg, data, len);
+#endif
+}
+
+uint64_t CRC::begin() const {
+    const uint64_t init = params.init & widthMask(params.width);
+    return params.reflect_in ? reflect(init, params.width) : init << (64 - params.width);
+}
+
+uint64_t CRC::update(uint64_t reg, const uint8_t* data, size_t len) const {
+    if (use_clmul && len >= 128) {
+        return updateFolded(reg, data, len);
+    }
+    return updateTables(reg, data, len);
+}
+
+uint64_t CRC::finish(uint64_t reg) const {
+    const int width = params.width;
+    uint64_t value = params.reflect_in ? reflect(reg, width) : reg >> (64 - width);
+    if (params.reflect_out) {
+        value = reflect(value, width);
+    }
+    return (value ^ params.xor_out) & widthMask(width);
+}
+
+uint64_t CRC::compute(const uint8_t* data, size_t len) const {
+    return finish(update(begin(), data, len));
+}
+
+bool CRC::selfTest() const {
+    static const uint8_t CHECK_INPUT[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    return compute(CHECK_INPUT, sizeof(CHECK_INPUT)) == (params.check & widthMask(params.width));
+}
+
+uint64_t CRC::combine(uint64_t crc_a, uint64_t crc_b, uint64_t len_b) const {
+    const int width = params.width;
+    const uint64_t mask = widthMask(width);
+    const uint64_t poly = params.polynomial & mask;
+    
+    // Undo xor_out and output reflection to get plain register values
+    auto toRegister = [&](uint64_t value) {
+        value = (value ^ params.xor_out) & mask;
+        return params.reflect_out ? reflect(value, width) : value;
+    };
+    
+    // Running B from A's register instead of init differs by the
+    // difference of the two registers carried through len_b bytes.
+    uint64_t shift = gf2PowX(8 * len_b, poly, width);
+    uint64_t carried = gf2MulMod(toRegister(crc_a) ^ (params.init & mask), shift, poly, width);
+    uint64_t value = toRegister(crc_b) ^ carried;
+    
+    if (params.reflect_out) {
+        value = reflect(value, width);
+    }
+    return (value ^ params.xor_out) & mask;
+}
+
+uint64_t CRC::computeParallel(const uint8_t* data, size_t len, unsigned threads) const {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunks = std::min<size_t>(threads, std::max<size_t>(1, len / MIN_PARALLEL_CHUNK));
+    if (chunks <= 1) {
+        return compute(data, len);
+    }
+    
+    const size_t chunk_size = (len + chunks - 1) / chunks;
+    std::vector<uint64_t> results(chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    
+    auto worker = [&](size_t index) {
+        size_t begin = index * chunk_size;
+        size_t end = std::min(len, begin + chunk_size);
+        results[index] = compute(data + begin, end - begin);
+    };
+    size_t spawned = 1;
+    try {
+        for (; spawned < chunks; spawned++) {
+            workers.emplace_back(worker, spawned);
+        }
+    } catch (const std::system_error&) {
+        // Out of threads: compute the remaining chunks here
+    }
+    for (size_t i = spawned; i < chunks; i++) {
+        worker(i);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    
+    uint64_t result = results[0];
+    for (size_t i = 1; i < chunks; i++) {
+        size_t begin = i * chunk_size;
+        size_t end = std::min(len, begin + chunk_size);
+        result = combine(result, results[i], end - begin);
+    }
+    return result;
+}
+
+uint64_t crcFile(const CRC& crc, const std::string& path, unsigned threads) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(error));
+    }
+    
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return crc.compute(nullptr, 0);
+    }
+    
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path + ": " + std::strerror(error));
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    
+    uint64_t result = crc.computeParallel(static_cast<const uint8_t*>(mapping), size, threads);
+    ::munmap(mapping, size);
+    return result;
+}
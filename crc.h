@@ -0,0 +1,166 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <vector>
+#include <array>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct CRCParameters
+ * @brief CRC definition in the Rocksoft/Williams model
+ * 
+ * The polynomial uses the same convention as LFSR feedback masks: bit i
+ * is the x^i coefficient, with the leading x^width term implied.
+ */
+struct CRCParameters {
+    const char* name;      // Catalog name, e.g. "CRC-32"
+    uint8_t width;         // Register width in bits (1-64)
+    uint64_t polynomial;   // Generator polynomial without the x^width term
+    uint64_t init;         // Initial register value
+    bool reflect_in;       // Process input bytes LSB first
+    bool reflect_out;      // Reflect the register before xor_out
+    uint64_t xor_out;      // Value XORed into the final register
+    uint64_t check;        // CRC of the ASCII string "123456789"
+};
+
+// Common CRC definitions
+extern const CRCParameters CRC8_SMBUS;
+extern const CRCParameters CRC16_ARC;
+extern const CRCParameters CRC16_CCITT_FALSE;
+extern const CRCParameters CRC32_ISO_HDLC;
+extern const CRCParameters CRC32_ISCSI;
+extern const CRCParameters CRC32_BZIP2;
+extern const CRCParameters CRC64_XZ;
+extern const CRCParameters CRC64_ECMA_182;
+
+/**
+ * @class CRC
+ * @brief Table-driven CRC engine for arbitrary width and polynomial
+ * 
+ * Slicing-by-16 tables are generated at construction and consume 16
+ * input bytes per step. When the CPU supports PCLMULQDQ, buffers of 128
+ * bytes or more are first folded over 64-byte blocks; the folded
+ * remainder is finished with the tables, so no Barrett constants are
+ * needed and any width up to 64 bits qualifies.
+ */
+class CRC {
+private:
+    CRCParameters params;
+    
+    // tables[k][b]: register contribution of byte b followed by k zero bytes
+    std::vector<std::array<uint64_t, 256>> tables;
+    
+    // Folding constants for fold distances of 512 and 128 bits, for the
+    // low and high qword of a block (see crc.cpp)
+    uint64_t fold512[2];
+    uint64_t fold128[2];
+    bool use_clmul;        // Carry-less multiply folding is available
+    
+    /**
+     * @brief Run the register over data with the tables
+     * @param reg Register in processing form
+     * @return Updated register
+     */
+    uint64_t updateTables(uint64_t reg, const uint8_t* data, size_t len) const;
+    
+    /**
+     * @brief Run the register over data with carry-less folding
+     * @param reg Register in processing form
+     * @return Updated register
+     */
+    uint64_t updateFolded(uint64_t reg, const uint8_t* data, size_t len) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param parameters CRC definition
+     * @throw std::invalid_argument if width is not in range [1, 64]
+     */
+    explicit CRC(const CRCParameters& parameters);
+    
+    /**
+     * @brief Compute the CRC of a buffer
+     * @param data Input bytes
+     * @param len Number of bytes
+     * @return Final CRC value
+     */
+    uint64_t compute(const uint8_t* data, size_t len) const;
+    
+    /**
+     * @brief Get the register value before any data
+     * @return Register in processing form
+     */
+    uint64_t begin() const;
+    
+    /**
+     * @brief Feed more data into a running register
+     * @param reg Register from begin() or a previous update()
+     * @param data Input bytes
+     * @param len Number of bytes
+     * @return Updated register
+     */
+    uint64_t update(uint64_t reg, const uint8_t* data, size_t len) const;
+    
+    /**
+     * @brief Turn a running register into the CRC value
+     * @param reg Register after the last update()
+     * @return Final CRC value
+     */
+    uint64_t finish(uint64_t reg) const;
+    
+    /**
+     * @brief Combine the CRCs of two adjacent blocks
+     * @param crc_a CRC of the first block
+     * @param crc_b CRC of the second block
+     * @param len_b Length of the second block in bytes
+     * @return CRC of the first block followed by the second
+     * 
+     * Shifts crc_a across len_b bytes by multiplying with x^(8*len_b)
+     * mod P(x), the same exponentiation that drives LFSR::jump().
+     */
+    uint64_t combine(uint64_t crc_a, uint64_t crc_b, uint64_t len_b) const;
+    
+    /**
+     * @brief Compute the CRC of a buffer on several threads
+     * @param data Input bytes
+     * @param len Number of bytes
+     * @param threads Worker count (0 means one per hardware thread)
+     * @return Final CRC value, identical to compute()
+     */
+    uint64_t computeParallel(const uint8_t* data, size_t len, unsigned threads = 0) const;
+    
+    /**
+     * @brief Check the engine against the catalog check value
+     * @return true if the CRC of "123456789" matches
+     */
+    bool selfTest() const;
+    
+    /**
+     * @brief Get CRC definition
+     * @return Parameters this engine was built for
+     */
+    const CRCParameters& getParameters() const { return params; }
+    
+    /**
+     * @brief Check whether carry-less multiply folding is used
+     * @return true if the PCLMULQDQ path is active
+     */
+    bool usesCarrylessMultiply() const { return use_clmul; }
+};
+
+/**
+ * @brief Compute the CRC of a file in parallel chunks
+ * @param crc CRC engine
+ * @param path File to checksum
+ * @param threads Worker count (0 means one per hardware thread)
+ * @return Final CRC value of the whole file
+ * @throw std::runtime_error if the file cannot be opened or mapped
+ * 
+ * The file is memory-mapped; each thread checksums one contiguous chunk
+ * and the chunk CRCs are joined with CRC::combine().
+ */
+uint64_t crcFile(const CRC& crc, const std::string& path, unsigned threads = 0);
+
+#endif // CRC_H
@@ -0,0 +1,44 @@
+#include "cyclic_code.h"
+#include "gf2poly.h"
+#include <stdexcept>
+
+namespace {
+
+CRCParameters dividerParameters(int n, int k, uint64_t generator) {
+    int degree = n - k;
+    if (k < 1 || degree < 1 || degree > 64) {
+        throw std::invalid_argument("Cyclic code needs 1 <= n-k <= 64 and k >= 1");
+    }
+    uint64_t mask = degree >= 64 ? ~0ULL : (1ULL << degree) - 1;
+    if ((generator & 1) == 0 || (generator & ~mask) != 0) {
+        throw std::invalid_argument("Generator must have a constant term and degree n-k");
+    }
+    // g(x) generates a cyclic code of length n only if it divides x^n - 1
+    if (gf2PowX(static_cast<uint64_t>(n), generator, degree) != 1) {
+        throw std::invalid_argument("Generator polynomial does not divide x^n - 1");
+    }
+    return {"cyclic code divider", static_cast<uint8_t>(degree), generator, 0, false, false, 0, 0};
+}
+
+} // namespace
+
+CyclicCode::CyclicCode(int n, int k, uint64_t generator)
+    : length(n), dimension(k), message_bytes((k + 7) / 8),
+      divider(dividerParameters(n, k, generator)) {
+}
+
+uint64_t CyclicCode::parity(const uint8_t* message) const {
+    // Leading zero padding has no effect on the remainder
+    return divider.compute(message, message_bytes);
+}
+
+void CyclicCode::encodeBatch(const uint8_t* messages, size_t count, uint64_t* parities) const {
+    for (size_t i = 0; i < count; i++) {
+        parities[i] = divider.compute(messages + i * message_bytes, message_bytes);
+    }
+}
+
+uint64_t CyclicCode::syndrome(const uint8_t* message, uint64_t received_parity) const {
+    // r(x) = m(x) * x^(n-k) + p(x), and p(x) is already reduced
+    return parity(message) ^ received_parity;
+}
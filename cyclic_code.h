@@ -0,0 +1,87 @@
+#ifndef CYCLIC_CODE_H
+#define CYCLIC_CODE_H
+
+#include "crc.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class CyclicCode
+ * @brief Systematic encoder and syndrome calculator for binary cyclic codes
+ * 
+ * A systematic (n, k) cyclic code appends the remainder of m(x) * x^(n-k)
+ * divided by the generator g(x), which is what an LFSR divider computes.
+ * The division runs on the CRC engine (width n-k, zero init, no
+ * reflection), so it is table-driven and uses carry-less folding for long
+ * messages. Covers BCH, Hamming, Golay and other codes with n-k <= 64.
+ * 
+ * Messages are k bits packed MSB first (highest-degree coefficient first)
+ * into ceil(k/8) bytes, right-aligned: unused leading bits must be zero.
+ */
+class CyclicCode {
+private:
+    int length;              // Codeword length n
+    int dimension;           // Message length k
+    size_t message_bytes;    // Bytes per packed message
+    CRC divider;             // Remainder modulo g(x)
+
+public:
+    /**
+     * @brief Constructor
+     * @param n Codeword length in bits
+     * @param k Message length in bits
+     * @param generator Terms of g(x) below x^(n-k), bit i for x^i
+     * @throw std::invalid_argument if n-k is not in [1, 64], g(x) has no
+     *        constant term, or g(x) does not divide x^n - 1
+     */
+    CyclicCode(int n, int k, uint64_t generator);
+    
+    /**
+     * @brief Compute the parity bits of a message
+     * @param message Packed message
+     * @return Parity p(x) = m(x) * x^(n-k) mod g(x), x^i in bit i
+     */
+    uint64_t parity(const uint8_t* message) const;
+    
+    /**
+     * @brief Encode consecutive messages
+     * @param messages count packed messages, back to back
+     * @param count Number of messages
+     * @param parities Output parity for each message
+     */
+    void encodeBatch(const uint8_t* messages, size_t count, uint64_t* parities) const;
+    
+    /**
+     * @brief Compute the syndrome of a received codeword
+     * @param message Received message part, packed
+     * @param received_parity Received parity bits
+     * @return r(x) mod g(x); zero for a valid codeword
+     */
+    uint64_t syndrome(const uint8_t* message, uint64_t received_parity) const;
+    
+    /**
+     * @brief Get codeword length
+     * @return n
+     */
+    int getLength() const { return length; }
+    
+    /**
+     * @brief Get message length
+     * @return k
+     */
+    int getDimension() const { return dimension; }
+    
+    /**
+     * @brief Get number of parity bits
+     * @return n - k
+     */
+    int getRedundancy() const { return length - dimension; }
+    
+    /**
+     * @brief Get packed message size
+     * @return ceil(k / 8)
+     */
+    size_t getMessageBytes() const { return message_bytes; }
+};
+
+#endif // CYCLIC_CODE_H
@@ -0,0 +1,222 @@
+#include "despreader.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DESPREADER_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Codes despread together; their accumulators stay in registers
+constexpr size_t GROUP_CODES = 4;
+
+// 64 chips starting at an arbitrary chip position
+inline uint64_t readChips(const uint64_t* code, size_t words, size_t position) {
+    const size_t word = position / 64;
+    const unsigned bit = position % 64;
+    uint64_t chips = code[word] >> bit;
+    if (bit != 0 && word + 1 < words) {
+        chips |= code[word + 1] << (64 - bit);
+    }
+    return chips;
+}
+
+template <typename Sample, typename Sum>
+void despreadScalar(const Sample* samples, size_t symbols, size_t spreading_factor,
+                    const uint64_t* const* codes, size_t code_count, size_t words, Sum* out) {
+    for (size_t c = 0; c < code_count; c++) {
+        for (size_t s = 0; s < symbols; s++) {
+            const size_t base = s * spreading_factor;
+            Sum sum = 0;
+            for (size_t k = 0; k < spreading_factor; k += 64) {
+                const uint64_t chips = readChips(codes[c], words, base + k);
+                const size_t count = std::min<size_t>(64, spreading_factor - k);
+                for (size_t j = 0; j < count; j++) {
+                    const Sum x = samples[base + k + j];
+                    sum += ((chips >> j) & 1) ? -x : x;
+                }
+            }
+            out[c * symbols + s] = sum;
+        }
+    }
+}
+
+#ifdef DESPREADER_HAVE_AVX2
+
+__attribute__((target("avx2")))
+inline float horizontalSum(__m256 v) {
+    __m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+    return _mm_cvtss_f32(x);
+}
+
+__attribute__((target("avx2")))
+inline int32_t horizontalSum(__m256i v) {
+    __m128i x = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0x4E));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0xB1));
+    return _mm_cvtsi128_si32(x);
+}
+
+// Lane i shifts chip i of a byte up to the float sign bit
+template <size_t CODES>
+__attribute__((target("avx2")))
+void despreadFloatAVX2(const float* samples, size_t symbols, size_t spreading_factor,
+                       const uint64_t* const* codes, size_t words, float* out, size_t stride) {
+    const __m256i shifts = _mm256_setr_epi32(31, 30, 29, 28, 27, 26, 25, 24);
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+
+    for (size_t s = 0; s < symbols; s++) {
+        const size_t base = s * spreading_factor;
+        __m256 acc[CODES];
+        float tail[CODES];
+        for (size_t c = 0; c < CODES; c++) {
+            acc[c] = _mm256_setzero_ps();
+            tail[c] = 0.0f;
+        }
+
+        for (size_t k = 0; k < spreading_factor; k += 64) {
+            uint64_t chips[CODES];
+            for (size_t c = 0; c < CODES; c++) {
+                chips[c] = readChips(codes[c], words, base + k);
+            }
+            const size_t count = std::min<size_t>(64, spreading_factor - k);
+            const float* x = samples + base + k;
+            size_t j = 0;
+            for (; j + 8 <= count; j += 8) {
+                const __m256 v = _mm256_loadu_ps(x + j);
+                for (size_t c = 0; c < CODES; c++) {
+                    __m256i mask = _mm256_set1_epi32(static_cast<int>(chips[c] >> j));
+                    mask = _mm256_and_si256(_mm256_sllv_epi32(mask, shifts), sign);
+                    acc[c] = _mm256_add_ps(acc[c], _mm256_xor_ps(v, _mm256_castsi256_ps(mask)));
+                }
+            }
+            for (; j < count; j++) {
+                for (size_t c = 0; c < CODES; c++) {
+                    tail[c] += ((chips[c] >> j) & 1) ? -x[j] : x[j];
+                }
+            }
+        }
+
+        for (size_t c = 0; c < CODES; c++) {
+            out[c * stride + s] = horizontalSum(acc[c]) + tail[c];
+        }
+    }
+}
+
+// Chips become +-1 half-words; VPMADDWD multiplies and widens to 32 bits
+template <size_t CODES>
+__attribute__((target("avx2")))
+void despreadInt16AVX2(const int16_t* samples, size_t symbols, size_t spreading_factor,
+                       const uint64_t* const* codes, size_t words, int32_t* out, size_t stride) {
+    const __m256i lane_bits = _mm256_setr_epi16(
+        0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+        0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, static_cast<int16_t>(0x8000));
+    const __m256i one = _mm256_set1_epi16(1);
+
+    for (size_t s = 0; s < symbols; s++) {
+        const size_t base = s * spreading_factor;
+        __m256i acc[CODES];
+        int32_t tail[CODES];
+        for (size_t c = 0; c < CODES; c++) {
+            acc[c] = _mm256_setzero_si256();
+            tail[c] = 0;
+        }
+
+        for (size_t k = 0; k < spreading_factor; k += 64) {
+            uint64_t chips[CODES];
+            for (size_t c = 0; c < CODES; c++) {
+                chips[c] = readChips(codes[c], words, base + k);
+            }
+            const size_t count = std::min<size_t>(64, spreading_factor - k);
+            const int16_t* x = samples + base + k;
+            size_t j = 0;
+            for (; j + 16 <= count; j += 16) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j));
+                for (size_t c = 0; c < CODES; c++) {
+                    __m256i bits = _mm256_set1_epi16(static_cast<int16_t>(chips[c] >> j));
+                    __m256i negative = _mm256_cmpeq_epi16(_mm256_and_si256(bits, lane_bits), lane_bits);
+                    acc[c] = _mm256_add_epi32(acc[c], _mm256_madd_epi16(v, _mm256_or_si256(negative, one)));
+                }
+            }
+            for (; j < count; j++) {
+                for (size_t c = 0; c < CODES; c++) {
+                    int32_t bit = (chips[c] >> j) & 1;
+                    tail[c] += (x[j] ^ -bit) + bit;
+                }
+            }
+        }
+
+        for (size_t c = 0; c < CODES; c++) {
+            out[c * stride + s] = horizontalSum(acc[c]) + tail[c];
+        }
+    }
+}
+
+// Run a kernel over the codes in groups of up to GROUP_CODES
+template <typename Sample, typename Sum, template <size_t> class Kernel>
+void despreadGroups(const Sample* samples, size_t symbols, size_t spreading_factor,
+                    const uint64_t* const* codes, size_t code_count, size_t words, Sum* out) {
+    for (size_t first = 0; first < code_count; first += GROUP_CODES) {
+        const uint64_t* const* group = codes + first;
+        Sum* group_out = out + first * symbols;
+        switch (std::min(GROUP_CODES, code_count - first)) {
+        case 1: Kernel<1>::run(samples, symbols, spreading_factor, group, words, group_out, symbols); break;
+        case 2: Kernel<2>::run(samples, symbols, spreading_factor, group, words, group_out, symbols); break;
+        case 3: Kernel<3>::run(samples, symbols, spreading_factor, group, words, group_out, symbols); break;
+        default: Kernel<4>::run(samples, symbols, spreading_factor, group, words, group_out, symbols); break;
+        }
+    }
+}
+
+template <size_t CODES>
+struct FloatKernel {
+    static void run(const float* samples, size_t symbols, size_t spreading_factor,
+                    const uint64_t* const* codes, size_t words, float* out, size_t stride) {
+        despreadFloatAVX2<CODES>(samples, symbols, spreading_factor, codes, words, out, stride);
+    }
+};
+
+template <size_t CODES>
+struct Int16Kernel {
+    static void run(const int16_t* samples, size_t symbols, size_t spreading_factor,
+                    const uint64_t* const* codes, size_t words, int32_t* out, size_t stride) {
+        despreadInt16AVX2<CODES>(samples, symbols, spreading_factor, codes, words, out, stride);
+    }
+};
+
+#endif // DESPREADER_HAVE_AVX2
+
+} // namespace
+
+void despread(const float* samples, size_t symbols, size_t spreading_factor,
+              const uint64_t* const* codes, size_t code_count, float* out) {
+    const size_t words = (symbols * spreading_factor + 63) / 64;
+#ifdef DESPREADER_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        despreadGroups<float, float, FloatKernel>(samples, symbols, spreading_factor,
+                                                  codes, code_count, words, out);
+        return;
+    }
+#endif
+    despreadScalar(samples, symbols, spreading_factor, codes, code_count, words, out);
+}
+
+void despread(const int16_t* samples, size_t symbols, size_t spreading_factor,
+              const uint64_t* const* codes, size_t code_count, int32_t* out) {
+    if (spreading_factor >= 65536) {
+        throw std::invalid_argument("Spreading factor of 16-bit samples must be below 65536");
+    }
+    const size_t words = (symbols * spreading_factor + 63) / 64;
+#ifdef DESPREADER_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        despreadGroups<int16_t, int32_t, Int16Kernel>(samples, symbols, spreading_factor,
+                                                      codes, code_count, words, out);
+        return;
+    }
+#endif
+    despreadScalar(samples, symbols, spreading_factor, codes, code_count, words, out);
+}
@@ -0,0 +1,47 @@
+#ifndef DESPREADER_H
+#define DESPREADER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file despreader.h
+ * @brief Direct-sequence despreading against packed chip sequences
+ *
+ * Each symbol spans spreading_factor consecutive samples; its output is
+ * the sum of those samples with the sign given by the matching chip (0 as
+ * +1, 1 as -1). Chip streams use the packing of LFSR::fillBlocks() and
+ * SpreadingCodeFamily::fill(): chip i in bit i % 64 of word i / 64, and
+ * each stream covers symbols * spreading_factor chips.
+ *
+ * All codes are despread in the same pass over the samples. With AVX2
+ * each chip byte (float) or chip half-word (int16) becomes a vector
+ * sign mask, applied with XOR or a multiply-add by +-1, so no chip is
+ * tested with a branch.
+ */
+
+/**
+ * @brief Despread float samples against several codes
+ * @param samples symbols * spreading_factor samples
+ * @param symbols Number of symbols
+ * @param spreading_factor Chips per symbol
+ * @param codes code_count packed chip streams
+ * @param code_count Number of codes
+ * @param out code_count * symbols correlations, out[c * symbols + s]
+ *        for code c and symbol s
+ */
+void despread(const float* samples, size_t symbols, size_t spreading_factor,
+              const uint64_t* const* codes, size_t code_count, float* out);
+
+/**
+ * @brief Despread 16-bit samples against several codes
+ * @param out code_count * symbols correlations, same layout
+ * @throw std::invalid_argument if spreading_factor is 65536 or more
+ *
+ * Sums are exact in 32 bits for spreading factors below 65536; at 65536
+ * a symbol of -32768 samples would reach 2^31.
+ */
+void despread(const int16_t* samples, size_t symbols, size_t spreading_factor,
+              const uint64_t* const* codes, size_t code_count, int32_t* out);
+
+#endif // DESPREADER_H
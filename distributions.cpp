@@ -0,0 +1,347 @@
+#include "distributions.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DISTRIBUTIONS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Blocks generated per conversion pass
+constexpr size_t CHUNK_BLOCKS = 256;
+
+inline uint32_t word32(const uint64_t* blocks, size_t i) {
+    return static_cast<uint32_t>(blocks[i / 2] >> (32 * (i % 2)));
+}
+
+inline float uniformFloat(uint32_t word) {
+    uint32_t bits = (word >> 9) | 0x3F800000u;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value - 1.0f;
+}
+
+inline double uniformDouble(uint64_t block) {
+    uint64_t bits = (block >> 12) | 0x3FF0000000000000ULL;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value - 1.0;
+}
+
+// Inverse Gaussian tail function Q^-1 sampled at p = 2^e * (1 + m/64)
+// for e = -33..-2 and m = 0..63, indexed (e + 33) * 64 + m: the float
+// exponent and top six mantissa bits of p. Node 2048 is p = 1/2; the
+// extra node covers p rounding up to 1/2.
+constexpr int GAUSSIAN_NODES = 32 * 64;
+constexpr uint32_t GAUSSIAN_INDEX_BASE = (127 - 33) << 6;
+
+struct GaussianTable {
+    float x[GAUSSIAN_NODES + 2];       // Q^-1 at each node
+    float delta[GAUSSIAN_NODES + 2];   // Difference to the next node
+};
+
+double inverseTail(double p) {
+    // Newton's method from x = 0 rises monotonically to the root, since
+    // Q(x) is convex for x >= 0
+    const double inv_sqrt_2pi = 0.3989422804014327;
+    double x = 0.0;
+    for (int i = 0; i < 100; i++) {
+        double step = (0.5 * std::erfc(x / std::sqrt(2.0)) - p) / (inv_sqrt_2pi * std::exp(-0.5 * x * x));
+        x += step;
+        if (step < 1e-13) break;
+    }
+    return x;
+}
+
+const GaussianTable& gaussianTable() {
+    static const GaussianTable table = [] {
+        GaussianTable t;
+        for (int i = 0; i < GAUSSIAN_NODES; i++) {
+            double p = std::ldexp(1.0 + (i % 64) / 64.0, i / 64 - 33);
+            t.x[i] = static_cast<float>(inverseTail(p));
+        }
+        t.x[GAUSSIAN_NODES] = t.x[GAUSSIAN_NODES + 1] = 0.0f;
+        for (int i = 0; i <= GAUSSIAN_NODES; i++) {
+            t.delta[i] = t.x[i + 1] - t.x[i];
+        }
+        t.delta[GAUSSIAN_NODES + 1] = 0.0f;
+        return t;
+    }();
+    return table;
+}
+
+inline float gaussianSample(uint32_t word, const GaussianTable& t, float sigma) {
+    float p = static_cast<float>(static_cast<int32_t>(word & 0x7FFFFFFFu)) * 0x1p-32f + 0x1p-33f;
+    uint32_t bits;
+    std::memcpy(&bits, &p, sizeof(bits));
+    const uint32_t index = (bits >> 17) - GAUSSIAN_INDEX_BASE;
+    const float fraction = static_cast<float>(static_cast<int32_t>(bits & 0x1FFFFu)) * 0x1p-17f;
+    float value = (t.x[index] + t.delta[index] * fraction) * sigma;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits ^= word & 0x80000000u;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Bit k of mask to byte k, as 0 or 1
+inline uint64_t spreadMask(uint64_t mask) {
+    uint64_t bytes = (mask * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+    return ((bytes + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+}
+
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+
+__attribute__((target("avx2")))
+void uniformFloatAVX2(const uint64_t* blocks, float* out, size_t count) {
+    const __m256i exponent = _mm256_set1_epi32(0x3F800000);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i / 2));
+        __m256i bits = _mm256_or_si256(_mm256_srli_epi32(words, 9), exponent);
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_castsi256_ps(bits), one));
+    }
+    for (; i < count; i++) {
+        out[i] = uniformFloat(word32(blocks, i));
+    }
+}
+
+__attribute__((target("avx2")))
+void uniformDoubleAVX2(const uint64_t* blocks, double* out, size_t count) {
+    const __m256i exponent = _mm256_set1_epi64x(0x3FF0000000000000LL);
+    const __m256d one = _mm256_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i));
+        __m256i bits = _mm256_or_si256(_mm256_srli_epi64(words, 12), exponent);
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_castsi256_pd(bits), one));
+    }
+    for (; i < count; i++) {
+        out[i] = uniformDouble(blocks[i]);
+    }
+}
+
+// Lemire's method eight words at a time, up to the first group with a
+// rejected word; returns the number of words consumed (all accepted)
+__attribute__((target("avx2")))
+size_t boundedAVX2(const uint64_t* blocks, size_t words, uint32_t range, uint32_t threshold,
+                   uint32_t* out, size_t count) {
+    const __m256i r = _mm256_set1_epi64x(range);
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN);
+    const __m256i limit = _mm256_set1_epi32(static_cast<int>(threshold ^ 0x80000000u));
+    size_t i = 0;
+    for (; i + 8 <= words && i + 8 <= count; i += 8) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i / 2));
+        const __m256i even = _mm256_mul_epu32(x, r);
+        const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), r);
+        const __m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        const __m256i rejected = _mm256_cmpgt_epi32(limit, _mm256_xor_si256(low, flip));
+        if (!_mm256_testz_si256(rejected, rejected)) {
+            break;
+        }
+        const __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), high);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+void bernoulliAVX2(const uint64_t* blocks, uint8_t* out, size_t count, uint32_t threshold) {
+    const __m256i limit = _mm256_set1_epi32(static_cast<int>(threshold ^ 0x80000000u));
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i / 2));
+        __m256i below = _mm256_cmpgt_epi32(limit, _mm256_xor_si256(words, flip));
+        uint64_t bytes = spreadMask(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(below))));
+        std::memcpy(out + i, &bytes, sizeof(bytes));
+    }
+    for (; i < count; i++) {
+        out[i] = word32(blocks, i) < threshold;
+    }
+}
+
+// Same arithmetic as gaussianSample(), eight words at a time
+__attribute__((target("avx2")))
+void gaussianAVX2(const uint8_t* words, float* out, size_t count, const GaussianTable& t, float sigma) {
+    const __m256i magnitude = _mm256_set1_epi32(0x7FFFFFFF);
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i fraction_bits = _mm256_set1_epi32(0x1FFFF);
+    const __m256i base = _mm256_set1_epi32(static_cast<int>(GAUSSIAN_INDEX_BASE));
+    const __m256 scale = _mm256_set1_ps(0x1p-32f);
+    const __m256 half_step = _mm256_set1_ps(0x1p-33f);
+    const __m256 fraction_scale = _mm256_set1_ps(0x1p-17f);
+    const __m256 s = _mm256_set1_ps(sigma);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + 4 * i));
+        const __m256 p = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(w, magnitude)), scale),
+                                       half_step);
+        const __m256i bits = _mm256_castps_si256(p);
+        const __m256i index = _mm256_sub_epi32(_mm256_srli_epi32(bits, 17), base);
+        const __m256 fraction = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(bits, fraction_bits)),
+                                              fraction_scale);
+        const __m256 x = _mm256_i32gather_ps(t.x, index, 4);
+        const __m256 delta = _mm256_i32gather_ps(t.delta, index, 4);
+        __m256 value = _mm256_mul_ps(_mm256_add_ps(x, _mm256_mul_ps(delta, fraction)), s);
+        value = _mm256_xor_ps(value, _mm256_castsi256_ps(_mm256_and_si256(w, sign)));
+        _mm256_storeu_ps(out + i, value);
+    }
+    for (; i < count; i++) {
+        uint32_t word;
+        std::memcpy(&word, words + 4 * i, sizeof(word));
+        out[i] = gaussianSample(word, t, sigma);
+    }
+}
+
+#endif // DISTRIBUTIONS_HAVE_AVX2
+
+// Gaussian samples from consecutive words, the first being word
+// first_word (0 or 1) of the register's next block
+void gaussianRun(LFSR& source, bool use_avx2, size_t first_word,
+                 float* out, size_t count, float sigma) {
+    const GaussianTable& table = gaussianTable();
+    uint64_t blocks[CHUNK_BLOCKS];
+    while (count > 0) {
+        const size_t n = std::min(count, 2 * CHUNK_BLOCKS - first_word);
+        source.fillBlocks(blocks, (first_word + n + 1) / 2);
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+        if (use_avx2) {
+            gaussianAVX2(reinterpret_cast<const uint8_t*>(blocks) + 4 * first_word, out, n, table, sigma);
+        } else
+#endif
+        {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = gaussianSample(word32(blocks, first_word + i), table, sigma);
+            }
+        }
+        first_word = 0;
+        out += n;
+        count -= n;
+    }
+}
+
+} // namespace
+
+VariateGenerator::VariateGenerator(uint64_t seed)
+    : VariateGenerator(LFSR::makeDefaultSource(seed)) {
+}
+
+VariateGenerator::VariateGenerator(const LFSR& generator)
+    : source(generator), use_avx2(false) {
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+    use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+void VariateGenerator::fillUniform(float* out, size_t count) {
+    uint64_t blocks[CHUNK_BLOCKS];
+    while (count > 0) {
+        const size_t n = std::min(count, 2 * CHUNK_BLOCKS);
+        source.fillBlocks(blocks, (n + 1) / 2);
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+        if (use_avx2) {
+            uniformFloatAVX2(blocks, out, n);
+        } else
+#endif
+        {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = uniformFloat(word32(blocks, i));
+            }
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+void VariateGenerator::fillUniform(double* out, size_t count) {
+    uint64_t blocks[CHUNK_BLOCKS];
+    while (count > 0) {
+        const size_t n = std::min(count, CHUNK_BLOCKS);
+        source.fillBlocks(blocks, n);
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+        if (use_avx2) {
+            uniformDoubleAVX2(blocks, out, n);
+        } else
+#endif
+        {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = uniformDouble(blocks[i]);
+            }
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+void VariateGenerator::fillBounded(uint32_t* out, size_t count, uint32_t range) {
+    if (range == 0) {
+        throw std::invalid_argument("Bounded range must be non-zero");
+    }
+    // Words whose low product half falls below 2^32 mod range are
+    // rejected so that every result is equally likely
+    const uint32_t threshold = (0u - range) % range;
+    uint64_t blocks[CHUNK_BLOCKS];
+    size_t produced = 0;
+
+    while (produced < count) {
+        const size_t words = std::min(2 * (count - produced), 2 * CHUNK_BLOCKS);
+        source.fillBlocks(blocks, (words + 1) / 2);
+        size_t i = 0;
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+        if (use_avx2) {
+            i = boundedAVX2(blocks, words, range, threshold, out + produced, count - produced);
+            produced += i;
+        }
+#endif
+        // Scalar from the first group with a rejection; the vector path
+        // resumes on the next chunk
+        for (; i < words && produced < count; i++) {
+            uint64_t product = uint64_t(word32(blocks, i)) * range;
+            if (static_cast<uint32_t>(product) >= threshold) {
+                out[produced++] = static_cast<uint32_t>(product >> 32);
+            }
+        }
+    }
+}
+
+void VariateGenerator::fillBernoulli(uint8_t* out, size_t count, double p) {
+    if (!(p >= 0.0 && p <= 1.0)) {
+        throw std::invalid_argument("Probability must be between 0 and 1");
+    }
+    const uint64_t threshold = static_cast<uint64_t>(p * 4294967296.0);
+    uint64_t blocks[CHUNK_BLOCKS];
+    while (count > 0) {
+        const size_t n = std::min(count, 2 * CHUNK_BLOCKS);
+        source.fillBlocks(blocks, (n + 1) / 2);
+        if (threshold > UINT32_MAX) {
+            std::fill(out, out + n, 1);
+        }
+#ifdef DISTRIBUTIONS_HAVE_AVX2
+        else if (use_avx2) {
+            bernoulliAVX2(blocks, out, n, static_cast<uint32_t>(threshold));
+        }
+#endif
+        else {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = word32(blocks, i) < threshold;
+            }
+        }
+        out += n;
+        count -= n;
+    }
+}
+
+void VariateGenerator::fillGaussian(float* out, size_t count, float sigma) {
+    gaussianRun(source, use_avx2, 0, out, count, sigma);
+}
+
+void VariateGenerator::fillGaussianAt(uint64_t offset, float* out, size_t count, float sigma) const {
+    LFSR replay = source;
+    replay.jump(64 * (offset / 2));
+    gaussianRun(replay, use_avx2, offset % 2, out, count, sigma);
+}
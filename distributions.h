@@ -0,0 +1,120 @@
+#ifndef DISTRIBUTIONS_H
+#define DISTRIBUTIONS_H
+
+#include "lfsr.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class VariateGenerator
+ * @brief Bulk uniform, bounded-integer, Bernoulli and Gaussian variates
+ *        from an LFSR
+ *
+ * Random words come from the register's block kernel in chunks and are
+ * converted array-at-a-time with AVX2 kernels (scalar fallback):
+ * - floats and doubles in [0, 1) by writing the top 23 or 52 random bits
+ *   into the mantissa of a number in [1, 2) and subtracting 1;
+ * - integers in [0, range) with Lemire's nearly divisionless method, the
+ *   high half of a 32x32-bit product, rejecting the rare biased words;
+ * - Bernoulli(p) draws by comparing 32-bit words with p * 2^32;
+ * - Gaussian samples by a table-based inverse CDF (see fillGaussian()).
+ *
+ * Each 64-bit block of the stream supplies two 32-bit words (low half
+ * first) or one double. Every fill call starts on a fresh block, so the
+ * output depends only on the register state and the sequence of calls,
+ * not on the instruction set used.
+ */
+class VariateGenerator {
+private:
+    LFSR source;      // Random bit stream
+    bool use_avx2;    // AVX2 kernels are available
+
+public:
+    /**
+     * @brief Constructor with the default 64-bit register
+     * @param seed Register seed (0 means use default)
+     *
+     * The register is x^64 + x^4 + x^3 + x + 1, as in ErrorChannel.
+     */
+    explicit VariateGenerator(uint64_t seed = 0);
+
+    /**
+     * @brief Constructor with a caller-supplied register
+     * @param generator Source register, copied with its current state
+     */
+    explicit VariateGenerator(const LFSR& generator);
+
+    /**
+     * @brief Fill with uniform floats in [0, 1)
+     * @param out Destination array
+     * @param count Number of variates
+     */
+    void fillUniform(float* out, size_t count);
+
+    /**
+     * @brief Fill with uniform doubles in [0, 1)
+     * @param out Destination array
+     * @param count Number of variates
+     */
+    void fillUniform(double* out, size_t count);
+
+    /**
+     * @brief Fill with uniform integers in [0, range)
+     * @param out Destination array
+     * @param count Number of variates
+     * @param range Exclusive upper bound
+     * @throw std::invalid_argument if range is zero
+     */
+    void fillBounded(uint32_t* out, size_t count, uint32_t range);
+
+    /**
+     * @brief Fill with Bernoulli trials
+     * @param out Destination, 1 with probability p and 0 otherwise
+     * @param count Number of trials
+     * @param p Success probability, resolved to 2^-32
+     * @throw std::invalid_argument if p is not in [0, 1]
+     */
+    void fillBernoulli(uint8_t* out, size_t count, double p);
+
+    /**
+     * @brief Fill with Gaussian noise
+     * @param out Destination array
+     * @param count Number of samples
+     * @param sigma Standard deviation
+     *
+     * Sample k uses word k: its top bit is the sign and the other 31 bits
+     * a tail probability p in (0, 1/2), mapped through the inverse of the
+     * Gaussian tail function. The inverse is interpolated linearly in p
+     * between 2048 nodes spaced 1/64 of an octave apart, accurate to about
+     * 1e-5; magnitudes are truncated at 6.2 sigma (p = 2^-33).
+     */
+    void fillGaussian(float* out, size_t count, float sigma);
+
+    /**
+     * @brief Replay Gaussian noise from a sample offset
+     * @param offset Samples to skip from the current stream position
+     * @param out Destination array
+     * @param count Number of samples
+     * @param sigma Standard deviation
+     *
+     * Produces samples offset .. offset + count - 1 of what
+     * fillGaussian() would generate from here, using jump-ahead, and
+     * leaves the generator unchanged. A noise realization is thus fixed
+     * by the register polynomial, the seed and the offset.
+     */
+    void fillGaussianAt(uint64_t offset, float* out, size_t count, float sigma) const;
+
+    /**
+     * @brief Skip part of the stream
+     * @param blocks Number of 64-bit blocks to skip
+     */
+    void skip(uint64_t blocks) { source.jump(64 * blocks); }
+
+    /**
+     * @brief Get the source register
+     * @return Register positioned at the next unused block
+     */
+    const LFSR& getSource() const { return source; }
+};
+
+#endif // DISTRIBUTIONS_H
@@ -0,0 +1,167 @@
+#include "dither.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DITHER_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Frames dithered per pass
+constexpr size_t CHUNK_FRAMES = 256;
+
+// Blocks reserved for each channel's substream (2^41 frames)
+constexpr uint64_t SUBSTREAM_BLOCKS = 1ULL << 40;
+
+// Scaled sample plus dither, saturated and rounded to nearest. The sum is
+// exact in double; in float a 24-bit sample above 0.5 FS has half-LSB
+// steps, which would round the dither away and bias the ties
+inline int32_t quantize(float sample, float noise, double scale, double low, double high) {
+    double value = std::min(std::max(sample * scale + noise, low), high);
+    return static_cast<int32_t>(std::lrint(value));
+}
+
+#ifdef DITHER_HAVE_AVX2
+
+// Four samples of quantize(), widened to double
+__attribute__((target("avx2")))
+inline __m128i quantizeHalfAVX2(const float* in, const float* noise, __m256d scale, __m256d low, __m256d high) {
+    __m256d value = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(in)), scale),
+                                  _mm256_cvtps_pd(_mm_loadu_ps(noise)));
+    value = _mm256_min_pd(_mm256_max_pd(value, low), high);
+    return _mm256_cvtpd_epi32(value);
+}
+
+// Eight samples of quantize()
+__attribute__((target("avx2")))
+inline __m256i quantizeAVX2(const float* in, const float* noise, __m256d scale, __m256d low, __m256d high) {
+    __m128i first = quantizeHalfAVX2(in, noise, scale, low, high);
+    __m128i second = quantizeHalfAVX2(in + 4, noise + 4, scale, low, high);
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+}
+
+__attribute__((target("avx2")))
+size_t quantizeInt16AVX2(const float* in, const float* noise, int16_t* out, size_t count) {
+    const __m256d scale = _mm256_set1_pd(32768.0);
+    const __m256d low = _mm256_set1_pd(-32768.0);
+    const __m256d high = _mm256_set1_pd(32767.0);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = quantizeAVX2(in + i, noise + i, scale, low, high);
+        __m256i b = quantizeAVX2(in + i + 8, noise + i + 8, scale, low, high);
+        // Pack works per 128-bit lane; restore sample order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t quantizeInt24AVX2(const float* in, const float* noise, int32_t* out, size_t count) {
+    const __m256d scale = _mm256_set1_pd(8388608.0);
+    const __m256d low = _mm256_set1_pd(-8388608.0);
+    const __m256d high = _mm256_set1_pd(8388607.0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), quantizeAVX2(in + i, noise + i, scale, low, high));
+    }
+    return i;
+}
+
+#endif // DITHER_HAVE_AVX2
+
+} // namespace
+
+TPDFDither::TPDFDither(size_t channel_count, uint64_t seed)
+    : channels(channel_count), use_avx2(false) {
+
+    if (channel_count == 0 || channel_count > (1u << 18)) {
+        throw std::invalid_argument("Channel count must be between 1 and 2^18");
+    }
+    LFSR source = LFSR::makeDefaultSource(seed);
+    const uint64_t spacing = source.jumpPolynomial(64 * SUBSTREAM_BLOCKS);
+    sources.reserve(channels);
+    for (size_t c = 0; c < channels; c++) {
+        sources.push_back(source);
+        source.applyJump(spacing, 64 * SUBSTREAM_BLOCKS);
+    }
+    noise.resize(CHUNK_FRAMES * channels);
+    spare.assign(channels, 0);
+    has_spare.assign(channels, false);
+#ifdef DITHER_HAVE_AVX2
+    use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+void TPDFDither::generateNoise(size_t frames) {
+    uint64_t blocks[CHUNK_FRAMES / 2 + 1];
+    uint32_t words[CHUNK_FRAMES + 2];
+    for (size_t c = 0; c < channels; c++) {
+        // A word left over from an odd-length chunk is used first, so the
+        // noise does not depend on how the stream is cut into blocks
+        size_t available = 0;
+        if (has_spare[c]) {
+            words[available++] = spare[c];
+        }
+        const size_t block_count = (frames - available + 1) / 2;
+        sources[c].fillBlocks(blocks, block_count);
+        for (size_t i = 0; i < block_count; i++) {
+            words[available++] = static_cast<uint32_t>(blocks[i]);
+            words[available++] = static_cast<uint32_t>(blocks[i] >> 32);
+        }
+        has_spare[c] = available > frames;
+        if (has_spare[c]) {
+            spare[c] = words[frames];
+        }
+
+        for (size_t f = 0; f < frames; f++) {
+            // Difference of two 16-bit uniforms, in LSB units
+            int32_t a = static_cast<int32_t>(words[f] & 0xFFFF);
+            int32_t b = static_cast<int32_t>(words[f] >> 16);
+            noise[f * channels + c] = static_cast<float>(a - b) * 0x1p-16f;
+        }
+    }
+}
+
+void TPDFDither::processInt16(const float* in, int16_t* out, size_t frames) {
+    while (frames > 0) {
+        const size_t n = std::min(frames, CHUNK_FRAMES);
+        const size_t count = n * channels;
+        generateNoise(n);
+        size_t i = 0;
+#ifdef DITHER_HAVE_AVX2
+        if (use_avx2) {
+            i = quantizeInt16AVX2(in, noise.data(), out, count);
+        }
+#endif
+        for (; i < count; i++) {
+            out[i] = static_cast<int16_t>(quantize(in[i], noise[i], 32768.0, -32768.0, 32767.0));
+        }
+        in += count;
+        out += count;
+        frames -= n;
+    }
+}
+
+void TPDFDither::processInt24(const float* in, int32_t* out, size_t frames) {
+    while (frames > 0) {
+        const size_t n = std::min(frames, CHUNK_FRAMES);
+        const size_t count = n * channels;
+        generateNoise(n);
+        size_t i = 0;
+#ifdef DITHER_HAVE_AVX2
+        if (use_avx2) {
+            i = quantizeInt24AVX2(in, noise.data(), out, count);
+        }
+#endif
+        for (; i < count; i++) {
+            out[i] = quantize(in[i], noise[i], 8388608.0, -8388608.0, 8388607.0);
+        }
+        in += count;
+        out += count;
+        frames -= n;
+    }
+}
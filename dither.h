@@ -0,0 +1,82 @@
+#ifndef DITHER_H
+#define DITHER_H
+
+#include "lfsr.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class TPDFDither
+ * @brief Triangular-PDF dithering of float audio to 16- or 24-bit integers
+ *
+ * Full scale is +-1.0. Each output sample is round(x * 2^(bits-1) + d),
+ * saturated to the integer range, where d is the difference of two
+ * uniform variates and so has a triangular distribution over (-1, 1) LSB.
+ * Both variates come from one 32-bit word of the channel's register
+ * stream (16 bits each), two frames per 64-bit block.
+ *
+ * Every channel has its own substream: LFSR::makeDefaultSource(seed),
+ * jumped 2^40 blocks further for each channel index,
+ * so a channel's noise depends only on the seed, its index and the
+ * number of frames processed before, never on block sizes. Buffers are
+ * interleaved; the noise is generated per channel from bulk blocks and
+ * added, rounded and saturated with AVX2 over the interleaved frames.
+ * The sum is formed in double, where it is exact for both widths.
+ */
+class TPDFDither {
+private:
+    size_t channels;             // Interleaved channels per frame
+    std::vector<LFSR> sources;   // Noise substream per channel
+    std::vector<float> noise;    // Interleaved dither for one chunk
+    std::vector<uint32_t> spare; // Unused high word of a channel's last block
+    std::vector<bool> has_spare; // Whether spare holds a word
+    bool use_avx2;               // AVX2 kernels are available
+
+    /**
+     * @brief Generate interleaved dither for a chunk of frames
+     * @param frames Frames in the chunk
+     */
+    void generateNoise(size_t frames);
+
+public:
+    /**
+     * @brief Constructor
+     * @param channel_count Number of interleaved channels
+     * @param seed Seed of the first channel's register (0 means use default)
+     * @throw std::invalid_argument if channel_count is 0 or above 2^18
+     */
+    explicit TPDFDither(size_t channel_count, uint64_t seed = 0);
+
+    /**
+     * @brief Dither to 16-bit samples
+     * @param in frames * channels interleaved float samples
+     * @param out frames * channels interleaved output samples
+     * @param frames Number of frames
+     */
+    void processInt16(const float* in, int16_t* out, size_t frames);
+
+    /**
+     * @brief Dither to 24-bit samples
+     * @param in frames * channels interleaved float samples
+     * @param out frames * channels samples in [-2^23, 2^23 - 1],
+     *        right-aligned in 32-bit words
+     * @param frames Number of frames
+     */
+    void processInt24(const float* in, int32_t* out, size_t frames);
+
+    /**
+     * @brief Get number of channels
+     * @return Interleaved channels per frame
+     */
+    size_t getChannels() const { return channels; }
+
+    /**
+     * @brief Get a channel's noise source
+     * @param channel Channel index
+     * @return Register positioned at the channel's next frame
+     */
+    const LFSR& getChannelSource(size_t channel) const { return sources[channel]; }
+};
+
+#endif // DITHER_H
@@ -0,0 +1,93 @@
+#include "error_channel.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+} // namespace
+
+ErrorChannel::ErrorChannel(double ber, uint64_t seed)
+    : ErrorChannel(ber, ber, 0.0, 0.0, seed) {
+}
+
+ErrorChannel::ErrorChannel(double ber_good, double ber_bad,
+                           double good_to_bad, double bad_to_good, uint64_t seed)
+    : random_source(LFSR::makeDefaultSource(seed)),
+      error_probability{ber_good, ber_bad},
+      leave_probability{good_to_bad, bad_to_good},
+      channel_state(0), bits_to_error(0), bits_to_transition(0),
+      errors_injected(0), bits_processed(0) {
+    
+    validateProbability(ber_good);
+    validateProbability(ber_bad);
+    validateProbability(good_to_bad);
+    validateProbability(bad_to_good);
+    
+    enterState(0);
+}
+
+void ErrorChannel::validateProbability(double p) {
+    if (!(p >= 0.0 && p <= 1.0)) {
+        throw std::invalid_argument("Probability must be between 0 and 1");
+    }
+}
+
+uint64_t ErrorChannel::drawGeometric(double p) {
+    if (p <= 0.0) {
+        return NEVER;
+    }
+    if (p >= 1.0) {
+        return 0;
+    }
+    
+    // Inversion: floor(log(u) / log(1 - p)) with u uniform in (0, 1]
+    double u = ((random_source.nextBlock() >> 11) + 1) * 0x1.0p-53;
+    double skip = std::floor(std::log(u) / std::log1p(-p));
+    return skip >= 0x1.0p63 ? NEVER : static_cast<uint64_t>(skip);
+}
+
+void ErrorChannel::enterState(int state) {
+    channel_state = state;
+    uint64_t extra = drawGeometric(leave_probability[state]);
+    bits_to_transition = (extra == NEVER) ? NEVER : extra + 1;
+    bits_to_error = drawGeometric(error_probability[state]);
+}
+
+uint64_t ErrorChannel::apply(uint8_t* data, size_t len) {
+    const uint64_t total = static_cast<uint64_t>(len) * 8;
+    uint64_t position = 0;
+    uint64_t flipped = 0;
+    
+    while (true) {
+        uint64_t remaining = total - position;
+        
+        if (bits_to_error < bits_to_transition && bits_to_error < remaining) {
+            position += bits_to_error;
+            data[position / 8] ^= static_cast<uint8_t>(1U << (position % 8));
+            position++;
+            flipped++;
+            if (bits_to_transition != NEVER) {
+                bits_to_transition -= bits_to_error + 1;
+            }
+            bits_to_error = drawGeometric(error_probability[channel_state]);
+        } else if (bits_to_transition <= remaining) {
+            // Errors are memoryless, so the next one is redrawn in the new state
+            position += bits_to_transition;
+            enterState(1 - channel_state);
+        } else {
+            if (bits_to_error != NEVER) {
+                bits_to_error -= remaining;
+            }
+            if (bits_to_transition != NEVER) {
+                bits_to_transition -= remaining;
+            }
+            break;
+        }
+    }
+    
+    errors_injected += flipped;
+    bits_processed += total;
+    return flipped;
+}
@@ -0,0 +1,97 @@
+#ifndef ERROR_CHANNEL_H
+#define ERROR_CHANNEL_H
+
+#include "lfsr.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class ErrorChannel
+ * @brief Bit-error injection at a given BER, independent or bursty
+ * 
+ * Instead of drawing one random decision per data bit, the channel draws
+ * the geometric distance to the next error from a 64-bit maximal LFSR and
+ * jumps straight to it, so the cost scales with the number of errors.
+ * The bursty mode is a Gilbert-Elliott channel: a good and a bad state
+ * with their own BER, whose geometric sojourn times are drawn the same
+ * way. Bits are numbered LSB-first within each byte across calls.
+ */
+class ErrorChannel {
+private:
+    LFSR random_source;           // Uniform variates for skip distances
+    double error_probability[2];  // BER in the good [0] and bad [1] state
+    double leave_probability[2];  // Per-bit probability of leaving each state
+    int channel_state;            // 0 = good, 1 = bad
+    uint64_t bits_to_error;       // Error-free bits before the next error
+    uint64_t bits_to_transition;  // Bits left in the current state
+    uint64_t errors_injected;     // Total flipped bits
+    uint64_t bits_processed;      // Total bits passed through
+    
+    /**
+     * @brief Validate a probability argument
+     * @throw std::invalid_argument if p is not in [0, 1]
+     */
+    static void validateProbability(double p);
+    
+    /**
+     * @brief Draw the number of failures before the first success
+     * @param p Success probability per trial
+     * @return Geometric variate (UINT64_MAX if p is 0)
+     */
+    uint64_t drawGeometric(double p);
+    
+    /**
+     * @brief Enter a state and draw its duration and first error
+     * @param state 0 = good, 1 = bad
+     */
+    void enterState(int state);
+
+public:
+    /**
+     * @brief Constructor for independent errors
+     * @param ber Bit error rate (0-1)
+     * @param seed Seed for the random source (0 means use default)
+     * @throw std::invalid_argument if ber is out of range
+     */
+    explicit ErrorChannel(double ber, uint64_t seed = 0);
+    
+    /**
+     * @brief Constructor for a Gilbert-Elliott burst channel
+     * @param ber_good Bit error rate in the good state
+     * @param ber_bad Bit error rate in the bad state
+     * @param good_to_bad Per-bit probability of entering the bad state
+     * @param bad_to_good Per-bit probability of returning to the good state
+     * @param seed Seed for the random source (0 means use default)
+     * @throw std::invalid_argument if a probability is out of range
+     */
+    ErrorChannel(double ber_good, double ber_bad,
+                 double good_to_bad, double bad_to_good, uint64_t seed = 0);
+    
+    /**
+     * @brief Flip bits of a buffer in place
+     * @param data Buffer passing through the channel
+     * @param len Buffer length in bytes
+     * @return Number of bits flipped in this buffer
+     */
+    uint64_t apply(uint8_t* data, size_t len);
+    
+    /**
+     * @brief Check whether the channel is in the bad state
+     * @return true if in the bad (burst) state
+     */
+    bool inBurst() const { return channel_state == 1; }
+    
+    /**
+     * @brief Get total number of flipped bits
+     * @return Errors injected since construction
+     */
+    uint64_t getErrorsInjected() const { return errors_injected; }
+    
+    /**
+     * @brief Get total number of bits passed through
+     * @return Bits processed since construction
+     */
+    uint64_t getBitsProcessed() const { return bits_processed; }
+};
+
+#endif // ERROR_CHANNEL_H
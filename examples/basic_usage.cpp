@@ -6,9 +6,12 @@
  */
 
 #include "../lfsr.h"
+#include "../text_format.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <bitset>
+#include <string>
 
 int main() {
     std::cout << "=== Базовые примеры использования LFSR ===\n\n";
@@ -19,14 +22,20 @@ int main() {
     
     std::cout << "   Полином: " << lfsr1.getPolynomialString() << "\n";
     std::cout << "   Начальное состояние: " << lfsr1.getStateString() << "\n";
-    std::cout << "   Последовательность: ";
     
+    // Биты упаковываются и форматируются одним вызовом
+    uint8_t packed[2] = {0, 0};
     for (int i = 0; i < 10; i++) {
-        bool bit = lfsr1.nextBit();
-        std::cout << (bit ? '1' : '0');
-        if ((i + 1) % 4 == 0) std::cout << " ";
+        packed[i / 8] |= static_cast<uint8_t>(lfsr1.nextBit()) << (i % 8);
     }
-    std::cout << "\n\n";
+    char text[10];
+    TextFormatter().formatBits(packed, 10, text);
+    std::string grouped;
+    for (int i = 0; i < 10; i += 4) {
+        grouped.append(text + i, std::min(4, 10 - i));
+        if (i + 4 <= 10) grouped += ' ';
+    }
+    std::cout << "   Последовательность: " << grouped << "\n\n";
     
     // Пример 2: Генерация байтов
     std::cout << "2. Генерация байтов (8-битный LFSR):\n";
@@ -0,0 +1,245 @@
+#include "galois_field.h"
+#include "lfsr.h"
+#include "gf2poly.h"
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GF_HAVE_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Product tables of a constant, split by input nibble:
+// c * b = low[b & 15] ^ high[b >> 4]
+struct NibbleTables {
+    alignas(16) uint8_t low[16];
+    alignas(16) uint8_t high[16];
+};
+
+template <bool ACCUMULATE>
+void regionScalar(const NibbleTables& t, const uint8_t* src, uint8_t* dst, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t product = t.low[src[i] & 0x0F] ^ t.high[src[i] >> 4];
+        dst[i] = ACCUMULATE ? dst[i] ^ product : product;
+    }
+}
+
+#ifdef GF_HAVE_SIMD
+
+template <bool ACCUMULATE>
+__attribute__((target("ssse3")))
+size_t regionShuffle128(const NibbleTables& t, const uint8_t* src, uint8_t* dst, size_t len) {
+    const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(t.low));
+    const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(t.high));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i product = _mm_xor_si128(
+            _mm_shuffle_epi8(low, _mm_and_si128(in, nibble)),
+            _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi64(in, 4), nibble)));
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+        if (ACCUMULATE) product = _mm_xor_si128(product, _mm_loadu_si128(out));
+        _mm_storeu_si128(out, product);
+    }
+    return i;
+}
+
+template <bool ACCUMULATE>
+__attribute__((target("avx2")))
+size_t regionShuffle256(const NibbleTables& t, const uint8_t* src, uint8_t* dst, size_t len) {
+    const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.low)));
+    const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.high)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i product = _mm256_xor_si256(
+            _mm256_shuffle_epi8(low, _mm256_and_si256(in, nibble)),
+            _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi64(in, 4), nibble)));
+        __m256i* out = reinterpret_cast<__m256i*>(dst + i);
+        if (ACCUMULATE) product = _mm256_xor_si256(product, _mm256_loadu_si256(out));
+        _mm256_storeu_si256(out, product);
+    }
+    return i;
+}
+
+// Multiplication by a constant is linear over GF(2), so it is an 8x8 bit
+// matrix; the affine instruction applies it to every byte, for any field
+// polynomial (the GF2P8MULB instruction is fixed to the AES polynomial).
+template <bool ACCUMULATE>
+__attribute__((target("gfni,avx2")))
+size_t regionAffine256(uint64_t matrix, const uint8_t* src, uint8_t* dst, size_t len) {
+    const __m256i m = _mm256_set1_epi64x(static_cast<long long>(matrix));
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i product = _mm256_gf2p8affine_epi64_epi8(in, m, 0);
+        __m256i* out = reinterpret_cast<__m256i*>(dst + i);
+        if (ACCUMULATE) product = _mm256_xor_si256(product, _mm256_loadu_si256(out));
+        _mm256_storeu_si256(out, product);
+    }
+    return i;
+}
+
+#endif // GF_HAVE_SIMD
+
+} // namespace
+
+GaloisField::GaloisField(int n)
+    : degree(n), order(0), polynomial(0), kernel(GFKernel::Scalar) {
+
+    if (n < 3 || n > 16) {
+        throw std::invalid_argument("Field degree must be between 3 and 16");
+    }
+    polynomial = static_cast<uint32_t>(LFSR::maximalPolynomial(static_cast<uint8_t>(n)));
+    order = (1u << n) - 1;
+
+    // Walk the powers of x; the table is doubled so that multiply() can
+    // index log(a) + log(b) without a modulo
+    exp_table.resize(2 * size_t(order));
+    log_table.assign(size_t(order) + 1, 0);
+    uint64_t value = 1;
+    for (uint32_t i = 0; i < order; i++) {
+        if (i > 0 && value == 1) {
+            throw std::logic_error("Field polynomial is not primitive");
+        }
+        exp_table[i] = static_cast<uint16_t>(value);
+        exp_table[i + order] = static_cast<uint16_t>(value);
+        log_table[value] = i;
+        value = gf2MulX(value, polynomial, n);
+    }
+
+    if (degree <= 8) {
+        for (GFKernel k : {GFKernel::GFNI, GFKernel::AVX2, GFKernel::SSSE3}) {
+            if (isKernelSupported(k)) {
+                kernel = k;
+                break;
+            }
+        }
+    }
+}
+
+uint16_t GaloisField::divide(uint16_t a, uint16_t b) const {
+    if (b == 0) {
+        throw std::invalid_argument("Division by zero in GF(2^n)");
+    }
+    if (a > order || b > order) {
+        throw std::invalid_argument("Operand is not a field element");
+    }
+    if (a == 0) return 0;
+    return exp_table[log_table[a] + order - log_table[b]];
+}
+
+uint16_t GaloisField::inverse(uint16_t a) const {
+    return divide(1, a);
+}
+
+uint16_t GaloisField::power(uint16_t a, uint64_t e) const {
+    if (a > order) {
+        throw std::invalid_argument("Operand is not a field element");
+    }
+    if (e == 0) return 1;
+    if (a == 0) return 0;
+    return exp_table[(log_table[a] * (e % order)) % order];
+}
+
+uint32_t GaloisField::log(uint16_t a) const {
+    if (a == 0 || a > order) {
+        throw std::invalid_argument("Logarithm of zero or non-element");
+    }
+    return log_table[a];
+}
+
+void GaloisField::multiplyRegion(const uint8_t* src, uint8_t* dst, size_t len, uint16_t c) const {
+    applyRegion(src, dst, len, c, false);
+}
+
+void GaloisField::multiplyAddRegion(const uint8_t* src, uint8_t* dst, size_t len, uint16_t c) const {
+    applyRegion(src, dst, len, c, true);
+}
+
+void GaloisField::applyRegion(const uint8_t* src, uint8_t* dst, size_t len,
+                              uint16_t c, bool accumulate) const {
+    if (degree > 8) {
+        throw std::invalid_argument("Region operations need a field of degree 8 or less");
+    }
+    if (c > order) {
+        throw std::invalid_argument("Constant is not a field element");
+    }
+
+    // Columns of the multiplication matrix: c * x^j for each input bit j
+    uint8_t column[8] = {};
+    for (int j = 0; j < degree; j++) {
+        column[j] = static_cast<uint8_t>(multiply(c, static_cast<uint16_t>(1u << j)));
+    }
+
+    size_t done = 0;
+#ifdef GF_HAVE_SIMD
+    if (kernel == GFKernel::GFNI) {
+        // Row i of the matrix (output bit i) sits in byte 7 - i
+        uint64_t matrix = 0;
+        for (int j = 0; j < 8; j++) {
+            for (int i = 0; i < 8; i++) {
+                if ((column[j] >> i) & 1) matrix |= 1ULL << (8 * (7 - i) + j);
+            }
+        }
+        done = accumulate ? regionAffine256<true>(matrix, src, dst, len)
+                          : regionAffine256<false>(matrix, src, dst, len);
+    }
+#endif
+
+    NibbleTables t;
+    for (int b = 0; b < 16; b++) {
+        uint8_t low = 0, high = 0;
+        for (int j = 0; j < 4; j++) {
+            if ((b >> j) & 1) {
+                low ^= column[j];
+                high ^= column[j + 4];
+            }
+        }
+        t.low[b] = low;
+        t.high[b] = high;
+    }
+
+#ifdef GF_HAVE_SIMD
+    if (kernel == GFKernel::AVX2) {
+        done = accumulate ? regionShuffle256<true>(t, src, dst, len)
+                          : regionShuffle256<false>(t, src, dst, len);
+    } else if (kernel == GFKernel::SSSE3) {
+        done = accumulate ? regionShuffle128<true>(t, src, dst, len)
+                          : regionShuffle128<false>(t, src, dst, len);
+    }
+#endif
+
+    if (accumulate) {
+        regionScalar<true>(t, src + done, dst + done, len - done);
+    } else {
+        regionScalar<false>(t, src + done, dst + done, len - done);
+    }
+}
+
+bool GaloisField::isKernelSupported(GFKernel kernel) {
+    switch (kernel) {
+    case GFKernel::Scalar:
+        return true;
+#ifdef GF_HAVE_SIMD
+    case GFKernel::SSSE3:
+        return __builtin_cpu_supports("ssse3");
+    case GFKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case GFKernel::GFNI:
+        return __builtin_cpu_supports("gfni") && __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+void GaloisField::setKernel(GFKernel new_kernel) {
+    if (!isKernelSupported(new_kernel)) {
+        throw std::invalid_argument("Region kernel not supported on this CPU");
+    }
+    kernel = new_kernel;
+}
@@ -0,0 +1,168 @@
+#ifndef GALOIS_FIELD_H
+#define GALOIS_FIELD_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @enum GFKernel
+ * @brief Implementation of the GF(2^n) region kernels
+ */
+enum class GFKernel {
+    Scalar,   // Split nibble tables, one byte at a time
+    SSSE3,    // Split nibble tables with PSHUFB, 16 bytes per step
+    AVX2,     // Split nibble tables with VPSHUFB, 32 bytes per step
+    GFNI      // Multiplication matrix with VGF2P8AFFINEQB, 32 bytes per step
+};
+
+/**
+ * @class GaloisField
+ * @brief Arithmetic in GF(2^n) for n = 3..16
+ *
+ * The field is GF(2)[x] modulo the degree-n primitive polynomial of the
+ * LFSR class, whose powers of x run through every non-zero element, so
+ * x is a generator and exp/log tables cover the whole multiplicative
+ * group. Elements are bit masks with bit i holding the x^i coefficient.
+ *
+ * For n <= 8 each byte of a buffer is one element, and buffers can be
+ * multiplied by a constant in bulk. These region kernels split the
+ * constant's product table into low- and high-nibble halves that fit a
+ * byte shuffle, or, on CPUs with GFNI, express the product as an 8x8
+ * bit matrix applied by an affine instruction. The fastest supported
+ * kernel is selected at construction.
+ */
+class GaloisField {
+private:
+    int degree;                       // n
+    uint32_t order;                   // 2^n - 1, size of the multiplicative group
+    uint32_t polynomial;              // Terms of the field polynomial below x^n
+    std::vector<uint16_t> exp_table;  // x^i for i in [0, 2 * order)
+    std::vector<uint32_t> log_table;  // log_x(a) for a in [1, 2^n)
+    GFKernel kernel;                  // Region kernel in use
+
+    /**
+     * @brief Apply c * src to dst, replacing or accumulating
+     */
+    void applyRegion(const uint8_t* src, uint8_t* dst, size_t len,
+                     uint16_t c, bool accumulate) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param n Field degree (3-16)
+     * @throw std::invalid_argument if n is out of range
+     */
+    explicit GaloisField(int n);
+
+    /**
+     * @brief Multiply two elements
+     * @return a * b
+     * @throw std::invalid_argument if a or b is not a field element
+     */
+    uint16_t multiply(uint16_t a, uint16_t b) const {
+        if (a > order || b > order) {
+            throw std::invalid_argument("Operand is not a field element");
+        }
+        if (a == 0 || b == 0) return 0;
+        return exp_table[log_table[a] + log_table[b]];
+    }
+
+    /**
+     * @brief Divide two elements
+     * @return a / b
+     * @throw std::invalid_argument if b is zero or an operand is not a field element
+     */
+    uint16_t divide(uint16_t a, uint16_t b) const;
+
+    /**
+     * @brief Multiplicative inverse
+     * @return a^-1
+     * @throw std::invalid_argument if a is zero or not a field element
+     */
+    uint16_t inverse(uint16_t a) const;
+
+    /**
+     * @brief Raise an element to a power
+     * @return a^e (0^0 is 1)
+     * @throw std::invalid_argument if a is not a field element
+     */
+    uint16_t power(uint16_t a, uint64_t e) const;
+
+    /**
+     * @brief Power of the generator
+     * @return x^i
+     */
+    uint16_t exp(uint64_t i) const { return exp_table[i % order]; }
+
+    /**
+     * @brief Discrete logarithm to base x
+     * @return i in [0, 2^n - 2] with x^i = a
+     * @throw std::invalid_argument if a is zero
+     */
+    uint32_t log(uint16_t a) const;
+
+    /**
+     * @brief Multiply a buffer by a constant: dst[i] = c * src[i]
+     * @param src Source elements, one per byte (bits above n are ignored)
+     * @param dst Destination (may equal src)
+     * @param len Number of elements
+     * @param c Constant factor
+     * @throw std::invalid_argument if the field degree is above 8 or c is
+     *        not a field element
+     */
+    void multiplyRegion(const uint8_t* src, uint8_t* dst, size_t len, uint16_t c) const;
+
+    /**
+     * @brief Multiply-accumulate a buffer: dst[i] ^= c * src[i]
+     * @param src Source elements, one per byte (bits above n are ignored)
+     * @param dst Accumulator (may equal src)
+     * @param len Number of elements
+     * @param c Constant factor
+     * @throw std::invalid_argument if the field degree is above 8 or c is
+     *        not a field element
+     *
+     * The inner step of Reed-Solomon encoding and erasure decoding.
+     */
+    void multiplyAddRegion(const uint8_t* src, uint8_t* dst, size_t len, uint16_t c) const;
+
+    /**
+     * @brief Check whether this CPU can run a region kernel
+     * @return true if kernel is available
+     */
+    static bool isKernelSupported(GFKernel kernel);
+
+    /**
+     * @brief Select the region kernel
+     * @param kernel Kernel to use
+     * @throw std::invalid_argument if the CPU does not support it
+     */
+    void setKernel(GFKernel kernel);
+
+    /**
+     * @brief Get the region kernel in use
+     * @return Selected kernel
+     */
+    GFKernel getKernel() const { return kernel; }
+
+    /**
+     * @brief Get field degree
+     * @return n
+     */
+    int getDegree() const { return degree; }
+
+    /**
+     * @brief Get number of field elements
+     * @return 2^n
+     */
+    uint32_t getSize() const { return order + 1; }
+
+    /**
+     * @brief Get field polynomial
+     * @return Terms below x^n, bit i for x^i
+     */
+    uint32_t getPolynomial() const { return polynomial; }
+};
+
+#endif // GALOIS_FIELD_H
@@ -0,0 +1,606 @@
+#include "generator_daemon.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Start of a client's shared mapping. The producer and consumer halves sit
+ * on separate cache lines; the generated bytes follow at RING_DATA_OFFSET.
+ * Positions count bytes since the ring was created and never wrap.
+ */
+struct DaemonRingHeader {
+    uint64_t magic;
+    uint64_t capacity;                          // Power of two
+    alignas(64) std::atomic<uint64_t> write_pos;
+    std::atomic<uint32_t> data_seq;             // Futex: bumped after publishing data or closing
+    std::atomic<uint32_t> consumer_waiting;
+    std::atomic<uint32_t> closed;               // The daemon will publish no more data
+    alignas(64) std::atomic<uint64_t> read_pos;
+    std::atomic<uint32_t> space_seq;            // Futex: bumped after consuming data or closing
+    std::atomic<uint32_t> producer_waiting;
+    alignas(64) std::atomic<uint64_t> producer_stalls;
+    std::atomic<uint64_t> consumer_waits;
+};
+
+namespace {
+
+constexpr uint64_t RING_MAGIC = 0x474E495244534C46ULL;  // "LFSDRING"
+constexpr size_t RING_DATA_OFFSET = 4096;
+constexpr size_t MIN_RING_BYTES = 4096;
+
+constexpr uint32_t PROTOCOL_MAGIC = 0x4453464C;  // "LFSD"
+constexpr uint32_t COMMAND_OPEN = 1;
+constexpr uint32_t COMMAND_STATS = 2;
+constexpr size_t STREAM_NAME_BYTES = 64;
+
+// How often a waiting client checks that the daemon is still there
+constexpr long CONSUMER_WAIT_NS = 100 * 1000 * 1000;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared counters must be lock-free");
+static_assert(sizeof(DaemonRingHeader) <= RING_DATA_OFFSET, "Ring header overlaps the data");
+
+struct Request {
+    uint32_t magic;
+    uint32_t command;
+    uint64_t substream;
+    uint64_t ring_bytes;
+    char stream[STREAM_NAME_BYTES];
+};
+
+struct Reply {
+    uint32_t magic;
+    int32_t error;                  // 0, or an errno value with message set
+    uint64_t substream;
+    uint64_t start_offset;
+    uint64_t ring_bytes;
+    DaemonStats stats;
+    char message[128];
+};
+
+size_t roundRingBytes(size_t bytes) {
+    size_t rounded = MIN_RING_BYTES;
+    while (rounded < bytes && rounded <= (SIZE_MAX >> 1)) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path is empty or too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return address;
+}
+
+// Connected control socket, or -1 with errno set
+int connectTo(const std::string& path) {
+    sockaddr_un address = socketAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+bool sendReply(int fd, const Reply& reply, int ring_fd) {
+    iovec chunk{const_cast<Reply*>(&reply), sizeof(reply)};
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &chunk;
+    message.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (ring_fd >= 0) {
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(header), &ring_fd, sizeof(int));
+    }
+    return ::sendmsg(fd, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(reply));
+}
+
+Reply errorReply(int error, const std::string& text) {
+    Reply reply;
+    std::memset(&reply, 0, sizeof(reply));
+    reply.magic = PROTOCOL_MAGIC;
+    reply.error = error;
+    std::strncpy(reply.message, text.c_str(), sizeof(reply.message) - 1);
+    return reply;
+}
+
+// Send a request and wait for the reply, taking any descriptor passed with it
+Reply exchange(int fd, const Request& request, int* ring_fd) {
+    if (::send(fd, &request, sizeof(request), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(request))) {
+        throw systemError("Cannot send request to generator daemon", errno);
+    }
+    Reply reply;
+    iovec chunk{&reply, sizeof(reply)};
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &chunk;
+    message.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t received;
+    do {
+        received = ::recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        throw systemError("No reply from generator daemon", errno);
+    }
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+            int passed;
+            std::memcpy(&passed, CMSG_DATA(header), sizeof(int));
+            if (ring_fd != nullptr && *ring_fd < 0) {
+                *ring_fd = passed;
+            } else {
+                ::close(passed);
+            }
+        }
+    }
+    if (received != static_cast<ssize_t>(sizeof(reply)) || reply.magic != PROTOCOL_MAGIC) {
+        throw std::runtime_error("Malformed reply from generator daemon");
+    }
+    reply.message[sizeof(reply.message) - 1] = '\0';
+    if (reply.error != 0) {
+        throw std::runtime_error(std::string("Generator daemon refused the request: ") + reply.message);
+    }
+    return reply;
+}
+
+void addCounters(DaemonStats& totals, const DaemonRingHeader& header) {
+    totals.bytes_generated += header.write_pos.load();
+    totals.bytes_consumed += header.read_pos.load();
+    totals.producer_stalls += header.producer_stalls.load();
+    totals.consumer_waits += header.consumer_waits.load();
+}
+
+} // namespace
+
+struct GeneratorDaemon::Session {
+    int fd;
+    std::thread thread;
+    std::atomic<bool> done{false};
+    DaemonRingHeader* header = nullptr;   // Set while a ring is open
+
+    explicit Session(int client_fd) : fd(client_fd) {}
+};
+
+GeneratorDaemon::GeneratorDaemon(const std::string& path, const std::vector<DaemonStreamConfig>& configs,
+                                 const DaemonOptions& daemon_options)
+    : socket_path(path), options(daemon_options), finished() {
+    if (options.fill_bytes == 0 || options.max_ring_bytes < MIN_RING_BYTES ||
+        roundRingBytes(options.default_ring_bytes) > options.max_ring_bytes) {
+        throw std::invalid_argument("Invalid daemon ring or fill size");
+    }
+    if (configs.empty()) {
+        throw std::invalid_argument("Generator daemon needs at least one stream");
+    }
+    for (const DaemonStreamConfig& config : configs) {
+        if (config.name.empty() || config.name.size() >= STREAM_NAME_BYTES) {
+            throw std::invalid_argument("Stream name is empty or too long: " + config.name);
+        }
+        if (streams.count(config.name) != 0) {
+            throw std::invalid_argument("Duplicate stream name: " + config.name);
+        }
+        if (config.substream_bytes == 0) {
+            throw std::invalid_argument("Substream spacing must be non-zero");
+        }
+        uint64_t polynomial = config.polynomial ? config.polynomial : LFSR::maximalPolynomial(config.register_size);
+        // Copies of the prototype share its block tables
+        LFSR prototype(config.register_size, polynomial, config.seed);
+        streams.emplace(config.name, std::unique_ptr<Stream>(new Stream{config, prototype, 0}));
+    }
+
+    sockaddr_un address = socketAddress(path);
+    int existing = connectTo(path);
+    if (existing >= 0) {
+        ::close(existing);
+        throw std::runtime_error("A generator daemon is already serving " + path);
+    }
+    // Only a socket left behind by a daemon that died is replaced
+    struct stat status;
+    const bool stale = ::lstat(path.c_str(), &status) == 0;
+    if (!stale && errno != ENOENT) {
+        throw systemError("Cannot check " + path, errno);
+    }
+    if (stale && !S_ISSOCK(status.st_mode)) {
+        throw std::runtime_error("Not replacing " + path + ": it exists and is not a socket");
+    }
+    if (::pipe2(wake_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        throw systemError("Cannot create wake-up pipe", errno);
+    }
+    listen_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        int error = errno;
+        ::close(wake_pipe[0]);
+        ::close(wake_pipe[1]);
+        throw systemError("Cannot create socket", error);
+    }
+    if (stale) {
+        ::unlink(path.c_str());
+    }
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd, 64) != 0) {
+        int error = errno;
+        ::close(listen_fd);
+        ::close(wake_pipe[0]);
+        ::close(wake_pipe[1]);
+        throw systemError("Cannot listen on " + path, error);
+    }
+}
+
+GeneratorDaemon::~GeneratorDaemon() {
+    reapSessions(true);
+    ::close(listen_fd);
+    ::close(wake_pipe[0]);
+    ::close(wake_pipe[1]);
+    ::unlink(socket_path.c_str());
+}
+
+void GeneratorDaemon::run() {
+    pollfd watched[2] = {{listen_fd, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+    for (;;) {
+        if (::poll(watched, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Cannot wait for clients", errno);
+        }
+        if (watched[1].revents != 0) {
+            break;
+        }
+        int client = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        reapSessions(false);
+        std::lock_guard<std::mutex> guard(lock);
+        sessions.emplace_back(new Session(client));
+        Session& session = *sessions.back();
+        session.thread = std::thread(&GeneratorDaemon::serveSession, this, std::ref(session));
+    }
+    char drained[64];
+    while (::read(wake_pipe[0], drained, sizeof(drained)) > 0) {
+    }
+    reapSessions(true);
+}
+
+void GeneratorDaemon::stop() {
+    const char wake = 1;
+    if (::write(wake_pipe[1], &wake, 1) < 0) {
+        // Already pending: the pipe is full
+    }
+}
+
+void GeneratorDaemon::reapSessions(bool all) {
+    std::list<std::unique_ptr<Session>> ended;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto it = sessions.begin(); it != sessions.end();) {
+            if (all || (*it)->done.load()) {
+                if (all) {
+                    ::shutdown((*it)->fd, SHUT_RDWR);
+                }
+                ended.splice(ended.end(), sessions, it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& session : ended) {
+        session->thread.join();
+        ::close(session->fd);
+    }
+}
+
+void GeneratorDaemon::serveSession(Session& session) {
+    Request request;
+    ssize_t received;
+    do {
+        received = ::recv(session.fd, &request, sizeof(request), 0);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) {
+        session.done = true;
+        return;
+    }
+
+    auto reject = [&](int error, const std::string& text) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished.requests_rejected++;
+        }
+        sendReply(session.fd, errorReply(error, text), -1);
+        session.done = true;
+    };
+    if (received != static_cast<ssize_t>(sizeof(request)) || request.magic != PROTOCOL_MAGIC) {
+        reject(EPROTO, "Malformed request");
+        return;
+    }
+    if (request.command == COMMAND_STATS) {
+        Reply reply = errorReply(0, "");
+        reply.stats = getStats();
+        sendReply(session.fd, reply, -1);
+        session.done = true;
+        return;
+    }
+    if (request.command != COMMAND_OPEN) {
+        reject(EPROTO, "Unknown command");
+        return;
+    }
+
+    // Resolve the stream and claim a substream
+    request.stream[STREAM_NAME_BYTES - 1] = '\0';
+    auto found = streams.find(request.stream);
+    if (found == streams.end()) {
+        reject(ENOENT, std::string("No stream named ") + request.stream);
+        return;
+    }
+    Stream& stream = *found->second;
+    const size_t capacity = roundRingBytes(request.ring_bytes ? request.ring_bytes : options.default_ring_bytes);
+    if (request.ring_bytes > options.max_ring_bytes || capacity > options.max_ring_bytes) {
+        reject(EINVAL, "Ring size exceeds the daemon's limit");
+        return;
+    }
+    uint64_t substream;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        substream = request.substream == DAEMON_NEXT_SUBSTREAM ? stream.next_substream : request.substream;
+        if (substream < UINT64_MAX) {
+            stream.next_substream = std::max(stream.next_substream, substream + 1);
+        }
+    }
+    if (substream > UINT64_MAX / stream.config.substream_bytes) {
+        reject(EINVAL, "Substream number out of range");
+        return;
+    }
+    const uint64_t start_offset = substream * stream.config.substream_bytes;
+
+    // Shared ring in a sealed memfd, so the client can neither shrink it
+    // under the daemon nor grow it
+    const size_t map_bytes = RING_DATA_OFFSET + capacity;
+    int ring_fd = ::memfd_create("lfsr-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    void* mapping = MAP_FAILED;
+    if (ring_fd >= 0 && ::ftruncate(ring_fd, static_cast<off_t>(map_bytes)) == 0) {
+        ::fcntl(ring_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+        mapping = ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring_fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        int error = errno;
+        if (ring_fd >= 0) {
+            ::close(ring_fd);
+        }
+        reject(error, std::string("Cannot create ring: ") + std::strerror(error));
+        return;
+    }
+    DaemonRingHeader* header = new (mapping) DaemonRingHeader();
+    header->magic = RING_MAGIC;
+    header->capacity = capacity;
+    uint8_t* data = static_cast<uint8_t*>(mapping) + RING_DATA_OFFSET;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        session.header = header;
+        finished.clients_served++;
+    }
+
+    Reply reply = errorReply(0, "");
+    reply.substream = substream;
+    reply.start_offset = start_offset;
+    reply.ring_bytes = capacity;
+    const bool sent = sendReply(session.fd, reply, ring_fd);
+    ::close(ring_fd);
+
+    // Refill thread: the only writer of the data and write_pos
+    const size_t step = std::min(options.fill_bytes, capacity);
+    std::thread refill([&, header, data, capacity, step]() {
+        LFSR generator = stream.prototype;
+        generator.jumpBytes(start_offset);
+        uint64_t position = 0;
+        while (!header->closed.load()) {
+            uint64_t room = capacity - (position - header->read_pos.load());
+            if (room < step) {
+                header->producer_stalls.fetch_add(1, std::memory_order_relaxed);
+                uint32_t seq = header->space_seq.load();
+                header->producer_waiting.store(1);
+                if (capacity - (position - header->read_pos.load()) < step && !header->closed.load()) {
+                    futexWait(header->space_seq, seq, nullptr);
+                }
+                header->producer_waiting.store(0);
+                continue;
+            }
+            const size_t at = static_cast<size_t>(position & (capacity - 1));
+            const size_t len = std::min(step, capacity - at);
+            generator.fill(data + at, len);
+            position += len;
+            header->write_pos.store(position);
+            publish(header->data_seq, header->consumer_waiting);
+        }
+    });
+
+    // Hold the ring until the client disconnects or the daemon stops;
+    // later messages on the connection are ignored
+    if (sent) {
+        char ignored[sizeof(Request)];
+        for (;;) {
+            ssize_t n = ::recv(session.fd, ignored, sizeof(ignored), 0);
+            if (n == 0 || (n < 0 && errno != EINTR)) {
+                break;
+            }
+        }
+    }
+    header->closed.store(1);
+    header->space_seq.fetch_add(1);
+    futexWake(header->space_seq);
+    header->data_seq.fetch_add(1);
+    futexWake(header->data_seq);
+    refill.join();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        addCounters(finished, *header);
+        session.header = nullptr;
+    }
+    header->~DaemonRingHeader();
+    ::munmap(mapping, map_bytes);
+    session.done = true;
+}
+
+DaemonStats GeneratorDaemon::getStats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    DaemonStats totals = finished;
+    totals.clients_active = 0;
+    for (const auto& session : sessions) {
+        if (session->header != nullptr) {
+            totals.clients_active++;
+            addCounters(totals, *session->header);
+        }
+    }
+    return totals;
+}
+
+GeneratorClient::GeneratorClient(const std::string& path, const std::string& stream,
+                                 uint64_t substream_number, size_t ring_bytes) {
+    if (stream.empty() || stream.size() >= STREAM_NAME_BYTES) {
+        throw std::invalid_argument("Stream name is empty or too long: " + stream);
+    }
+    socket_fd = connectTo(path);
+    if (socket_fd < 0) {
+        throw systemError("Cannot connect to generator daemon at " + path, errno);
+    }
+    Request request;
+    std::memset(&request, 0, sizeof(request));
+    request.magic = PROTOCOL_MAGIC;
+    request.command = COMMAND_OPEN;
+    request.substream = substream_number;
+    request.ring_bytes = ring_bytes;
+    std::memcpy(request.stream, stream.c_str(), stream.size());
+
+    int ring_fd = -1;
+    try {
+        Reply reply = exchange(socket_fd, request, &ring_fd);
+        if (ring_fd < 0) {
+            throw std::runtime_error("Generator daemon sent no ring");
+        }
+        map_bytes = RING_DATA_OFFSET + reply.ring_bytes;
+        void* mapping = ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring_fd, 0);
+        int error = errno;
+        ::close(ring_fd);
+        ring_fd = -1;
+        if (mapping == MAP_FAILED) {
+            throw systemError("Cannot map ring", error);
+        }
+        header = static_cast<DaemonRingHeader*>(mapping);
+        data = static_cast<uint8_t*>(mapping) + RING_DATA_OFFSET;
+        if (header->magic != RING_MAGIC || header->capacity != reply.ring_bytes) {
+            ::munmap(mapping, map_bytes);
+            header = nullptr;
+            throw std::runtime_error("Generator daemon sent a malformed ring");
+        }
+        substream = reply.substream;
+        start_offset = reply.start_offset;
+    } catch (...) {
+        if (ring_fd >= 0) {
+            ::close(ring_fd);
+        }
+        ::close(socket_fd);
+        throw;
+    }
+}
+
+GeneratorClient::~GeneratorClient() {
+    ::munmap(header, map_bytes);
+    ::close(socket_fd);
+}
+
+size_t GeneratorClient::read(void* out, size_t len) {
+    uint8_t* dest = static_cast<uint8_t*>(out);
+    const uint64_t capacity = header->capacity;
+    uint64_t position = header->read_pos.load(std::memory_order_relaxed);
+    size_t done = 0;
+    while (done < len) {
+        uint64_t available = header->write_pos.load() - position;
+        if (available == 0) {
+            if (header->closed.load()) {
+                break;
+            }
+            header->consumer_waits.fetch_add(1, std::memory_order_relaxed);
+            uint32_t seq = header->data_seq.load();
+            header->consumer_waiting.store(1);
+            if (header->write_pos.load() == position && !header->closed.load()) {
+                // Wake up now and then to notice a daemon that died
+                // without closing the ring
+                timespec timeout{0, CONSUMER_WAIT_NS};
+                futexWait(header->data_seq, seq, &timeout);
+                pollfd watched{socket_fd, POLLRDHUP, 0};
+                if (::poll(&watched, 1, 0) > 0 && (watched.revents & (POLLRDHUP | POLLHUP | POLLERR))) {
+                    header->closed.store(1);
+                }
+            }
+            header->consumer_waiting.store(0);
+            continue;
+        }
+        const size_t at = static_cast<size_t>(position & (capacity - 1));
+        const size_t n = static_cast<size_t>(std::min<uint64_t>({available, len - done, capacity - at}));
+        std::memcpy(dest + done, data + at, n);
+        done += n;
+        position += n;
+        header->read_pos.store(position);
+        publish(header->space_seq, header->producer_waiting);
+    }
+    return done;
+}
+
+size_t GeneratorClient::getRingBytes() const {
+    return static_cast<size_t>(header->capacity);
+}
+
+ClientCounters GeneratorClient::getCounters() const {
+    return ClientCounters{header->write_pos.load(), header->read_pos.load(),
+                          header->producer_stalls.load(), header->consumer_waits.load()};
+}
+
+DaemonStats queryDaemonStats(const std::string& path) {
+    int fd = connectTo(path);
+    if (fd < 0) {
+        throw systemError("Cannot connect to generator daemon at " + path, errno);
+    }
+    Request request;
+    std::memset(&request, 0, sizeof(request));
+    request.magic = PROTOCOL_MAGIC;
+    request.command = COMMAND_STATS;
+    try {
+        Reply reply = exchange(fd, request, nullptr);
+        ::close(fd);
+        return reply.stats;
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
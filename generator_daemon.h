@@ -0,0 +1,234 @@
+#ifndef GENERATOR_DAEMON_H
+#define GENERATOR_DAEMON_H
+
+#include "lfsr.h"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Substream number asking the daemon for the next unused one
+ */
+constexpr uint64_t DAEMON_NEXT_SUBSTREAM = ~0ULL;
+
+// Layout of a shared ring, defined in generator_daemon.cpp
+struct DaemonRingHeader;
+
+/**
+ * @struct DaemonStreamConfig
+ * @brief A named stream served by GeneratorDaemon
+ */
+struct DaemonStreamConfig {
+    std::string name;                      // Name clients ask for (up to 63 characters)
+    uint8_t register_size = 64;            // Register size (2-64 bits)
+    uint64_t polynomial = 0;               // Feedback mask (0 means maximal-length polynomial)
+    uint64_t seed = 0;                     // Initial state (0 means use default)
+    uint64_t substream_bytes = 1ULL << 40; // Bytes between the starts of consecutive substreams
+};
+
+/**
+ * @struct DaemonOptions
+ * @brief Ring sizing and refill granularity of GeneratorDaemon
+ */
+struct DaemonOptions {
+    size_t default_ring_bytes = 4 << 20;   // Ring size when the client does not ask for one
+    size_t max_ring_bytes = 256 << 20;     // Largest ring a client may ask for
+    size_t fill_bytes = 64 << 10;          // Bytes generated and published per refill step
+};
+
+/**
+ * @struct ClientCounters
+ * @brief Traffic through one client's ring, kept in the shared mapping
+ */
+struct ClientCounters {
+    uint64_t bytes_generated;   // Bytes the daemon has put into the ring
+    uint64_t bytes_consumed;    // Bytes the client has taken out
+    uint64_t producer_stalls;   // Times the daemon found the ring full (backpressure)
+    uint64_t consumer_waits;    // Times the client found the ring empty
+};
+
+/**
+ * @struct DaemonStats
+ * @brief Totals over all clients of a daemon
+ */
+struct DaemonStats {
+    uint64_t clients_served;     // Streams opened since start
+    uint64_t clients_active;     // Streams open now
+    uint64_t requests_rejected;  // Malformed requests, unknown streams, bad ring sizes
+    uint64_t bytes_generated;    // Bytes put into rings
+    uint64_t bytes_consumed;     // Bytes taken out of rings
+    uint64_t producer_stalls;    // Refills deferred by full rings
+    uint64_t consumer_waits;     // Reads that found a ring empty
+};
+
+/**
+ * @class GeneratorDaemon
+ * @brief Serves named LFSR streams to local processes
+ *
+ * Clients connect to a UNIX-domain SOCK_SEQPACKET socket and open a named
+ * stream, optionally choosing a substream. The daemon answers with a
+ * memfd holding a single-producer, single-consumer byte ring, which the
+ * client maps; from then on data flows through shared memory only. One
+ * refill thread per client keeps the ring full with LFSR::fill() and
+ * blocks when it is full, so a slow client only holds back its own
+ * stream. Both sides sleep on futexes in the mapping instead of polling.
+ *
+ * Substream k of a stream starts k * substream_bytes bytes into the
+ * sequence, reached by jump-ahead, so every client gets an independent
+ * and reproducible slice. All substreams of a stream are copies of one
+ * register and share its block tables, which are built once at startup.
+ * The connection stays open for the life of the ring: closing it, or the
+ * client exiting, releases the ring and stops its refill thread.
+ */
+class GeneratorDaemon {
+private:
+    struct Session;
+    struct Stream {
+        DaemonStreamConfig config;
+        LFSR prototype;              // Register at byte 0 of substream 0
+        uint64_t next_substream;     // Next substream handed out on request
+    };
+
+    std::string socket_path;
+    DaemonOptions options;
+    std::map<std::string, std::unique_ptr<Stream>> streams;
+    int listen_fd = -1;
+    int wake_pipe[2] = {-1, -1};      // stop() writes here to end run()
+
+    mutable std::mutex lock;          // Guards streams' substreams, sessions and totals
+    std::list<std::unique_ptr<Session>> sessions;
+    DaemonStats finished;             // Totals of closed sessions
+
+    void serveSession(Session& session);
+    void reapSessions(bool all);
+
+public:
+    /**
+     * @brief Constructor: bind the socket and build the stream registers
+     * @param path Filesystem path of the control socket
+     * @param configs Streams to serve, with unique names
+     * @param daemon_options Ring sizes and refill granularity
+     * @throw std::invalid_argument if a stream or the options are invalid
+     * @throw std::runtime_error if the socket cannot be bound, another
+     *        daemon already answers on it, or path exists and is not a socket
+     *
+     * A stale socket file left by a daemon that exited is replaced; any
+     * other file at path is left alone.
+     */
+    GeneratorDaemon(const std::string& path, const std::vector<DaemonStreamConfig>& configs,
+                    const DaemonOptions& daemon_options = DaemonOptions());
+
+    GeneratorDaemon(const GeneratorDaemon&) = delete;
+    GeneratorDaemon& operator=(const GeneratorDaemon&) = delete;
+
+    /**
+     * @brief Destructor: disconnect clients and remove the socket file
+     */
+    ~GeneratorDaemon();
+
+    /**
+     * @brief Accept and serve clients until stop() is called
+     *
+     * On return every client has been disconnected; clients blocked in
+     * read() see the end of their stream.
+     */
+    void run();
+
+    /**
+     * @brief Make run() return
+     *
+     * Safe to call from another thread or from a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Get totals over all clients, past and present
+     * @return Counters, with live rings read at the time of the call
+     */
+    DaemonStats getStats() const;
+};
+
+/**
+ * @class GeneratorClient
+ * @brief One substream of a GeneratorDaemon stream, read from shared memory
+ */
+class GeneratorClient {
+private:
+    int socket_fd = -1;
+    DaemonRingHeader* header = nullptr;
+    uint8_t* data = nullptr;
+    size_t map_bytes = 0;
+    uint64_t substream = 0;
+    uint64_t start_offset = 0;
+
+public:
+    /**
+     * @brief Constructor: connect and open a stream
+     * @param path Control socket of the daemon
+     * @param stream Name of the stream
+     * @param substream_number Substream to read, or DAEMON_NEXT_SUBSTREAM
+     * @param ring_bytes Ring size (0 means the daemon's default); rounded
+     *        up to a power of two
+     * @throw std::runtime_error if the daemon cannot be reached or refuses
+     */
+    GeneratorClient(const std::string& path, const std::string& stream,
+                    uint64_t substream_number = DAEMON_NEXT_SUBSTREAM, size_t ring_bytes = 0);
+
+    GeneratorClient(const GeneratorClient&) = delete;
+    GeneratorClient& operator=(const GeneratorClient&) = delete;
+
+    /**
+     * @brief Destructor: release the ring and disconnect
+     */
+    ~GeneratorClient();
+
+    /**
+     * @brief Copy the next bytes of the substream
+     * @param out Destination buffer
+     * @param len Number of bytes
+     * @return len, or fewer if the daemon went away first
+     *
+     * Blocks while the ring is empty. The bytes are those of LFSR::fill()
+     * on the stream's register jumped to getStartOffset().
+     */
+    size_t read(void* out, size_t len);
+
+    /**
+     * @brief Get the substream being read
+     * @return Substream number, as assigned by the daemon if not chosen
+     */
+    uint64_t getSubstream() const { return substream; }
+
+    /**
+     * @brief Get where the substream starts in the stream
+     * @return Byte offset of the first byte read
+     */
+    uint64_t getStartOffset() const { return start_offset; }
+
+    /**
+     * @brief Get the ring size
+     * @return Bytes of generated data the ring can hold
+     */
+    size_t getRingBytes() const;
+
+    /**
+     * @brief Get traffic counters of this client's ring
+     * @return Counters as seen by both sides
+     */
+    ClientCounters getCounters() const;
+};
+
+/**
+ * @brief Ask a running daemon for its totals
+ * @param path Control socket of the daemon
+ * @return Totals over all clients
+ * @throw std::runtime_error if the daemon cannot be reached
+ */
+DaemonStats queryDaemonStats(const std::string& path);
+
+#endif // GENERATOR_DAEMON_H
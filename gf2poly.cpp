@@ -0,0 +1,141 @@
+#include "gf2poly.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Prime powers q^e dividing n, by trial division; a cofactor left after
+// dividing out everything up to 2^18 is prime if it is below 2^36
+std::vector<std::pair<uint64_t, int>> factorOrder(uint64_t n) {
+    std::vector<std::pair<uint64_t, int>> factors;
+    for (uint64_t d = 2; d < (1ULL << 18) && d * d <= n; d += (d == 2) ? 1 : 2) {
+        int e = 0;
+        while (n % d == 0) {
+            n /= d;
+            e++;
+        }
+        if (e > 0) {
+            factors.emplace_back(d, e);
+        }
+    }
+    if (n > 1) {
+        if (n > (1ULL << 36)) {
+            throw std::domain_error("Group order has a prime factor too large for discrete logarithms");
+        }
+        factors.emplace_back(n, 1);
+    }
+    return factors;
+}
+
+// Exponent k < q with generator^k = target, generator of prime order q
+uint64_t babyStepGiantStep(uint64_t generator, uint64_t target, uint64_t q,
+                           uint64_t polynomial, int degree) {
+    const uint64_t m = static_cast<uint64_t>(std::ceil(std::sqrt(static_cast<double>(q))));
+    std::vector<std::pair<uint64_t, uint64_t>> baby;
+    baby.reserve(m);
+    uint64_t power = 1;
+    for (uint64_t j = 0; j < m; j++) {
+        baby.emplace_back(power, j);
+        power = gf2MulMod(power, generator, polynomial, degree);
+    }
+    std::sort(baby.begin(), baby.end());
+
+    // Giant steps multiply by generator^-m = generator^(q - m mod q)
+    const uint64_t stride = gf2PowMod(generator, (q - m % q) % q, polynomial, degree);
+    uint64_t gamma = target;
+    for (uint64_t i = 0; i <= m; i++) {
+        auto hit = std::lower_bound(baby.begin(), baby.end(), std::make_pair(gamma, uint64_t(0)));
+        if (hit != baby.end() && hit->first == gamma) {
+            return (i * m + hit->second) % q;
+        }
+        gamma = gf2MulMod(gamma, stride, polynomial, degree);
+    }
+    throw std::domain_error("No discrete logarithm; the polynomial is not primitive");
+}
+
+// Inverse of a modulo m, for coprime a and m
+uint64_t inverseMod(uint64_t a, uint64_t m) {
+    __int128 t = 0, new_t = 1;
+    __int128 r = m, new_r = a % m;
+    while (new_r != 0) {
+        __int128 quotient = r / new_r;
+        std::swap(t, new_t);
+        new_t -= quotient * t;
+        std::swap(r, new_r);
+        new_r -= quotient * r;
+    }
+    return static_cast<uint64_t>(t < 0 ? t + m : t);
+}
+
+} // namespace
+
+uint64_t gf2MulMod(uint64_t a, uint64_t b, uint64_t polynomial, int degree) {
+    // Horner's scheme over the bits of b, highest first
+    uint64_t result = 0;
+    for (int i = degree - 1; i >= 0; i--) {
+        result = gf2MulX(result, polynomial, degree);
+        if ((b >> i) & 1) {
+            result ^= a;
+        }
+    }
+    return result;
+}
+
+uint64_t gf2PowX(uint64_t exponent, uint64_t polynomial, int degree) {
+    uint64_t result = 1;
+    uint64_t base = gf2MulX(1, polynomial, degree);
+    for (; exponent != 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = gf2MulMod(result, base, polynomial, degree);
+        }
+        base = gf2MulMod(base, base, polynomial, degree);
+    }
+    return result;
+}
+
+uint64_t gf2PowMod(uint64_t base, uint64_t exponent, uint64_t polynomial, int degree) {
+    uint64_t result = 1;
+    for (; exponent != 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = gf2MulMod(result, base, polynomial, degree);
+        }
+        base = gf2MulMod(base, base, polynomial, degree);
+    }
+    return result;
+}
+
+uint64_t gf2LogX(uint64_t value, uint64_t polynomial, int degree) {
+    if (value == 0) {
+        throw std::invalid_argument("Zero has no discrete logarithm");
+    }
+    const uint64_t order = degree >= 64 ? ~0ULL : (1ULL << degree) - 1;
+    const uint64_t x = gf2MulX(1, polynomial, degree);
+    unsigned __int128 result = 0, modulus = 1;
+
+    for (const auto& factor : factorOrder(order)) {
+        const uint64_t q = factor.first;
+        // Digits of the exponent in base q, from the lowest
+        const uint64_t generator = gf2PowMod(x, order / q, polynomial, degree);
+        uint64_t prime_power = 1, residue = 0;
+        for (int k = 0; k < factor.second; k++) {
+            const uint64_t reduced = gf2MulMod(value, gf2PowX(order - residue, polynomial, degree),
+                                               polynomial, degree);
+            const uint64_t target = gf2PowMod(reduced, order / (prime_power * q), polynomial, degree);
+            residue += babyStepGiantStep(generator, target, q, polynomial, degree) * prime_power;
+            prime_power *= q;
+        }
+
+        // Chinese remainder step: result stays the solution modulo modulus
+        const uint64_t mod = static_cast<uint64_t>(modulus);
+        const uint64_t difference = static_cast<uint64_t>(
+            (residue + prime_power - static_cast<uint64_t>(result % prime_power)) % prime_power);
+        const uint64_t step = static_cast<uint64_t>(
+            static_cast<unsigned __int128>(difference) * inverseMod(mod % prime_power, prime_power) % prime_power);
+        result += static_cast<unsigned __int128>(step) * modulus;
+        modulus *= prime_power;
+    }
+    return static_cast<uint64_t>(result % order);
+}
@@ -0,0 +1,68 @@
+#ifndef GF2POLY_H
+#define GF2POLY_H
+
+#include <cstdint>
+
+/**
+ * @file gf2poly.h
+ * @brief Arithmetic on binary polynomials modulo P(x) of degree 1-64
+ * 
+ * Polynomials are bit masks with bit i holding the x^i coefficient.
+ * P(x) is given by its degree and the mask of its terms below x^degree,
+ * the same convention as LFSR feedback masks and CRC polynomials.
+ * Operands must already be reduced (degree below P's degree).
+ */
+
+/**
+ * @brief Multiply by x modulo P(x)
+ * @param value Reduced polynomial
+ * @param polynomial Terms of P below x^degree
+ * @param degree Degree of P (1-64)
+ * @return value * x mod P(x)
+ */
+inline uint64_t gf2MulX(uint64_t value, uint64_t polynomial, int degree) {
+    uint64_t mask = degree >= 64 ? ~0ULL : (1ULL << degree) - 1;
+    bool carry = (value >> (degree - 1)) & 1;
+    value = (value << 1) & mask;
+    return carry ? (value ^ polynomial) : value;
+}
+
+/**
+ * @brief Multiply two polynomials modulo P(x)
+ * @return a * b mod P(x)
+ */
+uint64_t gf2MulMod(uint64_t a, uint64_t b, uint64_t polynomial, int degree);
+
+/**
+ * @brief Raise x to a power modulo P(x)
+ * @param exponent Power of x
+ * @return x^exponent mod P(x)
+ * 
+ * Square-and-multiply, so the cost grows with log(exponent).
+ */
+uint64_t gf2PowX(uint64_t exponent, uint64_t polynomial, int degree);
+
+/**
+ * @brief Raise a polynomial to a power modulo P(x)
+ * @param base Reduced polynomial
+ * @param exponent Power
+ * @return base^exponent mod P(x)
+ */
+uint64_t gf2PowMod(uint64_t base, uint64_t exponent, uint64_t polynomial, int degree);
+
+/**
+ * @brief Discrete logarithm to base x modulo a primitive P(x)
+ * @param value Non-zero reduced polynomial
+ * @return k in [0, 2^degree - 1) with x^k mod P(x) = value
+ * @throw std::invalid_argument if value is zero
+ * @throw std::domain_error if 2^degree - 1 has a prime factor above 2^36
+ * 
+ * Pohlig-Hellman: the exponent is found modulo each prime power dividing
+ * 2^degree - 1 with baby-step giant-step in the subgroup of that order,
+ * then combined by the Chinese remainder theorem. The cost is dominated
+ * by the square root of the largest prime factor, about 2600 products for
+ * degree 64. The result is meaningless if P(x) is not primitive.
+ */
+uint64_t gf2LogX(uint64_t value, uint64_t polynomial, int degree);
+
+#endif // GF2POLY_H
@@ -1,29 +1,137 @@
 #include "lfsr.h"
+#include "gf2poly.h"
 #include <iostream>
-#include <bitset>
 #include <algorithm>
 #include <sstream>
+#include <cstring>
+
+namespace {
+
+// Longest period that selfTest() and a full generateSequence() step
+// through one bit at a time (a 24-bit register)
+constexpr uint64_t MAX_WALKED_PERIOD = (1ULL << 24) - 1;
+
+// State of makeDefaultSource() when no seed is given
+constexpr uint64_t DEFAULT_SOURCE_SEED = 0x9E3779B97F4A7C15ULL;
+
+// Store a block with its first bit in bit 0 of the first byte
+inline void storeLE64(uint8_t* out, uint64_t value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    std::memcpy(out, &value, sizeof(value));
+}
+
+// Block kernel over TABLES byte tables stored back to back
+template <int TABLES>
+uint64_t runBlockKernel(const uint64_t* table, int shift, uint64_t state,
+                        uint64_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t block = 0;
+        for (int j = 0; j < TABLES; j++) {
+            block ^= table[256 * j + ((state >> (8 * j)) & 0xFF)];
+        }
+        state = block >> shift;
+        out[i] = block;
+    }
+    return state;
+}
+
+// Word-parallel kernel for a 64-bit register whose taps all lie in the low
+// half: output bit i is the XOR of state bits i + k over the taps k. Terms
+// past the end of the state are low bits of the same block, which are
+// final after the first pass, so all corrections come from one value.
+template <int TAPS>
+uint64_t runShiftKernel(const int* taps, uint64_t state, uint64_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t block = state;
+        for (int j = 0; j < TAPS; j++) {
+            block ^= state >> taps[j];
+        }
+        uint64_t correction = 0;
+        for (int j = 0; j < TAPS; j++) {
+            correction ^= block << (64 - taps[j]);
+        }
+        state = block ^ correction;
+        out[i] = state;
+    }
+    return state;
+}
+
+} // namespace
 
 // Primitive polynomials for maximum period (2^n - 1)
-// Format: polynomial coefficients as bit mask (excluding x^n term)
-const std::vector<uint16_t> LFSR::PRIMITIVE_POLYNOMIALS = {
-    0x0000,  // n=0 (unused)
-    0x0000,  // n=1 (unused)
-    0x0000,  // n=2 (unused)
-    0x0003,  // n=3: x^3 + x^1 + 1
-    0x0009,  // n=4: x^4 + x^1 + 1
-    0x0012,  // n=5: x^5 + x^2 + 1
-    0x0021,  // n=6: x^6 + x^1 + 1
-    0x0041,  // n=7: x^7 + x^1 + 1
-    0x008E,  // n=8: x^8 + x^4 + x^3 + x^2 + 1
-    0x0108,  // n=9: x^9 + x^4 + 1
-    0x0204,  // n=10: x^10 + x^3 + 1
-    0x0402,  // n=11: x^11 + x^2 + 1
-    0x0829,  // n=12: x^12 + x^6 + x^4 + x^1 + 1
-    0x100D,  // n=13: x^13 + x^4 + x^3 + x^1 + 1
-    0x2015,  // n=14: x^14 + x^5 + x^3 + x^1 + 1
-    0x4001,  // n=15: x^15 + x^1 + 1
-    0x8016   // n=16: x^16 + x^5 + x^3 + x^2 + 1
+// Format: polynomial coefficients as bit mask (excluding x^n term),
+// bit i for x^i. Sizes 3-16 are the defaults of LFSR(size); size 64 is
+// the register used by ErrorChannel. Each has order 2^n - 1, checked
+// against the prime factors of 2^n - 1, and at most five terms so the
+// feedback stays cheap.
+const uint64_t LFSR::PRIMITIVE_POLYNOMIALS[65] = {
+    0x0ULL,           // n=0 (unused)
+    0x0ULL,           // n=1 (unused)
+    0x3ULL,           // n=2: x^2 + x + 1
+    0x3ULL,           // n=3: x^3 + x + 1
+    0x9ULL,           // n=4: x^4 + x^3 + 1
+    0x5ULL,           // n=5: x^5 + x^2 + 1
+    0x21ULL,          // n=6: x^6 + x^5 + 1
+    0x41ULL,          // n=7: x^7 + x^6 + 1
+    0x1DULL,          // n=8: x^8 + x^4 + x^3 + x^2 + 1
+    0x11ULL,          // n=9: x^9 + x^4 + 1
+    0x9ULL,           // n=10: x^10 + x^3 + 1
+    0x5ULL,           // n=11: x^11 + x^2 + 1
+    0x53ULL,          // n=12: x^12 + x^6 + x^4 + x + 1
+    0x1BULL,          // n=13: x^13 + x^4 + x^3 + x + 1
+    0x2015ULL,        // n=14: x^14 + x^13 + x^4 + x^2 + 1
+    0x4001ULL,        // n=15: x^15 + x^14 + 1
+    0x2DULL,          // n=16: x^16 + x^5 + x^3 + x^2 + 1
+    0x9ULL,           // n=17: x^17 + x^3 + 1
+    0x81ULL,          // n=18: x^18 + x^7 + 1
+    0x27ULL,          // n=19: x^19 + x^5 + x^2 + x + 1
+    0x9ULL,           // n=20: x^20 + x^3 + 1
+    0x5ULL,           // n=21: x^21 + x^2 + 1
+    0x3ULL,           // n=22: x^22 + x + 1
+    0x21ULL,          // n=23: x^23 + x^5 + 1
+    0x87ULL,          // n=24: x^24 + x^7 + x^2 + x + 1
+    0x9ULL,           // n=25: x^25 + x^3 + 1
+    0x47ULL,          // n=26: x^26 + x^6 + x^2 + x + 1
+    0x27ULL,          // n=27: x^27 + x^5 + x^2 + x + 1
+    0x9ULL,           // n=28: x^28 + x^3 + 1
+    0x5ULL,           // n=29: x^29 + x^2 + 1
+    0x800007ULL,      // n=30: x^30 + x^23 + x^2 + x + 1
+    0x9ULL,           // n=31: x^31 + x^3 + 1
+    0x400007ULL,      // n=32: x^32 + x^22 + x^2 + x + 1
+    0x2001ULL,        // n=33: x^33 + x^13 + 1
+    0x8000007ULL,     // n=34: x^34 + x^27 + x^2 + x + 1
+    0x5ULL,           // n=35: x^35 + x^2 + 1
+    0x801ULL,         // n=36: x^36 + x^11 + 1
+    0x207ULL,         // n=37: x^37 + x^9 + x^2 + x + 1
+    0x200BULL,        // n=38: x^38 + x^13 + x^3 + x + 1
+    0x11ULL,          // n=39: x^39 + x^4 + 1
+    0x800000007ULL,   // n=40: x^40 + x^35 + x^2 + x + 1
+    0x9ULL,           // n=41: x^41 + x^3 + 1
+    0x20000007ULL,    // n=42: x^42 + x^29 + x^2 + x + 1
+    0x1007ULL,        // n=43: x^43 + x^12 + x^2 + x + 1
+    0x400000000BULL,  // n=44: x^44 + x^38 + x^3 + x + 1
+    0x1BULL,          // n=45: x^45 + x^4 + x^3 + x + 1
+    0x20BULL,         // n=46: x^46 + x^9 + x^3 + x + 1
+    0x21ULL,          // n=47: x^47 + x^5 + 1
+    0x1000000BULL,    // n=48: x^48 + x^28 + x^3 + x + 1
+    0x201ULL,         // n=49: x^49 + x^9 + 1
+    0x10007ULL,       // n=50: x^50 + x^16 + x^2 + x + 1
+    0x10000007ULL,    // n=51: x^51 + x^28 + x^2 + x + 1
+    0x9ULL,           // n=52: x^52 + x^3 + 1
+    0x47ULL,          // n=53: x^53 + x^6 + x^2 + x + 1
+    0x20007ULL,       // n=54: x^54 + x^17 + x^2 + x + 1
+    0x1000001ULL,     // n=55: x^55 + x^24 + 1
+    0x40000000007ULL, // n=56: x^56 + x^42 + x^2 + x + 1
+    0x81ULL,          // n=57: x^57 + x^7 + 1
+    0x80001ULL,       // n=58: x^58 + x^19 + 1
+    0x1000007ULL,     // n=59: x^59 + x^24 + x^2 + x + 1
+    0x3ULL,           // n=60: x^60 + x + 1
+    0x27ULL,          // n=61: x^61 + x^5 + x^2 + x + 1
+    0x1000000BULL,    // n=62: x^62 + x^28 + x^3 + x + 1
+    0x3ULL,           // n=63: x^63 + x + 1
+    0x1BULL           // n=64: x^64 + x^4 + x^3 + x + 1
 };
 
 LFSR::LFSR(uint8_t size, uint16_t initial_seed) 
@@ -35,16 +143,35 @@ LFSR::LFSR(uint8_t size, uint16_t initial_seed)
     polynomial_mask = PRIMITIVE_POLYNOMIALS[size];
     
     // Calculate maximum period
-    max_period = (1U << size) - 1;
+    max_period = stateMask();
+    
+    applySeed(initial_seed);
+    buildBlockTable();
+}
+
+LFSR::LFSR(uint8_t size, uint64_t polynomial, uint64_t initial_seed)
+    : polynomial_mask(polynomial), register_size(size), period_counter(0) {
+    
+    if (size < 2 || size > 64) {
+        throw std::invalid_argument("Register size must be between 2 and 64 bits");
+    }
+    if ((polynomial & 1) == 0 || (polynomial & ~stateMask()) != 0) {
+        throw std::invalid_argument("Polynomial must have a constant term and degree below register size");
+    }
+    
+    max_period = stateMask();
     
-    // Set initial state
-    if (initial_seed == 0) {
+    applySeed(initial_seed);
+    buildBlockTable();
+}
+
+void LFSR::applySeed(uint64_t seed) {
+    if (seed == 0) {
         // Use a default non-zero seed
         register_state = 1;
     } else {
         // Ensure seed is within valid range for register size
-        uint16_t mask = (1U << size) - 1;
-        register_state = initial_seed & mask;
+        register_state = seed & stateMask();
         if (register_state == 0) {
             register_state = 1; // Avoid all-zero state
         }
@@ -60,7 +187,7 @@ void LFSR::validateSize(uint8_t size) const {
 bool LFSR::calculateNextBit() {
     // Calculate feedback bit using XOR of taps specified by polynomial
     bool feedback = false;
-    uint16_t temp = register_state & polynomial_mask;
+    uint64_t temp = register_state & polynomial_mask;
     
     // Count number of set bits (XOR of all taps)
     while (temp) {
@@ -69,7 +196,7 @@ bool LFSR::calculateNextBit() {
     }
     
     // Shift register right and insert feedback bit at MSB
-    register_state = (register_state >> 1) | (feedback ? (1U << (register_size - 1)) : 0);
+    register_state = (register_state >> 1) | (feedback ? (1ULL << (register_size - 1)) : 0);
     
     // Increment period counter
     period_counter++;
@@ -97,34 +224,171 @@ uint16_t LFSR::nextWord() {
     return result;
 }
 
-void LFSR::setState(uint16_t new_state) {
+void LFSR::buildBlockTable() {
+    // The next 64 output bits are a linear function of the state, so the
+    // response to each single state bit is enough to build every entry.
+    std::vector<uint64_t> basis(register_size);
+    for (int b = 0; b < register_size; b++) {
+        uint64_t state = 1ULL << b;
+        uint64_t output = 0;
+        for (int i = 0; i < 64; i++) {
+            uint64_t feedback = __builtin_parityll(state & polynomial_mask);
+            state = (state >> 1) | (feedback << (register_size - 1));
+            output |= feedback << i;
+        }
+        basis[b] = output;
+    }
+    
+    auto table = std::make_shared<BlockTable>((register_size + 7) / 8);
+    for (size_t j = 0; j < table->size(); j++) {
+        for (int value = 0; value < 256; value++) {
+            uint64_t output = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                size_t index = j * 8 + bit;
+                if ((value & (1 << bit)) && index < basis.size()) {
+                    output ^= basis[index];
+                }
+            }
+            (*table)[j][value] = output;
+        }
+    }
+    
+    block_table = table;
+}
+
+uint64_t LFSR::nextBlock() {
+    const BlockTable& table = *block_table;
+    uint64_t state = register_state;
+    uint64_t output = 0;
+    for (const auto& entry : table) {
+        output ^= entry[state & 0xFF];
+        state >>= 8;
+    }
+    
+    // The register now holds the last register_size bits that were output
+    register_state = output >> (64 - register_size);
+    period_counter += 64;
+    return output;
+}
+
+void LFSR::fillBlocks(uint64_t* out, size_t count) {
+    const uint64_t* table = block_table->front().data();
+    const int shift = 64 - register_size;
+    uint64_t state = register_state;
+    
+    // Sparse 64-bit registers skip the tables
+    const int tap_count = __builtin_popcountll(polynomial_mask) - 1;
+    if (register_size == 64 && polynomial_mask < (1ULL << 33) && tap_count <= 4) {
+        int taps[4] = {0, 0, 0, 0};
+        uint64_t rest = polynomial_mask & ~1ULL;
+        for (int j = 0; j < tap_count; j++, rest &= rest - 1) {
+            taps[j] = __builtin_ctzll(rest);
+        }
+        switch (tap_count) {
+            case 0: state = runShiftKernel<0>(taps, state, out, count); break;
+            case 1: state = runShiftKernel<1>(taps, state, out, count); break;
+            case 2: state = runShiftKernel<2>(taps, state, out, count); break;
+            case 3: state = runShiftKernel<3>(taps, state, out, count); break;
+            default: state = runShiftKernel<4>(taps, state, out, count); break;
+        }
+        register_state = state;
+        period_counter += 64 * static_cast<uint64_t>(count);
+        return;
+    }
+    
+    // Unrolled per table count so the lookups issue back to back
+    switch (block_table->size()) {
+        case 1: state = runBlockKernel<1>(table, shift, state, out, count); break;
+        case 2: state = runBlockKernel<2>(table, shift, state, out, count); break;
+        case 3: state = runBlockKernel<3>(table, shift, state, out, count); break;
+        case 4: state = runBlockKernel<4>(table, shift, state, out, count); break;
+        case 5: state = runBlockKernel<5>(table, shift, state, out, count); break;
+        case 6: state = runBlockKernel<6>(table, shift, state, out, count); break;
+        case 7: state = runBlockKernel<7>(table, shift, state, out, count); break;
+        default: state = runBlockKernel<8>(table, shift, state, out, count); break;
+    }
+    
+    register_state = state;
+    period_counter += 64 * static_cast<uint64_t>(count);
+}
+
+void LFSR::fill(uint8_t* out, size_t len) {
+    uint64_t blocks[32];
+    size_t i = 0;
+    while (len - i >= 8) {
+        size_t count = std::min<size_t>((len - i) / 8, 32);
+        fillBlocks(blocks, count);
+        for (size_t k = 0; k < count; k++, i += 8) {
+            storeLE64(out + i, blocks[k]);
+        }
+    }
+    for (; i < len; i++) {
+        out[i] = nextByte();
+    }
+}
+
+void LFSR::jump(uint64_t steps) {
+    applyJump(jumpPolynomial(steps), steps);
+}
+
+void LFSR::jumpBytes(uint64_t bytes) {
+    // x^(8 * bytes) as (x^bytes)^8, so the bit count never overflows
+    uint64_t power = jumpPolynomial(bytes);
+    for (int i = 0; i < 3; i++) {
+        power = gf2MulMod(power, power, polynomial_mask, register_size);
+    }
+    applyJump(power, 8 * bytes);
+}
+
+uint64_t LFSR::jumpPolynomial(uint64_t steps) const {
+    return gf2PowX(steps, polynomial_mask, register_size);
+}
+
+void LFSR::applyJump(uint64_t power, uint64_t steps) {
+    // Sequence bit k positions ahead is the parity of the state under the
+    // mask x^k mod P(x); shifting the mask by x yields the following bits.
+    uint64_t next_state = 0;
+    for (int j = 0; j < register_size; j++) {
+        next_state |= static_cast<uint64_t>(__builtin_parityll(power & register_state)) << j;
+        power = gf2MulX(power, polynomial_mask, register_size);
+    }
+    
+    register_state = next_state;
+    period_counter += steps;
+}
+
+uint64_t LFSR::maximalPolynomial(uint8_t size) {
+    if (size < 2 || size > 64) {
+        throw std::invalid_argument("Register size must be between 2 and 64 bits");
+    }
+    return PRIMITIVE_POLYNOMIALS[size];
+}
+
+LFSR LFSR::makeDefaultSource(uint64_t seed) {
+    return LFSR(64, PRIMITIVE_POLYNOMIALS[64], seed ? seed : DEFAULT_SOURCE_SEED);
+}
+
+void LFSR::setState(uint64_t new_state) {
     if (new_state == 0) {
         throw std::invalid_argument("State cannot be zero (all-zero state is invalid)");
     }
     
-    uint16_t mask = (1U << register_size) - 1;
-    register_state = new_state & mask;
+    register_state = new_state & stateMask();
     period_counter = 0;
 }
 
-void LFSR::reset(uint16_t new_seed) {
-    if (new_seed == 0) {
-        register_state = 1; // Default non-zero state
-    } else {
-        uint16_t mask = (1U << register_size) - 1;
-        register_state = new_seed & mask;
-        if (register_state == 0) {
-            register_state = 1;
-        }
-    }
+void LFSR::reset(uint64_t new_seed) {
+    applySeed(new_seed);
     period_counter = 0;
 }
 
 std::string LFSR::getStateString() const {
-    std::bitset<16> bits(register_state);
-    std::string result = bits.to_string();
-    // Show only relevant bits
-    return result.substr(16 - register_size);
+    // Highest stage first, written straight into the result
+    std::string result(register_size, '0');
+    for (int i = 0; i < register_size; i++) {
+        result[register_size - 1 - i] = static_cast<char>('0' + ((register_state >> i) & 1));
+    }
+    return result;
 }
 
 std::string LFSR::getPolynomialString() const {
@@ -133,7 +397,7 @@ std::string LFSR::getPolynomialString() const {
     
     // Add lower degree terms
     for (int i = register_size - 1; i >= 0; i--) {
-        if (polynomial_mask & (1U << i)) {
+        if (polynomial_mask & (1ULL << i)) {
             if (i == 0) {
                 oss << " + 1";
             } else if (i == 1) {
@@ -148,12 +412,15 @@ std::string LFSR::getPolynomialString() const {
 }
 
 std::vector<bool> LFSR::generateSequence(uint32_t max_bits) {
+    if (max_bits == 0 && max_period > MAX_WALKED_PERIOD) {
+        throw std::invalid_argument("Full period too long to generate; pass max_bits");
+    }
     std::vector<bool> sequence;
-    uint32_t limit = (max_bits == 0) ? max_period : std::min(max_bits, max_period);
+    uint64_t limit = (max_bits == 0) ? max_period : std::min<uint64_t>(max_bits, max_period);
     
     sequence.reserve(limit);
     
-    for (uint32_t i = 0; i < limit; i++) {
+    for (uint64_t i = 0; i < limit; i++) {
         sequence.push_back(nextBit());
     }
     
@@ -161,9 +428,13 @@ std::vector<bool> LFSR::generateSequence(uint32_t max_bits) {
 }
 
 bool LFSR::selfTest() {
+    if (max_period > MAX_WALKED_PERIOD) {
+        throw std::invalid_argument("Register too large to walk its period");
+    }
+    
     // Test 1: Check that we don't get stuck in all-zero state
-    uint16_t original_state = register_state;
-    uint32_t original_counter = period_counter;
+    uint64_t original_state = register_state;
+    uint64_t original_counter = period_counter;
     
     // Generate a few bits and check state is not zero
     for (int i = 0; i < 10; i++) {
@@ -177,15 +448,15 @@ bool LFSR::selfTest() {
     
     // Test 2: Check period completion
     reset(original_state);
-    uint16_t start_state = register_state;
-    uint32_t bits_generated = 0;
+    uint64_t start_state = register_state;
+    uint64_t bits_generated = 0;
     
     do {
         nextBit();
         bits_generated++;
         
-        // Safety check to prevent infinite loop
-        if (bits_generated > max_period + 100) {
+        // No cycle is longer than max_period, so stop once past it
+        if (bits_generated > max_period) {
             register_state = original_state;
             period_counter = original_counter;
             return false;
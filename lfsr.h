@@ -2,7 +2,10 @@
 #define LFSR_H
 
 #include <vector>
+#include <array>
+#include <memory>
 #include <string>
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 
@@ -12,19 +15,26 @@
  * 
  * LFSR generates pseudorandom sequences using linear feedback.
  * Supports register sizes from 3 to 16 bits with primitive polynomials
- * for maximum period (2^n - 1).
+ * for maximum period (2^n - 1), or any register size from 2 to 64 bits
+ * with a caller-supplied feedback polynomial.
  */
 class LFSR {
 private:
-    uint16_t register_state;     // Current state of the shift register
-    uint16_t polynomial_mask;    // Mask for feedback polynomial
-    uint8_t register_size;       // Size of the register (3-16 bits)
-    uint32_t period_counter;     // Counter to track period
-    uint32_t max_period;         // Maximum possible period (2^n - 1)
+    uint64_t register_state;     // Current state of the shift register
+    uint64_t polynomial_mask;    // Mask for feedback polynomial
+    uint8_t register_size;       // Size of the register (2-64 bits)
+    uint64_t period_counter;     // Counter to track period
+    uint64_t max_period;         // Maximum possible period (2^n - 1)
     
     // Primitive polynomials for different register sizes
     // These ensure maximum period of 2^n - 1
-    static const std::vector<uint16_t> PRIMITIVE_POLYNOMIALS;
+    static const uint64_t PRIMITIVE_POLYNOMIALS[65];
+    
+    // Lookup tables for the 64-bit block kernel: entry [j][v] is the
+    // contribution of state byte j with value v to the next 64 output bits.
+    // Built once per polynomial and shared between copies of the register.
+    using BlockTable = std::vector<std::array<uint64_t, 256>>;
+    std::shared_ptr<const BlockTable> block_table;
     
     /**
      * @brief Calculate the next bit using XOR feedback
@@ -38,6 +48,25 @@ private:
      * @throw std::invalid_argument if size is not in range [3, 16]
      */
     void validateSize(uint8_t size) const;
+    
+    /**
+     * @brief Set the initial state from a seed
+     * @param seed Seed value (0 means use default)
+     */
+    void applySeed(uint64_t seed);
+    
+    /**
+     * @brief Get mask covering all register bits
+     * @return 2^n - 1
+     */
+    uint64_t stateMask() const {
+        return register_size >= 64 ? ~0ULL : (1ULL << register_size) - 1;
+    }
+    
+    /**
+     * @brief Build the block kernel tables for the current polynomial
+     */
+    void buildBlockTable();
 
 public:
     /**
@@ -48,6 +77,16 @@ public:
      */
     explicit LFSR(uint8_t size, uint16_t initial_seed = 0);
     
+    /**
+     * @brief Constructor with a custom feedback polynomial
+     * @param size Register size (2-64 bits)
+     * @param polynomial Feedback mask: bit i set for each x^i term of
+     *        P(x) = x^size + ... + 1 below x^size (bit 0 must be set)
+     * @param initial_seed Initial state (0 means use default)
+     * @throw std::invalid_argument if size or polynomial is invalid
+     */
+    LFSR(uint8_t size, uint64_t polynomial, uint64_t initial_seed);
+    
     /**
      * @brief Generate next bit in the sequence
      * @return Next pseudorandom bit
@@ -66,18 +105,80 @@ public:
      */
     uint16_t nextWord();
     
+    /**
+     * @brief Generate the next 64 bits of the sequence
+     * @return Next 64 bits, the first generated bit in the LSB
+     *
+     * Same bit order as nextByte()/nextWord(), computed with byte-indexed
+     * lookup tables instead of 64 single-bit steps.
+     */
+    uint64_t nextBlock();
+    
+    /**
+     * @brief Generate consecutive 64-bit blocks
+     * @param out Destination array
+     * @param count Number of blocks
+     *
+     * Produces exactly the values of count consecutive nextBlock() calls.
+     */
+    void fillBlocks(uint64_t* out, size_t count);
+    
+    /**
+     * @brief Fill a buffer with pseudorandom bytes
+     * @param out Destination buffer
+     * @param len Number of bytes to generate
+     *
+     * Produces exactly the bytes of len consecutive nextByte() calls.
+     */
+    void fill(uint8_t* out, size_t len);
+    
+    /**
+     * @brief Advance the register as if steps bits had been generated
+     * @param steps Number of bits to skip
+     *
+     * Computes x^steps mod P(x), so the cost grows with log(steps).
+     */
+    void jump(uint64_t steps);
+    
+    /**
+     * @brief Advance the register as if bytes bytes had been generated
+     * @param bytes Number of bytes to skip, the offset of fill() output
+     *
+     * Unlike jump(8 * bytes), exact for offsets of 2^61 bytes and more.
+     */
+    void jumpBytes(uint64_t bytes);
+    
+    /**
+     * @brief Get the jump polynomial for a fixed distance
+     * @param steps Number of bits to skip
+     * @return x^steps mod P(x), for applyJump()
+     *
+     * Lets a distance used many times, such as a substream spacing, be
+     * raised to its power once.
+     */
+    uint64_t jumpPolynomial(uint64_t steps) const;
+    
+    /**
+     * @brief Advance the register by a precomputed jump
+     * @param power jumpPolynomial(steps) from a register with the same polynomial
+     * @param steps Distance the polynomial was computed for
+     *
+     * Costs one parity per register bit, independent of steps.
+     */
+    void applyJump(uint64_t power, uint64_t steps);
+    
     /**
      * @brief Get current register state
-     * @return Current state as 16-bit value
+     * @return Current state, bit 0 is the oldest sequence bit
      */
-    uint16_t getState() const { return register_state; }
+    uint64_t getState() const { return register_state; }
     
     /**
      * @brief Set new register state
      * @param new_state New state (must be non-zero)
      * @throw std::invalid_argument if state is zero
      */
-    void setState(uint16_t new_state);
+    void setState(uint64_t new_state);
     
     /**
      * @brief Get register size
@@ -89,13 +190,38 @@ public:
      * @brief Get current period counter
      * @return Number of bits generated since last reset
      */
-    uint32_t getPeriodCounter() const { return period_counter; }
+    uint64_t getPeriodCounter() const { return period_counter; }
     
     /**
      * @brief Get maximum possible period
      * @return Maximum period (2^n - 1)
      */
-    uint32_t getMaxPeriod() const { return max_period; }
+    uint64_t getMaxPeriod() const { return max_period; }
+    
+    /**
+     * @brief Get feedback polynomial mask
+     * @return Coefficients of P(x) below x^n, bit i for x^i
+     */
+    uint64_t getPolynomial() const { return polynomial_mask; }
+    
+    /**
+     * @brief Get a maximal-length feedback polynomial for any register size
+     * @param size Register size (2-64 bits)
+     * @return Mask of a primitive polynomial of degree size, in the format
+     *         of getPolynomial(); the default polynomial for sizes 3-16
+     * @throw std::invalid_argument if size is not in range [2, 64]
+     */
+    static uint64_t maximalPolynomial(uint8_t size);
+    
+    /**
+     * @brief Get the 64-bit register behind the library's seeded streams
+     * @param seed Initial state (0 means the fixed default seed)
+     * @return Register with polynomial maximalPolynomial(64)
+     *
+     * ErrorChannel, VariateGenerator, MemoryTester and StoragePattern all
+     * draw from this register, so the same seed gives the same stream.
+     */
+    static LFSR makeDefaultSource(uint64_t seed = 0);
     
     /**
      * @brief Check if sequence has completed one full period
@@ -107,7 +233,7 @@ public:
      * @brief Reset the generator to initial state
      * @param new_seed New seed value (0 means use current state)
      */
-    void reset(uint16_t new_seed = 0);
+    void reset(uint64_t new_seed = 0);
     
     /**
      * @brief Get string representation of current state
@@ -123,14 +249,18 @@ public:
     
     /**
      * @brief Generate sequence and check for repetition
-     * @param max_bits Maximum number of bits to generate
+     * @param max_bits Maximum number of bits to generate (0 means one full period)
      * @return Vector of generated bits
+     * @throw std::invalid_argument if max_bits is 0 and the register is
+     *        larger than 24 bits
      */
     std::vector<bool> generateSequence(uint32_t max_bits = 0);
     
     /**
      * @brief Test the generator for proper operation
      * @return true if test passes
+     * @throw std::invalid_argument if the register is larger than 24 bits,
+     *        whose period is too long to step through bit by bit
      */
     bool selfTest();
 };
@@ -1,4 +1,5 @@
 #include "lfsr.h"
+#include "text_format.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -6,6 +7,36 @@
 #include <random>
 #include <bitset>
 
+/**
+ * @brief Format bits as '0'/'1' text
+ * @param bits Bits in sequence order
+ * @return Text for a single stream insertion
+ */
+std::string bitText(const std::vector<bool>& bits) {
+    std::vector<uint8_t> packed((bits.size() + 7) / 8, 0);
+    for (size_t i = 0; i < bits.size(); i++) {
+        packed[i / 8] |= static_cast<uint8_t>(bits[i]) << (i % 8);
+    }
+    std::string text(bits.size(), '0');
+    TextFormatter().formatBits(packed.data(), bits.size(), &text[0]);
+    return text;
+}
+
+/**
+ * @brief Format bits as '0'/'1' text with a space after every four
+ * @param bits Bits in sequence order
+ * @return Text for a single stream insertion
+ */
+std::string groupedBits(const std::vector<bool>& bits) {
+    const std::string text = bitText(bits);
+    std::string grouped;
+    for (size_t i = 0; i < text.size(); i += 4) {
+        grouped.append(text, i, 4);
+        if (i + 4 <= text.size()) grouped += ' ';
+    }
+    return grouped;
+}
+
 /**
  * @brief Demonstrate LFSR functionality with different register sizes
  */
@@ -34,12 +65,11 @@ void demonstrateLFSR() {
             std::cout << "Max period: " << lfsr.getMaxPeriod() << " bits\n";
             
             // Generate first 20 bits
-            std::cout << "First 20 bits: ";
-            for (int i = 0; i < 20; i++) {
-                std::cout << (lfsr.nextBit() ? '1' : '0');
-                if ((i + 1) % 4 == 0) std::cout << " ";
+            std::vector<bool> first(20);
+            for (size_t i = 0; i < first.size(); i++) {
+                first[i] = lfsr.nextBit();
             }
-            std::cout << "\n";
+            std::cout << "First 20 bits: " << groupedBits(first) << "\n";
             
             // Test period completion
             std::cout << "Testing period completion...\n";
@@ -109,11 +139,7 @@ void demonstrateSequenceAnalysis() {
     // Generate full sequence
     std::vector<bool> sequence = lfsr.generateSequence();
     
-    std::cout << "Full sequence (" << sequence.size() << " bits): ";
-    for (bool bit : sequence) {
-        std::cout << (bit ? '1' : '0');
-    }
-    std::cout << "\n\n";
+    std::cout << "Full sequence (" << sequence.size() << " bits): " << bitText(sequence) << "\n\n";
     
     // Analyze bit distribution
     int ones = 0, zeros = 0;
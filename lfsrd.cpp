@@ -0,0 +1,151 @@
+#include "generator_daemon.h"
+#include "cli_util.h"
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <getopt.h>
+
+namespace {
+
+GeneratorDaemon* active_daemon = nullptr;
+
+void handleTermination(int) {
+    if (active_daemon != nullptr) {
+        active_daemon->stop();
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Print command-line usage
+ * @param program Name the program was started as
+ */
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Serve LFSR streams to local processes through shared-memory rings.\n\n"
+              << "  -S, --socket PATH          Control socket (default: /tmp/lfsrd.sock)\n"
+              << "  -s, --stream SPEC          Serve NAME[:BITS[:HEX_POLYNOMIAL[:SEED]]]; repeatable\n"
+              << "                             (default: one stream \"default\", 64 bits, maximal polynomial)\n"
+              << "  -d, --substream-bytes N    Bytes between substream starts (K, M, G, T suffixes; default: 1T)\n"
+              << "  -b, --ring-bytes N         Default ring size per client (default: 4M)\n"
+              << "  -m, --max-ring-bytes N     Largest ring a client may ask for (default: 256M)\n"
+              << "      --stats                Print the totals of a running daemon and exit\n"
+              << "  -h, --help                 Show this help message\n";
+}
+
+/**
+ * @brief Parse a stream specification
+ * @param spec NAME[:BITS[:HEX_POLYNOMIAL[:SEED]]]
+ * @return Stream configuration, substream spacing left at its default
+ * @throw std::invalid_argument if a field is invalid
+ */
+DaemonStreamConfig parseStream(const std::string& spec) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t colon = spec.find(':', start);
+        fields.push_back(spec.substr(start, colon - start));
+        if (colon == std::string::npos) {
+            break;
+        }
+        start = colon + 1;
+    }
+    if (fields.size() > 4 || fields[0].empty()) {
+        throw std::invalid_argument("Invalid stream specification: " + spec);
+    }
+    DaemonStreamConfig config;
+    config.name = fields[0];
+    if (fields.size() > 1) {
+        uint64_t bits = parseSize(fields[1], "--stream");
+        if (bits < 2 || bits > 64) {
+            throw std::invalid_argument("Register size must be between 2 and 64 bits");
+        }
+        config.register_size = static_cast<uint8_t>(bits);
+    }
+    if (fields.size() > 2 && !fields[2].empty()) {
+        config.polynomial = std::stoull(fields[2], nullptr, 16);
+    }
+    if (fields.size() > 3) {
+        config.seed = parseSize(fields[3], "--stream");
+    }
+    return config;
+}
+
+int main(int argc, char* argv[]) {
+    enum { OPT_STATS = 256 };
+    static const option long_options[] = {
+        {"socket", required_argument, nullptr, 'S'},
+        {"stream", required_argument, nullptr, 's'},
+        {"substream-bytes", required_argument, nullptr, 'd'},
+        {"ring-bytes", required_argument, nullptr, 'b'},
+        {"max-ring-bytes", required_argument, nullptr, 'm'},
+        {"stats", no_argument, nullptr, OPT_STATS},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    std::string socket_path = "/tmp/lfsrd.sock";
+    std::vector<DaemonStreamConfig> streams;
+    uint64_t substream_bytes = 0;
+    bool stats = false;
+    DaemonOptions options;
+
+    try {
+        int opt;
+        while ((opt = getopt_long(argc, argv, "S:s:d:b:m:h", long_options, nullptr)) != -1) {
+            switch (opt) {
+                case 'S': socket_path = optarg; break;
+                case 's': streams.push_back(parseStream(optarg)); break;
+                case 'd': substream_bytes = parseSize(optarg, "--substream-bytes"); break;
+                case 'b': options.default_ring_bytes = parseSize(optarg, "--ring-bytes"); break;
+                case 'm': options.max_ring_bytes = parseSize(optarg, "--max-ring-bytes"); break;
+                case OPT_STATS: stats = true; break;
+                case 'h': printUsage(argv[0]); return 0;
+                default: printUsage(argv[0]); return 2;
+            }
+        }
+        if (optind != argc) {
+            printUsage(argv[0]);
+            return 2;
+        }
+
+        if (stats) {
+            DaemonStats totals = queryDaemonStats(socket_path);
+            std::cout << "Clients served:    " << totals.clients_served << "\n"
+                      << "Clients active:    " << totals.clients_active << "\n"
+                      << "Requests rejected: " << totals.requests_rejected << "\n"
+                      << "Bytes generated:   " << totals.bytes_generated << "\n"
+                      << "Bytes consumed:    " << totals.bytes_consumed << "\n"
+                      << "Producer stalls:   " << totals.producer_stalls << "\n"
+                      << "Consumer waits:    " << totals.consumer_waits << "\n";
+            return 0;
+        }
+
+        if (streams.empty()) {
+            DaemonStreamConfig config;
+            config.name = "default";
+            streams.push_back(config);
+        }
+        if (substream_bytes != 0) {
+            for (auto& config : streams) {
+                config.substream_bytes = substream_bytes;
+            }
+        }
+
+        GeneratorDaemon daemon(socket_path, streams, options);
+        active_daemon = &daemon;
+        std::signal(SIGINT, handleTermination);
+        std::signal(SIGTERM, handleTermination);
+        std::signal(SIGPIPE, SIG_IGN);
+        std::cerr << "Serving " << streams.size() << " stream(s) on " << socket_path << "\n";
+        daemon.run();
+        active_daemon = nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "lfsr.h"
+#include "stream_output.h"
+#include "text_format.h"
+#include "cli_util.h"
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include <unistd.h>
+
+/**
+ * @brief Print command-line usage
+ * @param program Name the program was started as
+ */
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Write the byte stream of an LFSR to standard output.\n\n"
+              << "  -n, --bytes N         Bytes to write (K, M, G, T suffixes; default: until the reader exits)\n"
+              << "  -r, --register BITS   Register size, 2-64 (default: 64)\n"
+              << "  -p, --polynomial HEX  Feedback mask below x^BITS (default: maximal-length polynomial)\n"
+              << "  -s, --seed N          Initial state (default: 1)\n"
+              << "  -o, --offset N        Bytes of the sequence to skip (K, M, G, T suffixes)\n"
+              << "  -t, --threads N       Generator threads (default: one per hardware thread)\n"
+              << "      --no-splice       Always use write(), never vmsplice()\n"
+              << "  -f, --format FORMAT   raw (default), binary ('0'/'1' per bit), hex or base64\n"
+              << "  -w, --line-chars N    Characters per line of text output (default: none)\n"
+              << "  -v, --verbose         Report bytes written and whether vmsplice or write was used on stderr\n"
+              << "  -h, --help            Show this help message\n";
+}
+
+/**
+ * @brief Parse an output format name
+ * @param name raw, binary, hex or base64
+ * @param encoding Receives the text encoding for the text formats
+ * @return true for a text format, false for raw bytes
+ * @throw std::invalid_argument if the name is unknown
+ */
+bool parseFormat(const std::string& name, TextEncoding& encoding) {
+    if (name == "raw") return false;
+    if (name == "binary") { encoding = TextEncoding::Binary; return true; }
+    if (name == "hex") { encoding = TextEncoding::Hex; return true; }
+    if (name == "base64") { encoding = TextEncoding::Base64; return true; }
+    throw std::invalid_argument("Unknown format: " + name);
+}
+
+/**
+ * @brief Write the byte stream of a register to standard output as text
+ * @param generator Register at the start of the sequence
+ * @param offset Bytes of the sequence to skip first
+ * @param bytes Bytes to encode, or STREAM_UNLIMITED
+ * @param text_options Encoding and line length
+ * @return Bytes encoded and whether the reader closed
+ */
+StreamResult writeText(const LFSR& generator, uint64_t offset, uint64_t bytes,
+                       const TextWriterOptions& text_options) {
+    StreamResult result{0, false, false};
+    LFSR stream = generator;
+    stream.jumpBytes(offset);
+    TextWriter writer(STDOUT_FILENO, text_options);
+    std::vector<uint8_t> chunk(1 << 16);
+    while (result.bytes_written < bytes && !writer.isReaderClosed()) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(chunk.size(), bytes - result.bytes_written));
+        stream.fill(chunk.data(), n);
+        writer.write(chunk.data(), 8 * static_cast<uint64_t>(n));
+        result.bytes_written += n;
+    }
+    writer.finish();
+    result.reader_closed = writer.isReaderClosed();
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    enum { OPT_NO_SPLICE = 256 };
+    static const option long_options[] = {
+        {"bytes", required_argument, nullptr, 'n'},
+        {"register", required_argument, nullptr, 'r'},
+        {"polynomial", required_argument, nullptr, 'p'},
+        {"seed", required_argument, nullptr, 's'},
+        {"offset", required_argument, nullptr, 'o'},
+        {"threads", required_argument, nullptr, 't'},
+        {"no-splice", no_argument, nullptr, OPT_NO_SPLICE},
+        {"format", required_argument, nullptr, 'f'},
+        {"line-chars", required_argument, nullptr, 'w'},
+        {"verbose", no_argument, nullptr, 'v'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    uint64_t bytes = STREAM_UNLIMITED;
+    uint64_t register_size = 64;
+    uint64_t polynomial = 0;
+    uint64_t seed = 0;
+    uint64_t offset = 0;
+    bool verbose = false;
+    bool text = false;
+    StreamOptions options;
+    TextWriterOptions text_options;
+
+    try {
+        int opt;
+        while ((opt = getopt_long(argc, argv, "n:r:p:s:o:t:f:w:vh", long_options, nullptr)) != -1) {
+            switch (opt) {
+                case 'n': bytes = parseSize(optarg, "--bytes"); break;
+                case 'r': register_size = parseSize(optarg, "--register"); break;
+                case 'p': polynomial = std::stoull(optarg, nullptr, 16); break;
+                case 's': seed = parseSize(optarg, "--seed"); break;
+                case 'o': offset = parseSize(optarg, "--offset"); break;
+                case 't': options.threads = static_cast<unsigned>(parseSize(optarg, "--threads")); break;
+                case OPT_NO_SPLICE: options.use_vmsplice = false; break;
+                case 'f': text = parseFormat(optarg, text_options.encoding); break;
+                case 'w': text_options.line_chars = static_cast<size_t>(parseSize(optarg, "--line-chars")); break;
+                case 'v': verbose = true; break;
+                case 'h': printUsage(argv[0]); return 0;
+                default: printUsage(argv[0]); return 2;
+            }
+        }
+        if (optind != argc) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        if (register_size < 2 || register_size > 64) {
+            throw std::invalid_argument("Register size must be between 2 and 64 bits");
+        }
+        if (polynomial == 0) {
+            polynomial = LFSR::maximalPolynomial(static_cast<uint8_t>(register_size));
+        }
+        if (!text && isatty(STDOUT_FILENO)) {
+            std::cerr << "Refusing to write binary data to a terminal; redirect the output\n";
+            return 2;
+        }
+
+        // A closed reader ends the stream normally, so report it as EPIPE
+        std::signal(SIGPIPE, SIG_IGN);
+
+        LFSR generator(static_cast<uint8_t>(register_size), polynomial, seed);
+        StreamResult result = text ? writeText(generator, offset, bytes, text_options)
+                                   : streamSequence(STDOUT_FILENO, generator, offset, bytes, options);
+        if (verbose) {
+            std::cerr << result.bytes_written << " bytes written"
+                      << (result.used_vmsplice ? " with vmsplice" : " with write")
+                      << (result.reader_closed ? ", reader closed" : "") << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
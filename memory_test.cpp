@@ -0,0 +1,192 @@
+#include "memory_test.h"
+#include "permutation.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MEMORY_TEST_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Fixed split of the permutation; threads share out these parts
+constexpr uint64_t PATTERN_PARTS = 64;
+
+// Stream blocks reserved for each part
+constexpr uint64_t SUBSTREAM_BLOCKS = 1ULL << 40;
+
+// First index in [from, count) where the words differ, or count
+size_t findMismatch(const uint64_t* expected, const uint64_t* actual, size_t from, size_t count) {
+    for (size_t i = from; i < count; i++) {
+        if (expected[i] != actual[i]) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef MEMORY_TEST_HAVE_AVX2
+
+__attribute__((target("avx2")))
+size_t findMismatchAVX2(const uint64_t* expected, const uint64_t* actual, size_t from, size_t count) {
+    size_t i = from;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i* e = reinterpret_cast<const __m256i*>(expected + i);
+        const __m256i* a = reinterpret_cast<const __m256i*>(actual + i);
+        __m256i diff = _mm256_or_si256(
+            _mm256_xor_si256(_mm256_loadu_si256(e), _mm256_loadu_si256(a)),
+            _mm256_xor_si256(_mm256_loadu_si256(e + 1), _mm256_loadu_si256(a + 1)));
+        if (!_mm256_testz_si256(diff, diff)) {
+            break;
+        }
+    }
+    return findMismatch(expected, actual, i, count);
+}
+
+#endif // MEMORY_TEST_HAVE_AVX2
+
+void validateRegion(const void* region, size_t bytes) {
+    if (bytes % 8 != 0 || reinterpret_cast<uintptr_t>(region) % 8 != 0) {
+        throw std::invalid_argument("Test region must be 8-byte aligned and a multiple of 8 bytes");
+    }
+}
+
+} // namespace
+
+MemoryTester::MemoryTester(uint64_t pattern_seed, size_t chunk_bytes, unsigned thread_count)
+    : source(LFSR::makeDefaultSource(pattern_seed)),
+      seed(pattern_seed), chunk_words(chunk_bytes / 8), threads(thread_count),
+      max_failures(1024), use_avx2(false) {
+
+    if (chunk_bytes == 0 || chunk_bytes % 8 != 0) {
+        throw std::invalid_argument("Chunk size must be a non-zero multiple of 8 bytes");
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+#ifdef MEMORY_TEST_HAVE_AVX2
+    use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+MemoryTestResult MemoryTester::sweep(uint64_t* region, size_t words, Sweep mode, bool inverted) const {
+    MemoryTestResult total{0, 0, {}};
+    if (words == 0) {
+        return total;
+    }
+    const uint64_t chunks = (words + chunk_words - 1) / chunk_words;
+    const PermutationIterator order(chunks, seed);
+    const uint64_t mask = inverted ? ~0ULL : 0;
+    const size_t workers_used = std::min<size_t>(threads, PATTERN_PARTS);
+    std::vector<MemoryTestResult> results(workers_used, MemoryTestResult{0, 0, {}});
+
+    auto worker = [&](size_t index) {
+        MemoryTestResult& result = results[index];
+        std::vector<uint64_t> expected(chunk_words);
+        for (uint64_t part = index; part < PATTERN_PARTS; part += workers_used) {
+            PermutationIterator piece = order.partition(part, PATTERN_PARTS);
+            LFSR stream = source;
+            uint64_t block = part * SUBSTREAM_BLOCKS;
+            stream.jump(64 * block);
+
+            uint64_t chunk;
+            while (piece.next(chunk)) {
+                const size_t start = chunk * chunk_words;
+                const size_t count = std::min(chunk_words, words - start);
+                uint64_t* memory = region + start;
+
+                if (mode == Sweep::Write) {
+                    stream.fillBlocks(memory, count);
+                    for (size_t i = 0; i < count; i++) {
+                        memory[i] ^= mask;
+                    }
+                    block += count;
+                    continue;
+                }
+
+                stream.fillBlocks(expected.data(), count);
+                for (size_t i = 0; i < count; i++) {
+                    expected[i] ^= mask;
+                }
+#ifdef MEMORY_TEST_HAVE_AVX2
+                auto mismatch = use_avx2 ? findMismatchAVX2 : findMismatch;
+#else
+                auto mismatch = findMismatch;
+#endif
+                for (size_t i = mismatch(expected.data(), memory, 0, count); i < count;
+                     i = mismatch(expected.data(), memory, i + 1, count)) {
+                    result.error_count++;
+                    if (result.failures.size() < max_failures) {
+                        result.failures.push_back({(start + i) * 8, expected[i], memory[i],
+                                                   block + i, inverted});
+                    }
+                }
+                result.words_checked += count;
+
+                if (mode == Sweep::VerifyAndInvert) {
+                    for (size_t i = 0; i < count; i++) {
+                        memory[i] = ~expected[i];
+                    }
+                }
+                block += count;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(workers_used - 1);
+    for (size_t i = 1; i < workers_used; i++) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    for (const auto& result : results) {
+        total.words_checked += result.words_checked;
+        total.error_count += result.error_count;
+        total.failures.insert(total.failures.end(), result.failures.begin(), result.failures.end());
+    }
+    std::sort(total.failures.begin(), total.failures.end(),
+              [](const MemoryFailure& a, const MemoryFailure& b) { return a.offset < b.offset; });
+    if (total.failures.size() > max_failures) {
+        total.failures.resize(max_failures);
+    }
+    return total;
+}
+
+void MemoryTester::write(void* region, size_t bytes, bool inverted) const {
+    validateRegion(region, bytes);
+    sweep(static_cast<uint64_t*>(region), bytes / 8, Sweep::Write, inverted);
+}
+
+MemoryTestResult MemoryTester::verify(const void* region, size_t bytes, bool inverted) const {
+    validateRegion(region, bytes);
+    // A verify-only sweep never writes through the pointer
+    return sweep(static_cast<uint64_t*>(const_cast<void*>(region)), bytes / 8, Sweep::Verify, inverted);
+}
+
+MemoryTestResult MemoryTester::run(void* region, size_t bytes) const {
+    validateRegion(region, bytes);
+    uint64_t* words = static_cast<uint64_t*>(region);
+    sweep(words, bytes / 8, Sweep::Write, false);
+    MemoryTestResult result = sweep(words, bytes / 8, Sweep::VerifyAndInvert, false);
+    MemoryTestResult second = sweep(words, bytes / 8, Sweep::Verify, true);
+
+    result.words_checked += second.words_checked;
+    result.error_count += second.error_count;
+    result.failures.insert(result.failures.end(), second.failures.begin(), second.failures.end());
+    if (result.failures.size() > max_failures) {
+        result.failures.resize(max_failures);
+    }
+    return result;
+}
+
+uint64_t MemoryTester::expectedWord(uint64_t stream_block, bool inverted) const {
+    LFSR stream = source;
+    stream.jump(64 * stream_block);
+    const uint64_t word = stream.nextBlock();
+    return inverted ? ~word : word;
+}
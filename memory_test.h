@@ -0,0 +1,136 @@
+#ifndef MEMORY_TEST_H
+#define MEMORY_TEST_H
+
+#include "lfsr.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct MemoryFailure
+ * @brief One 64-bit word that did not read back as written
+ */
+struct MemoryFailure {
+    uint64_t offset;        // Byte offset of the word in the region
+    uint64_t expected;      // Pattern word
+    uint64_t actual;        // Word read back
+    uint64_t stream_block;  // Block of the pattern stream it was written from
+    bool inverted;          // Whether the complemented pattern was expected
+};
+
+/**
+ * @struct MemoryTestResult
+ * @brief Outcome of one or more verification passes
+ */
+struct MemoryTestResult {
+    uint64_t words_checked;               // Words compared
+    uint64_t error_count;                 // Mismatching words, all of them
+    std::vector<MemoryFailure> failures;  // Up to the failure limit, by offset
+};
+
+/**
+ * @class MemoryTester
+ * @brief Pseudorandom-data memory test in scrambled address order
+ *
+ * The region is cut into chunks that are visited in the order of a
+ * PermutationIterator, so consecutive accesses land far apart and defeat
+ * prefetchers and open DRAM rows the way a linear sweep cannot. Chunk data
+ * comes straight from the register's block kernel, one 64-bit stream
+ * block per word, and is compared with AVX2 (scalar fallback).
+ *
+ * The permutation is split into a fixed number of parts; part p writes
+ * its chunks, in visit order, from the stream jumped p * 2^40 blocks
+ * ahead. The parts are spread over the worker threads, so the pattern
+ * depends only on the seed and chunk size, not on the thread count.
+ * Every failure records the stream block of its word, from which
+ * expectedWord() recomputes the pattern by jump-ahead alone.
+ *
+ * run() performs the march sequence w(P); r(P) w(~P); r(~P): each pass
+ * reads every chunk against the pattern before writing its complement,
+ * catching stuck-at bits of either polarity and address faults.
+ */
+class MemoryTester {
+private:
+    LFSR source;         // Pattern stream of part 0
+    uint64_t seed;       // Selects the address order
+    size_t chunk_words;  // 64-bit words per chunk
+    unsigned threads;    // Worker threads
+    size_t max_failures; // Failures recorded per pass
+    bool use_avx2;       // AVX2 compare is available
+
+    enum class Sweep { Write, Verify, VerifyAndInvert };
+
+    /**
+     * @brief Run one pass over the region
+     * @param region Region as 64-bit words
+     * @param words Region length in words
+     * @param mode What to do with each chunk
+     * @param inverted Whether the complemented pattern is written or expected
+     * @return Verification result (empty for writes)
+     */
+    MemoryTestResult sweep(uint64_t* region, size_t words, Sweep mode, bool inverted) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param pattern_seed Seed of the pattern register and address order
+     *        (0 means use default)
+     * @param chunk_bytes Bytes per scrambled chunk, a multiple of 8
+     * @param thread_count Worker threads (0 means one per hardware thread)
+     * @throw std::invalid_argument if chunk_bytes is invalid
+     *
+     * The pattern register is x^64 + x^4 + x^3 + x + 1, as in ErrorChannel.
+     */
+    explicit MemoryTester(uint64_t pattern_seed = 0, size_t chunk_bytes = 4096,
+                          unsigned thread_count = 0);
+
+    /**
+     * @brief Write the pattern
+     * @param region Memory to test, 8-byte aligned
+     * @param bytes Region length, a multiple of 8
+     * @param inverted Write the complemented pattern
+     * @throw std::invalid_argument if the region is misaligned
+     */
+    void write(void* region, size_t bytes, bool inverted = false) const;
+
+    /**
+     * @brief Compare the region with the pattern
+     * @param region Memory to test, 8-byte aligned
+     * @param bytes Region length, a multiple of 8
+     * @param inverted Expect the complemented pattern
+     * @return Words checked, error count and the first failures
+     * @throw std::invalid_argument if the region is misaligned
+     */
+    MemoryTestResult verify(const void* region, size_t bytes, bool inverted = false) const;
+
+    /**
+     * @brief Run the full march test
+     * @param region Memory to test, 8-byte aligned; overwritten
+     * @param bytes Region length, a multiple of 8
+     * @return Combined result of both read passes
+     * @throw std::invalid_argument if the region is misaligned
+     */
+    MemoryTestResult run(void* region, size_t bytes) const;
+
+    /**
+     * @brief Recompute a pattern word by jump-ahead
+     * @param stream_block Stream block recorded in a failure
+     * @param inverted Whether the complemented pattern is wanted
+     * @return The word that was written from that block
+     */
+    uint64_t expectedWord(uint64_t stream_block, bool inverted = false) const;
+
+    /**
+     * @brief Set how many failures a pass records
+     * @param limit Maximum failures kept (all are still counted)
+     */
+    void setMaxFailures(size_t limit) { max_failures = limit; }
+
+    /**
+     * @brief Get chunk size
+     * @return Bytes per scrambled chunk
+     */
+    size_t getChunkBytes() const { return chunk_words * 8; }
+};
+
+#endif // MEMORY_TEST_H
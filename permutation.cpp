@@ -0,0 +1,68 @@
+#include "permutation.h"
+#include <stdexcept>
+
+namespace {
+
+// Smallest maximal-length register whose cycle covers [0, n), placed at
+// the cycle position selected by the seed
+LFSR makeRegister(uint64_t n, uint64_t seed) {
+    if (n == 0) {
+        throw std::invalid_argument("Permutation range must be non-zero");
+    }
+    uint8_t size = 2;
+    while (size < 64 && (1ULL << size) - 1 < n) {
+        size++;
+    }
+    const uint64_t period = size >= 64 ? ~0ULL : (1ULL << size) - 1;
+    return LFSR(size, LFSR::maximalPolynomial(size), seed % period + 1);
+}
+
+} // namespace
+
+PermutationIterator::PermutationIterator(uint64_t n, uint64_t seed)
+    : generator(makeRegister(n, seed)), range(n),
+      remaining(generator.getMaxPeriod()) {
+}
+
+void PermutationIterator::skipPositions(uint64_t positions) {
+    // One position is one 64-bit block; reduce the bit count modulo the
+    // period so it fits the jump argument for any register size
+    const uint64_t period = generator.getMaxPeriod();
+    const unsigned __int128 steps = static_cast<unsigned __int128>(positions) * 64;
+    generator.jump(static_cast<uint64_t>(steps % period));
+}
+
+bool PermutationIterator::next(uint64_t& value) {
+    while (remaining > 0) {
+        const uint64_t candidate = generator.getState() - 1;
+        generator.nextBlock();
+        remaining--;
+        if (candidate < range) {
+            value = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t PermutationIterator::fill(uint64_t* out, size_t count) {
+    size_t written = 0;
+    while (written < count && next(out[written])) {
+        written++;
+    }
+    return written;
+}
+
+PermutationIterator PermutationIterator::partition(uint64_t part, uint64_t parts) const {
+    if (parts == 0 || part >= parts) {
+        throw std::invalid_argument("Part index must be below a non-zero part count");
+    }
+    const unsigned __int128 total = remaining;
+    const uint64_t begin = static_cast<uint64_t>(total * part / parts);
+    const uint64_t end = static_cast<uint64_t>(total * (part + 1) / parts);
+
+    PermutationIterator piece(*this);
+    piece.skipPositions(begin);
+    piece.remaining = end - begin;
+    return piece;
+}
@@ -0,0 +1,94 @@
+#ifndef PERMUTATION_H
+#define PERMUTATION_H
+
+#include "lfsr.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class PermutationIterator
+ * @brief Visit every integer in [0, N) exactly once in pseudorandom order
+ *
+ * A maximal-length register of n bits steps through all 2^n - 1 non-zero
+ * states before repeating, so state - 1 enumerates [0, 2^n - 1) without
+ * storing anything. The iterator uses the smallest n with 2^n - 1 >= N
+ * and skips states whose value is N or more (cycle-walking); as
+ * 2^n - 1 < 2N, fewer than one state is skipped per value on average.
+ *
+ * Consecutive values are 64 sequence bits apart, one block-kernel step,
+ * so every value is made of fresh bits rather than the previous value
+ * shifted by one. Since 64 is coprime to 2^n - 1 this still walks a single
+ * cycle through all states.
+ *
+ * An iterator owns a run of consecutive cycle positions, initially the
+ * whole cycle starting at the seed. partition() splits the run into
+ * contiguous pieces reached by jump-ahead, so workers can scan disjoint
+ * parts of the same permutation whose union is all of [0, N).
+ */
+class PermutationIterator {
+private:
+    LFSR generator;        // Register holding the next position's state
+    uint64_t range;        // Values are 0 .. range - 1
+    uint64_t remaining;    // Cycle positions left in this iterator's run
+
+    /**
+     * @brief Skip cycle positions
+     * @param positions Positions to skip, fewer than the cycle length
+     */
+    void skipPositions(uint64_t positions);
+
+public:
+    /**
+     * @brief Constructor
+     * @param n Number of values to permute
+     * @param seed Start position on the cycle; seeds equal modulo
+     *        2^bits - 1 give the same order
+     * @throw std::invalid_argument if n is zero
+     */
+    explicit PermutationIterator(uint64_t n, uint64_t seed = 0);
+
+    /**
+     * @brief Get the next value
+     * @param value Receives the value if there is one
+     * @return false once the run is exhausted
+     */
+    bool next(uint64_t& value);
+
+    /**
+     * @brief Get several values
+     * @param out Destination array
+     * @param count Maximum number of values
+     * @return Values written, less than count only at the end of the run
+     */
+    size_t fill(uint64_t* out, size_t count);
+
+    /**
+     * @brief Get one part of the remaining run
+     * @param part Part index, 0 .. parts - 1
+     * @param parts Number of parts
+     * @return Iterator over part's share of the cycle positions still to
+     *         be visited by this iterator; the parts cover them exactly once
+     * @throw std::invalid_argument if parts is zero or part >= parts
+     */
+    PermutationIterator partition(uint64_t part, uint64_t parts) const;
+
+    /**
+     * @brief Get number of values permuted
+     * @return N
+     */
+    uint64_t getRange() const { return range; }
+
+    /**
+     * @brief Get register size
+     * @return Bits of the register walking the cycle
+     */
+    uint8_t getRegisterSize() const { return generator.getSize(); }
+
+    /**
+     * @brief Get cycle positions left in the run
+     * @return Upper bound on the values still to come
+     */
+    uint64_t getRemainingPositions() const { return remaining; }
+};
+
+#endif // PERMUTATION_H
@@ -0,0 +1,159 @@
+#include "pointer_chase.h"
+#include "permutation.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+
+namespace {
+
+// Smallest number of elements worth handing to its own thread
+constexpr size_t MIN_PARALLEL_ELEMENTS = 1 << 16;
+
+// Hugepage size the mapping length is rounded to
+constexpr size_t HUGE_PAGE_BYTES = 2 << 20;
+
+void validateGeometry(size_t elements, size_t stride) {
+    if (elements == 0) {
+        throw std::invalid_argument("Pointer chase needs at least one element");
+    }
+    if (stride == 0 || stride % sizeof(void*) != 0) {
+        throw std::invalid_argument("Element stride must be a non-zero multiple of the pointer size");
+    }
+    if (elements > std::numeric_limits<size_t>::max() / stride) {
+        throw std::invalid_argument("Pointer chase buffer size overflows");
+    }
+}
+
+} // namespace
+
+void buildPointerChase(void* buffer, size_t elements, size_t stride,
+                       uint64_t seed, unsigned threads) {
+    validateGeometry(elements, stride);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t parts = std::min<size_t>(threads, std::max<size_t>(1, elements / MIN_PARALLEL_ELEMENTS));
+    uint8_t* base = static_cast<uint8_t*>(buffer);
+    auto link = [base, stride](uint64_t from, uint64_t to) {
+        *reinterpret_cast<void**>(base + from * stride) = base + to * stride;
+    };
+
+    // Each part links its own run of the cycle and closes it onto the
+    // first element of the next non-empty part
+    const PermutationIterator order(elements, seed);
+    std::vector<PermutationIterator> pieces;
+    std::vector<uint64_t> firsts(parts);
+    std::vector<bool> empty(parts);
+    pieces.reserve(parts);
+    for (size_t p = 0; p < parts; p++) {
+        pieces.push_back(order.partition(p, parts));
+        PermutationIterator probe = pieces.back();
+        empty[p] = !probe.next(firsts[p]);
+    }
+
+    auto worker = [&](size_t index) {
+        PermutationIterator& piece = pieces[index];
+        uint64_t previous, value;
+        if (!piece.next(previous)) {
+            return;
+        }
+        while (piece.next(value)) {
+            link(previous, value);
+            previous = value;
+        }
+        size_t following = (index + 1) % parts;
+        while (empty[following]) {
+            following = (following + 1) % parts;
+        }
+        link(previous, firsts[following]);
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    size_t spawned = 1;
+    try {
+        for (; spawned < parts; spawned++) {
+            workers.emplace_back(worker, spawned);
+        }
+    } catch (const std::system_error&) {
+        // Out of threads: link the remaining parts here
+    }
+    for (size_t i = spawned; i < parts; i++) {
+        worker(i);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+PointerChaseBuffer::PointerChaseBuffer(size_t element_count, size_t element_stride,
+                                       bool huge_pages, uint64_t seed, unsigned threads)
+    : memory(nullptr), mapped_bytes(0), elements(element_count), stride(element_stride),
+      backing(PageBacking::Standard) {
+
+    validateGeometry(elements, stride);
+    const size_t bytes = elements * stride;
+    void* mapping = MAP_FAILED;
+    if (huge_pages) {
+        mapped_bytes = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+#ifdef MAP_HUGETLB
+        mapping = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping != MAP_FAILED) {
+            backing = PageBacking::ExplicitHuge;
+        }
+#endif
+    } else {
+        mapped_bytes = bytes;
+    }
+    if (mapping == MAP_FAILED) {
+        mapping = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error(std::string("Cannot map pointer chase buffer: ") + std::strerror(errno));
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge_pages && ::madvise(mapping, mapped_bytes, MADV_HUGEPAGE) == 0) {
+            backing = PageBacking::TransparentHuge;
+        }
+#endif
+    }
+    memory = mapping;
+    try {
+        buildPointerChase(memory, elements, stride, seed, threads);
+    } catch (...) {
+        ::munmap(memory, mapped_bytes);
+        throw;
+    }
+}
+
+PointerChaseBuffer::~PointerChaseBuffer() {
+    ::munmap(memory, mapped_bytes);
+}
+
+const void* PointerChaseBuffer::chase(uint64_t loads) const {
+    void* const* position = static_cast<void* const*>(memory);
+    for (uint64_t i = 0; i < loads; i++) {
+        position = static_cast<void* const*>(*position);
+    }
+    return position;
+}
+
+double PointerChaseBuffer::measureLatency(uint64_t loads) const {
+    if (loads == 0) {
+        return 0.0;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const void* volatile end = chase(loads);
+    const auto stop = std::chrono::steady_clock::now();
+    (void)end;
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(loads);
+}
@@ -0,0 +1,112 @@
+#ifndef POINTER_CHASE_H
+#define POINTER_CHASE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Link a buffer into one pseudorandom pointer-chasing cycle
+ * @param buffer Array of elements * stride bytes, pointer-aligned
+ * @param elements Number of elements
+ * @param stride Bytes per element, a multiple of the pointer size
+ * @param seed Selects the order (see PermutationIterator)
+ * @param threads Worker count (0 means one per hardware thread)
+ * @throw std::invalid_argument if elements is zero or stride is invalid
+ *
+ * The first word of every element is set to the address of the next
+ * element on a single cycle through all of them, in the order of a
+ * PermutationIterator over the element indices: the successor function of
+ * a maximal-length register, so there is no index array, no shuffle and
+ * no pattern a stride prefetcher can follow. Each thread links one
+ * partition of the cycle; the rest of every element is left untouched.
+ */
+void buildPointerChase(void* buffer, size_t elements, size_t stride,
+                       uint64_t seed = 0, unsigned threads = 0);
+
+/**
+ * @enum PageBacking
+ * @brief Pages behind a PointerChaseBuffer
+ */
+enum class PageBacking {
+    Standard,         // Base pages
+    TransparentHuge,  // Base pages with a transparent hugepage hint
+    ExplicitHuge      // Reserved hugepages (MAP_HUGETLB)
+};
+
+/**
+ * @class PointerChaseBuffer
+ * @brief Anonymous mapping holding a pointer-chasing cycle, for
+ *        memory-latency measurement
+ *
+ * With huge_pages set the buffer is first mapped from reserved 2 MiB
+ * pages (MAP_HUGETLB); if none are available it falls back to base pages
+ * advised with MADV_HUGEPAGE, and getPageBacking() reports what was used.
+ */
+class PointerChaseBuffer {
+private:
+    void* memory;          // Start of the mapping, element 0
+    size_t mapped_bytes;   // Length of the mapping
+    size_t elements;       // Elements on the cycle
+    size_t stride;         // Bytes per element
+    PageBacking backing;   // Pages behind the mapping
+
+public:
+    /**
+     * @brief Constructor
+     * @param element_count Number of elements
+     * @param element_stride Bytes per element, a multiple of the pointer
+     *        size (64 puts every element on its own cache line)
+     * @param huge_pages Back the buffer with hugepages if possible
+     * @param seed Selects the order
+     * @param threads Worker count for building (0 means one per hardware thread)
+     * @throw std::invalid_argument if the geometry is invalid
+     * @throw std::runtime_error if the buffer cannot be mapped
+     */
+    PointerChaseBuffer(size_t element_count, size_t element_stride = 64,
+                       bool huge_pages = false, uint64_t seed = 0, unsigned threads = 0);
+
+    ~PointerChaseBuffer();
+
+    PointerChaseBuffer(const PointerChaseBuffer&) = delete;
+    PointerChaseBuffer& operator=(const PointerChaseBuffer&) = delete;
+
+    /**
+     * @brief Follow the chain
+     * @param loads Number of dependent loads
+     * @return Element reached after loads steps from element 0
+     */
+    const void* chase(uint64_t loads) const;
+
+    /**
+     * @brief Measure the average latency of a dependent load
+     * @param loads Number of loads to time
+     * @return Nanoseconds per load
+     */
+    double measureLatency(uint64_t loads) const;
+
+    /**
+     * @brief Get the buffer
+     * @return Element 0; element i starts i * stride bytes later
+     */
+    const void* data() const { return memory; }
+
+    /**
+     * @brief Get number of elements
+     * @return Elements on the cycle
+     */
+    size_t getElements() const { return elements; }
+
+    /**
+     * @brief Get element stride
+     * @return Bytes per element
+     */
+    size_t getStride() const { return stride; }
+
+    /**
+     * @brief Get page backing
+     * @return Kind of pages the buffer was mapped with
+     */
+    PageBacking getPageBacking() const { return backing; }
+};
+
+#endif // POINTER_CHASE_H
@@ -0,0 +1,163 @@
+#include "prbs.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline uint64_t loadWord(const uint8_t* data) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+} // namespace
+
+PRBSChecker::PRBSChecker(const LFSRPreset& preset, uint32_t loss_threshold)
+    : generator(makeLFSR(preset)),
+      msb_first(preset.bit_order == BitOrder::MsbFirst),
+      invert_mask(preset.inverted ? ~0ULL : 0),
+      loss_threshold(loss_threshold),
+      sync_state(SyncState::Hunting),
+      pending(0), pending_bits(0),
+      verify_bits(0), window_bits(0), window_errors(0),
+      bits_checked(0), bit_errors(0), sync_losses(0) {
+}
+
+uint64_t PRBSChecker::normalize(uint64_t word) const {
+    if (msb_first) {
+        // Reverse the bits within each byte
+        word = ((word & 0xF0F0F0F0F0F0F0F0ULL) >> 4) | ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        word = ((word & 0xCCCCCCCCCCCCCCCCULL) >> 2) | ((word & 0x3333333333333333ULL) << 2);
+        word = ((word & 0xAAAAAAAAAAAAAAAAULL) >> 1) | ((word & 0x5555555555555555ULL) << 1);
+    }
+    return word ^ invert_mask;
+}
+
+void PRBSChecker::seed(uint64_t bits) {
+    // The register holds the last degree bits of the sequence, so the
+    // received bits themselves are the state that predicts what follows.
+    // An all-zero window cannot occur in a PRBS; keep hunting.
+    if (bits == 0) {
+        return;
+    }
+    generator.setState(bits);
+    sync_state = SyncState::Verifying;
+    verify_bits = 0;
+}
+
+void PRBSChecker::check(uint64_t bits) {
+    int errors = __builtin_popcountll(bits ^ generator.nextBlock());
+    
+    if (sync_state == SyncState::Verifying) {
+        if (errors != 0) {
+            sync_state = SyncState::Hunting;
+            return;
+        }
+        verify_bits += 64;
+        if (verify_bits >= VERIFY_BITS) {
+            sync_state = SyncState::Locked;
+            window_bits = 0;
+            window_errors = 0;
+        }
+        return;
+    }
+    
+    countErrors(64, errors);
+}
+
+void PRBSChecker::countErrors(uint32_t bits, uint32_t errors) {
+    bits_checked += bits;
+    bit_errors += errors;
+    window_bits += bits;
+    window_errors += errors;
+    if (window_bits >= MONITOR_WINDOW_BITS) {
+        if (window_errors > loss_threshold) {
+            sync_state = SyncState::Hunting;
+            sync_losses++;
+        }
+        window_bits = 0;
+        window_errors = 0;
+    }
+}
+
+void PRBSChecker::consumePending() {
+    const int degree = generator.getSize();
+    
+    while (true) {
+        int needed = (sync_state == SyncState::Hunting) ? degree : 64;
+        if (pending_bits < needed) {
+            return;
+        }
+        
+        uint64_t bits = static_cast<uint64_t>(pending);
+        if (needed < 64) {
+            bits &= (1ULL << needed) - 1;
+        }
+        pending >>= needed;
+        pending_bits -= needed;
+        
+        if (sync_state == SyncState::Hunting) {
+            seed(bits);
+        } else {
+            check(bits);
+        }
+    }
+}
+
+void PRBSChecker::checkRun(const uint8_t* data, size_t words) {
+    uint64_t predicted[MONITOR_WINDOW_BITS / 64];
+    generator.fillBlocks(predicted, words);
+    
+    // Received blocks straddle input words by pending_bits, which stays
+    // constant while locked
+    const int offset = pending_bits;
+    uint64_t carry = static_cast<uint64_t>(pending);
+    uint32_t errors = 0;
+    for (size_t k = 0; k < words; k++) {
+        uint64_t word = normalize(loadWord(data + 8 * k));
+        uint64_t received = carry | (word << offset);
+        carry = (offset == 0) ? 0 : word >> (64 - offset);
+        errors += __builtin_popcountll(received ^ predicted[k]);
+    }
+    pending = carry;
+    
+    countErrors(static_cast<uint32_t>(words * 64), errors);
+}
+
+void PRBSChecker::process(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i + 8 <= len) {
+        if (sync_state == SyncState::Locked) {
+            // Bulk path: predict up to the end of the monitoring window
+            size_t words = std::min<size_t>((len - i) / 8, (MONITOR_WINDOW_BITS - window_bits) / 64);
+            checkRun(data + i, words);
+            i += 8 * words;
+            continue;
+        }
+        
+        pending |= static_cast<unsigned __int128>(normalize(loadWord(data + i))) << pending_bits;
+        pending_bits += 64;
+        i += 8;
+        consumePending();
+    }
+    
+    for (; i < len; i++) {
+        uint64_t byte = normalize(data[i]) & 0xFF;
+        pending |= static_cast<unsigned __int128>(byte) << pending_bits;
+        pending_bits += 8;
+        consumePending();
+    }
+}
+
+double PRBSChecker::getBitErrorRate() const {
+    return bits_checked == 0 ? 0.0 : static_cast<double>(bit_errors) / bits_checked;
+}
+
+void PRBSChecker::resetCounters() {
+    bits_checked = 0;
+    bit_errors = 0;
+    sync_losses = 0;
+}
@@ -0,0 +1,146 @@
+#ifndef PRBS_H
+#define PRBS_H
+
+#include "lfsr.h"
+#include "presets.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class PRBSChecker
+ * @brief Self-synchronizing PRBS error checker for received data
+ * 
+ * The checker seeds its register from degree received bits, then
+ * predicts the stream 64 bits at a time with the LFSR block kernel and
+ * counts bit errors with XOR and popcount. A seed is accepted after a
+ * run of error-free blocks; once locked, an error count above the loss
+ * threshold within one monitoring window drops sync and the checker
+ * hunts again. Data is expected with the preset's bit order and
+ * inversion, as produced by PresetGenerator.
+ */
+class PRBSChecker {
+public:
+    enum class SyncState {
+        Hunting,     // Collecting bits to seed the register
+        Verifying,   // Seeded, waiting for error-free blocks
+        Locked       // Counting bit errors
+    };
+    
+    static constexpr uint32_t VERIFY_BITS = 256;          // Clean bits needed to lock
+    static constexpr uint32_t MONITOR_WINDOW_BITS = 1024; // Loss-of-sync window
+
+private:
+    LFSR generator;              // Predicts the expected stream
+    bool msb_first;              // Received bytes are MSB-first
+    uint64_t invert_mask;        // All ones for inverted presets
+    uint32_t loss_threshold;     // Errors per window that drop sync
+    
+    SyncState sync_state;
+    unsigned __int128 pending;   // Received bits not yet checked
+    int pending_bits;            // Number of valid bits in pending
+    uint32_t verify_bits;        // Clean bits seen while verifying
+    uint32_t window_bits;        // Bits in the current monitoring window
+    uint32_t window_errors;      // Errors in the current monitoring window
+    
+    uint64_t bits_checked;       // Bits compared while locked
+    uint64_t bit_errors;         // Errors counted while locked
+    uint64_t sync_losses;        // Times lock was lost
+    
+    /**
+     * @brief Convert received bytes to LSB-first, non-inverted bits
+     * @param word Eight received bytes, little-endian
+     * @return Bits in LFSR order
+     */
+    uint64_t normalize(uint64_t word) const;
+    
+    /**
+     * @brief Seed the register from received bits
+     * @param bits Next degree received bits
+     */
+    void seed(uint64_t bits);
+    
+    /**
+     * @brief Compare one received block with the prediction
+     * @param bits Next 64 received bits
+     */
+    void check(uint64_t bits);
+    
+    /**
+     * @brief Check whole received words against a predicted run
+     * @param data Received bytes
+     * @param words Number of 8-byte words (at most one monitoring window)
+     */
+    void checkRun(const uint8_t* data, size_t words);
+    
+    /**
+     * @brief Add locked errors to the counters and monitor sync
+     * @param bits Bits compared
+     * @param errors Errors found
+     */
+    void countErrors(uint32_t bits, uint32_t errors);
+    
+    /**
+     * @brief Seed or check as many buffered bits as possible
+     */
+    void consumePending();
+
+public:
+    /**
+     * @brief Constructor
+     * @param preset PRBS definition (e.g. findPreset("PRBS31"))
+     * @param loss_threshold Errors per monitoring window that drop sync
+     */
+    explicit PRBSChecker(const LFSRPreset& preset, uint32_t loss_threshold = 128);
+    
+    /**
+     * @brief Check a block of received data
+     * @param data Received bytes
+     * @param len Number of bytes
+     * 
+     * Bits that do not fill a whole block are kept for the next call.
+     */
+    void process(const uint8_t* data, size_t len);
+    
+    /**
+     * @brief Get current synchronization state
+     * @return Sync state
+     */
+    SyncState getSyncState() const { return sync_state; }
+    
+    /**
+     * @brief Check whether the checker is locked to the stream
+     * @return true if locked
+     */
+    bool isLocked() const { return sync_state == SyncState::Locked; }
+    
+    /**
+     * @brief Get number of bits compared while locked
+     * @return Checked bits
+     */
+    uint64_t getBitsChecked() const { return bits_checked; }
+    
+    /**
+     * @brief Get number of bit errors counted while locked
+     * @return Bit errors
+     */
+    uint64_t getBitErrors() const { return bit_errors; }
+    
+    /**
+     * @brief Get number of times lock was lost
+     * @return Sync losses
+     */
+    uint64_t getSyncLosses() const { return sync_losses; }
+    
+    /**
+     * @brief Get measured bit error rate
+     * @return Errors per checked bit (0 if nothing was checked)
+     */
+    double getBitErrorRate() const;
+    
+    /**
+     * @brief Clear error counters without dropping sync
+     */
+    void resetCounters();
+};
+
+#endif // PRBS_H
@@ -0,0 +1,206 @@
+#include "presets.h"
+
+namespace {
+
+constexpr uint64_t taps(std::initializer_list<int> exponents) {
+    uint64_t mask = 0;
+    for (int k : exponents) {
+        mask |= 1ULL << (k - 1);
+    }
+    return mask;
+}
+
+// Reference vectors are the first 16 output bytes from the default seed.
+// The IEEE 802.11, DVB and SONET vectors match the sequences printed in
+// those standards; the rest come from a bit-serial model of each circuit.
+const std::vector<LFSRPreset> PRESETS = {
+    {"IEEE802.11", "IEEE 802.11 data scrambler, x^7 + x^4 + 1",
+     7, taps({4, 7}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7F, BitOrder::LsbFirst, false,
+     {0x70, 0x4F, 0x93, 0x40, 0x64, 0x74, 0x6D, 0x30,
+      0x2B, 0xE7, 0x2D, 0x54, 0x5F, 0x8A, 0x1D, 0x7F}},
+    {"DVB", "DVB energy dispersal, 1 + x^14 + x^15, init 100101010000000",
+     15, taps({14, 15}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x00A9, BitOrder::MsbFirst, false,
+     {0x03, 0xF6, 0x08, 0x34, 0x30, 0xB8, 0xA3, 0x93,
+      0xC9, 0x68, 0xB7, 0x73, 0xB3, 0x29, 0xAA, 0xF5}},
+    {"BLE", "Bluetooth LE whitening, x^7 + x^4 + 1, seed for channel 37",
+     7, taps({4, 7}), LFSRConfiguration::Galois, OutputTap::LastStage,
+     0x53, BitOrder::LsbFirst, false,
+     {0x8D, 0xD2, 0x57, 0xA1, 0x3D, 0xA7, 0x66, 0xB0,
+      0x75, 0x31, 0x11, 0x48, 0x96, 0x77, 0xF8, 0xE3}},
+    {"PCIe-Gen3", "PCIe 8 GT/s scrambler, x^23 + x^21 + x^16 + x^8 + x^5 + x^2 + 1, lane 0 seed",
+     23, taps({2, 5, 8, 16, 21, 23}), LFSRConfiguration::Galois, OutputTap::LastStage,
+     0x1DBFBC, BitOrder::LsbFirst, false,
+     {0x6C, 0xBD, 0x94, 0x98, 0x53, 0xC6, 0xD8, 0xCE,
+      0x50, 0x6A, 0x75, 0xC1, 0x04, 0x4F, 0xC3, 0x07}},
+    {"SONET", "SONET/SDH frame synchronous scrambler, 1 + x^6 + x^7",
+     7, taps({6, 7}), LFSRConfiguration::Fibonacci, OutputTap::LastStage,
+     0x7F, BitOrder::MsbFirst, false,
+     {0xFE, 0x04, 0x18, 0x51, 0xE4, 0x59, 0xD4, 0xFA,
+      0x1C, 0x49, 0xB5, 0xBD, 0x8D, 0x2E, 0xE6, 0x55}},
+    {"PRBS7", "PRBS7, x^7 + x^6 + 1",
+     7, taps({6, 7}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7F, BitOrder::LsbFirst, false,
+     {0x40, 0x30, 0x14, 0x4F, 0x34, 0x57, 0xBE, 0x70,
+      0x24, 0x5B, 0x7B, 0x63, 0xE9, 0xCE, 0x54, 0x7F}},
+    {"PRBS9", "PRBS9, x^9 + x^5 + 1",
+     9, taps({5, 9}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x1FF, BitOrder::LsbFirst, false,
+     {0xE0, 0x7D, 0x74, 0x26, 0x48, 0xB9, 0xC5, 0xF3,
+      0xD9, 0xA8, 0xC4, 0xB1, 0xD5, 0x91, 0x11, 0x01}},
+    {"PRBS11", "PRBS11, x^11 + x^9 + 1",
+     11, taps({9, 11}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FF, BitOrder::LsbFirst, false,
+     {0x00, 0x06, 0x3C, 0x98, 0xF1, 0x6F, 0xA0, 0x43,
+      0x9A, 0xE6, 0xF9, 0x3C, 0x9E, 0xCD, 0xF7, 0x51}},
+    {"PRBS15", "PRBS15, x^15 + x^14 + 1",
+     15, taps({14, 15}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FFF, BitOrder::LsbFirst, false,
+     {0x00, 0x40, 0x00, 0x30, 0x00, 0x14, 0x00, 0x0F,
+      0x40, 0x04, 0x30, 0x03, 0x54, 0x01, 0xFF, 0x40}},
+    {"PRBS20", "PRBS20, x^20 + x^3 + 1",
+     20, taps({3, 20}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0xFFFFF, BitOrder::LsbFirst, false,
+     {0x38, 0x8E, 0x13, 0x3B, 0xB1, 0x14, 0x4B, 0x41,
+      0xEB, 0x4B, 0x86, 0xEA, 0xBB, 0x85, 0xEA, 0xBC}},
+    {"PRBS23", "PRBS23, x^23 + x^18 + 1",
+     23, taps({18, 23}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FFFFF, BitOrder::LsbFirst, false,
+     {0x00, 0x00, 0x7C, 0x00, 0xF0, 0x3F, 0xC0, 0x07,
+      0x1F, 0xFF, 0xFF, 0x73, 0x00, 0x30, 0x38, 0xC0}},
+    {"PRBS31", "PRBS31, x^31 + x^28 + 1",
+     31, taps({28, 31}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FFFFFFF, BitOrder::LsbFirst, false,
+     {0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x3F,
+      0x00, 0x00, 0x70, 0x1C, 0x00, 0x00, 0xFF, 0x0F}},
+    {"O.150-15", "ITU-T O.150 2^15-1 test pattern, x^15 + x^14 + 1, inverted",
+     15, taps({14, 15}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FFF, BitOrder::LsbFirst, true,
+     {0xFF, 0xBF, 0xFF, 0xCF, 0xFF, 0xEB, 0xFF, 0xF0,
+      0xBF, 0xFB, 0xCF, 0xFC, 0xAB, 0xFE, 0x00, 0xBF}},
+    {"O.150-23", "ITU-T O.150 2^23-1 test pattern, x^23 + x^18 + 1, inverted",
+     23, taps({18, 23}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FFFFF, BitOrder::LsbFirst, true,
+     {0xFF, 0xFF, 0x83, 0xFF, 0x0F, 0xC0, 0x3F, 0xF8,
+      0xE0, 0x00, 0x00, 0x8C, 0xFF, 0xCF, 0xC7, 0x3F}},
+    {"O.150-31", "ITU-T O.150 2^31-1 test pattern, x^31 + x^28 + 1, inverted",
+     31, taps({28, 31}), LFSRConfiguration::Fibonacci, OutputTap::Feedback,
+     0x7FFFFFFF, BitOrder::LsbFirst, true,
+     {0xFF, 0xFF, 0xFF, 0x8F, 0xFF, 0xFF, 0xFF, 0xC0,
+      0xFF, 0xFF, 0x8F, 0xE3, 0xFF, 0xFF, 0x00, 0xF0}},
+};
+
+/**
+ * @brief Run the standard's circuit bit-serially
+ * @return First degree output bits, first bit in the LSB
+ */
+uint64_t simulateCircuit(const LFSRPreset& preset, uint64_t seed) {
+    const int n = preset.degree;
+    const uint64_t last_stage = 1ULL << (n - 1);
+    uint64_t stages = seed;   // bit k-1 = stage k
+    uint64_t output = 0;
+    
+    for (int i = 0; i < n; i++) {
+        uint64_t bit;
+        if (preset.configuration == LFSRConfiguration::Fibonacci) {
+            uint64_t feedback = __builtin_parityll(stages & preset.taps);
+            bit = (preset.output == OutputTap::Feedback) ? feedback : (stages & last_stage) != 0;
+            stages = (stages << 1) | feedback;
+        } else {
+            bit = (stages & last_stage) != 0;
+            stages = (stages << 1) | bit;
+            if (bit) {
+                // Stage k+1 receives stage k XOR the output for each x^k tap
+                stages ^= preset.taps << 1;
+            }
+        }
+        stages &= (n == 64) ? ~0ULL : (1ULL << n) - 1;
+        output |= bit << i;
+    }
+    return output;
+}
+
+uint8_t reverseBits(uint8_t value) {
+    value = static_cast<uint8_t>((value & 0xF0) >> 4 | (value & 0x0F) << 4);
+    value = static_cast<uint8_t>((value & 0xCC) >> 2 | (value & 0x33) << 2);
+    value = static_cast<uint8_t>((value & 0xAA) >> 1 | (value & 0x55) << 1);
+    return value;
+}
+
+} // namespace
+
+const std::vector<LFSRPreset>& getPresets() {
+    return PRESETS;
+}
+
+const LFSRPreset& findPreset(const std::string& name) {
+    for (const auto& preset : PRESETS) {
+        if (name == preset.name) {
+            return preset;
+        }
+    }
+    throw std::invalid_argument("Unknown LFSR preset: " + name);
+}
+
+LFSR makeLFSR(const LFSRPreset& preset, uint64_t seed) {
+    const int n = preset.degree;
+    if (n < 2 || n > 64 || (preset.taps >> (n - 1)) != 1) {
+        throw std::invalid_argument("Preset polynomial degree does not match register size");
+    }
+    if (seed == 0) {
+        seed = preset.seed;
+    }
+    
+    // Both structures produce a sequence obeying a fixed recurrence:
+    // Fibonacci registers the reciprocal of the written polynomial,
+    // Galois registers the polynomial itself.
+    const uint64_t state_mask = (n == 64) ? ~0ULL : (1ULL << n) - 1;
+    uint64_t mask = 0;
+    if (preset.configuration == LFSRConfiguration::Fibonacci) {
+        for (int k = 1; k <= n; k++) {
+            if ((preset.taps >> (k - 1)) & 1) {
+                mask |= 1ULL << (n - k);
+            }
+        }
+    } else {
+        mask = ((preset.taps << 1) | 1) & state_mask;
+    }
+    
+    // LFSR's state is the window of bits preceding its next output, so
+    // start from the circuit's first n outputs and step back n times.
+    uint64_t window = simulateCircuit(preset, seed & state_mask);
+    for (int i = 0; i < n; i++) {
+        uint64_t previous = ((window >> (n - 1)) & 1) ^ __builtin_parityll((mask >> 1) & window);
+        window = ((window << 1) | previous) & state_mask;
+    }
+    if (window == 0) {
+        throw std::invalid_argument("Preset seed must be non-zero");
+    }
+    
+    return LFSR(preset.degree, mask, window);
+}
+
+PresetGenerator::PresetGenerator(const LFSRPreset& preset, uint64_t seed)
+    : generator(makeLFSR(preset, seed)),
+      msb_first(preset.bit_order == BitOrder::MsbFirst),
+      invert_mask(preset.inverted ? 0xFF : 0x00) {
+}
+
+bool PresetGenerator::nextBit() {
+    return generator.nextBit() != (invert_mask != 0);
+}
+
+void PresetGenerator::fill(uint8_t* out, size_t len) {
+    generator.fill(out, len);
+    if (msb_first) {
+        for (size_t i = 0; i < len; i++) {
+            out[i] = reverseBits(out[i]);
+        }
+    }
+    if (invert_mask) {
+        for (size_t i = 0; i < len; i++) {
+            out[i] ^= invert_mask;
+        }
+    }
+}
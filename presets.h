@@ -0,0 +1,128 @@
+#ifndef PRESETS_H
+#define PRESETS_H
+
+#include "lfsr.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Register structure used by a standard to describe its LFSR
+ */
+enum class LFSRConfiguration {
+    Fibonacci,   // External XOR: feedback is the XOR of the tapped stages
+    Galois       // Internal XOR: the last stage is XORed into tapped stages
+};
+
+/**
+ * @brief Which bit of a Fibonacci register is emitted each step
+ */
+enum class OutputTap {
+    Feedback,    // The newly computed feedback bit (as LFSR::nextBit())
+    LastStage    // The bit shifted out of the last stage
+};
+
+/**
+ * @brief Order in which sequence bits are packed into bytes
+ */
+enum class BitOrder {
+    LsbFirst,    // First bit in bit 0 (as LFSR::nextByte())
+    MsbFirst     // First bit in bit 7
+};
+
+/**
+ * @struct LFSRPreset
+ * @brief Polynomial and conventions of a standard scrambler or PRBS
+ * 
+ * Polynomials are written as the standards write them: bit k-1 of taps
+ * is set for each x^k term of 1 + ... + x^degree. Stages are numbered
+ * 1..degree from the feedback input, and bit k-1 of seed is stage k.
+ * Galois registers always emit the last stage.
+ */
+struct LFSRPreset {
+    const char* name;              // Registry key, e.g. "PRBS31"
+    const char* description;       // Standard and polynomial
+    uint8_t degree;                // Register length in bits
+    uint64_t taps;                 // Polynomial terms, bit k-1 for x^k
+    LFSRConfiguration configuration;
+    OutputTap output;              // Ignored for Galois registers
+    uint64_t seed;                 // Default register contents
+    BitOrder bit_order;            // Byte packing of the output
+    bool inverted;                 // Output is complemented
+    std::vector<uint8_t> reference; // First output bytes from the default seed
+};
+
+/**
+ * @brief Get all registered presets
+ * @return Preset table
+ */
+const std::vector<LFSRPreset>& getPresets();
+
+/**
+ * @brief Look up a preset by name
+ * @param name Preset name (e.g. "IEEE802.11", "PRBS23")
+ * @return Matching preset
+ * @throw std::invalid_argument if no preset has that name
+ */
+const LFSRPreset& findPreset(const std::string& name);
+
+/**
+ * @brief Build an LFSR that reproduces a preset's bit sequence
+ * @param preset Standard conventions
+ * @param seed Register contents in the preset's stage numbering
+ *        (0 means use the preset default)
+ * @return Register whose nextBit() sequence is the standard's output
+ *         bit sequence before inversion and byte packing
+ * @throw std::invalid_argument if the preset is malformed
+ */
+LFSR makeLFSR(const LFSRPreset& preset, uint64_t seed = 0);
+
+/**
+ * @class PresetGenerator
+ * @brief Byte stream of a preset with its bit order and inversion applied
+ * 
+ * Runs on the LFSR block kernel; inversion and bit order are applied to
+ * the generated bytes afterwards.
+ */
+class PresetGenerator {
+private:
+    LFSR generator;        // Register in LFSR's own convention
+    bool msb_first;        // Reverse bits within each byte
+    uint8_t invert_mask;   // 0xFF for inverted presets, 0 otherwise
+
+public:
+    /**
+     * @brief Constructor
+     * @param preset Standard conventions
+     * @param seed Register contents (0 means use the preset default)
+     */
+    explicit PresetGenerator(const LFSRPreset& preset, uint64_t seed = 0);
+    
+    /**
+     * @brief Generate next output bit, inversion applied
+     * @return Next bit
+     */
+    bool nextBit();
+    
+    /**
+     * @brief Fill a buffer with output bytes
+     * @param out Destination buffer
+     * @param len Number of bytes
+     */
+    void fill(uint8_t* out, size_t len);
+    
+    /**
+     * @brief Skip output bits
+     * @param bits Number of bits to skip
+     */
+    void jump(uint64_t bits) { generator.jump(bits); }
+    
+    /**
+     * @brief Get the underlying register
+     * @return Register in LFSR's own convention
+     */
+    const LFSR& getLFSR() const { return generator; }
+};
+
+#endif // PRESETS_H
@@ -0,0 +1,149 @@
+#include "scrambler.h"
+
+namespace {
+
+// Keystream bytes generated per iteration; the XOR loop over a
+// fixed-size chunk is vectorized by the compiler.
+constexpr size_t CHUNK_SIZE = 64;
+
+void applyKeystream(LFSR& generator, uint8_t* data, size_t len) {
+    uint8_t keystream[CHUNK_SIZE];
+    
+    size_t i = 0;
+    for (; i + CHUNK_SIZE <= len; i += CHUNK_SIZE) {
+        generator.fill(keystream, CHUNK_SIZE);
+        for (size_t k = 0; k < CHUNK_SIZE; k++) {
+            data[i + k] ^= keystream[k];
+        }
+    }
+    
+    size_t remaining = len - i;
+    generator.fill(keystream, remaining);
+    for (size_t k = 0; k < remaining; k++) {
+        data[i + k] ^= keystream[k];
+    }
+}
+
+} // namespace
+
+AdditiveScrambler::AdditiveScrambler(const LFSR& keystream)
+    : origin(keystream), generator(keystream), position(0) {
+}
+
+void AdditiveScrambler::scramble(uint8_t* data, size_t len) {
+    applyKeystream(generator, data, len);
+    position += len;
+}
+
+void AdditiveScrambler::scrambleAt(uint64_t offset, uint8_t* data, size_t len) const {
+    LFSR local = origin;
+    local.jumpBytes(offset);
+    applyKeystream(local, data, len);
+}
+
+void AdditiveScrambler::reset() {
+    generator = origin;
+    position = 0;
+}
+
+MultiplicativeScrambler::MultiplicativeScrambler(uint64_t polynomial, uint64_t initial_state)
+    : polynomial(polynomial), history(initial_state), min_tap(0) {
+    
+    if (polynomial == 0) {
+        throw std::invalid_argument("Scrambler polynomial must have at least one tap");
+    }
+    min_tap = __builtin_ctzll(polynomial) + 1;
+}
+
+uint64_t MultiplicativeScrambler::historyTerms() const {
+    // Tap x^k at block bit i reads line bit i-k; for i < k that bit is
+    // bit 64+i-k of the previous block.
+    uint64_t result = 0;
+    for (uint64_t taps = polynomial; taps; taps &= taps - 1) {
+        int k = __builtin_ctzll(taps) + 1;
+        result ^= history >> (64 - k);
+    }
+    return result;
+}
+
+uint64_t MultiplicativeScrambler::blockTerms(uint64_t line) const {
+    uint64_t result = 0;
+    for (uint64_t taps = polynomial & ~(1ULL << 63); taps; taps &= taps - 1) {
+        int k = __builtin_ctzll(taps) + 1;
+        result ^= line << k;
+    }
+    return result;
+}
+
+void MultiplicativeScrambler::pushHistory(uint64_t line, int bits) {
+    history = (bits == 64) ? line : (line << (64 - bits)) | (history >> bits);
+}
+
+uint64_t MultiplicativeScrambler::scrambleBlock(uint64_t data) {
+    // Output bits depend on earlier output bits of the same block, so each
+    // pass settles another min_tap bits, starting from the lowest.
+    uint64_t base = data ^ historyTerms();
+    uint64_t line = base;
+    for (int settled = min_tap; settled < 64; settled += min_tap) {
+        line = base ^ blockTerms(line);
+    }
+    pushHistory(line, 64);
+    return line;
+}
+
+uint64_t MultiplicativeScrambler::descrambleBlock(uint64_t line) {
+    uint64_t data = line ^ historyTerms() ^ blockTerms(line);
+    pushHistory(line, 64);
+    return data;
+}
+
+namespace {
+
+uint64_t loadBlock(const uint8_t* data, size_t len) {
+    uint64_t block = 0;
+    for (size_t k = 0; k < len; k++) {
+        block |= static_cast<uint64_t>(data[k]) << (8 * k);
+    }
+    return block;
+}
+
+void storeBlock(uint8_t* data, size_t len, uint64_t block) {
+    for (size_t k = 0; k < len; k++) {
+        data[k] = static_cast<uint8_t>(block >> (8 * k));
+    }
+}
+
+} // namespace
+
+void MultiplicativeScrambler::scramble(uint8_t* data, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        storeBlock(data + i, 8, scrambleBlock(loadBlock(data + i, 8)));
+    }
+    if (i < len) {
+        // Bits past the tail only depend on earlier bits, so they are
+        // computed and discarded without disturbing the valid ones.
+        size_t tail = len - i;
+        uint64_t saved = history;
+        uint64_t line = scrambleBlock(loadBlock(data + i, tail));
+        history = saved;
+        pushHistory(line, static_cast<int>(tail * 8));
+        storeBlock(data + i, tail, line);
+    }
+}
+
+void MultiplicativeScrambler::descramble(uint8_t* data, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        storeBlock(data + i, 8, descrambleBlock(loadBlock(data + i, 8)));
+    }
+    if (i < len) {
+        size_t tail = len - i;
+        uint64_t line = loadBlock(data + i, tail);
+        uint64_t saved = history;
+        uint64_t payload = descrambleBlock(line);
+        history = saved;
+        pushHistory(line, static_cast<int>(tail * 8));
+        storeBlock(data + i, tail, payload);
+    }
+}
@@ -0,0 +1,156 @@
+#ifndef SCRAMBLER_H
+#define SCRAMBLER_H
+
+#include "lfsr.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class AdditiveScrambler
+ * @brief Synchronous (additive) scrambler driven by an LFSR keystream
+ * 
+ * Data is XORed with the byte stream produced by LFSR::fill(), so
+ * scrambling and descrambling are the same operation. Besides the
+ * stateful stream interface, any buffer can be processed at an explicit
+ * byte offset of the keystream, which lets independent buffers be
+ * handled out of order.
+ */
+class AdditiveScrambler {
+private:
+    LFSR origin;         // Generator at keystream offset 0
+    LFSR generator;      // Generator at the current stream position
+    uint64_t position;   // Bytes processed since construction or reset
+
+public:
+    /**
+     * @brief Constructor
+     * @param keystream Generator whose current state defines offset 0
+     */
+    explicit AdditiveScrambler(const LFSR& keystream);
+    
+    /**
+     * @brief Scramble a buffer in place, continuing the stream
+     * @param data Buffer to scramble
+     * @param len Buffer length in bytes
+     */
+    void scramble(uint8_t* data, size_t len);
+    
+    /**
+     * @brief Descramble a buffer in place, continuing the stream
+     * @param data Buffer to descramble
+     * @param len Buffer length in bytes
+     */
+    void descramble(uint8_t* data, size_t len) { scramble(data, len); }
+    
+    /**
+     * @brief Scramble a buffer located at a given keystream offset
+     * @param offset Byte offset of data[0] within the stream
+     * @param data Buffer to scramble
+     * @param len Buffer length in bytes
+     * 
+     * Does not change the stream position; safe to call concurrently.
+     */
+    void scrambleAt(uint64_t offset, uint8_t* data, size_t len) const;
+    
+    /**
+     * @brief Rewind the stream to offset 0
+     */
+    void reset();
+    
+    /**
+     * @brief Get current stream position
+     * @return Number of bytes processed by scramble()/descramble()
+     */
+    uint64_t getPosition() const { return position; }
+};
+
+/**
+ * @class MultiplicativeScrambler
+ * @brief Self-synchronizing scrambler/descrambler for polynomials up to x^64
+ * 
+ * The feedback taps are applied to the transmitted (scrambled) bits, as in
+ * the 64b/66b scrambler 1 + x^39 + x^58, so a descrambler locks onto the
+ * stream after degree bits regardless of its initial state. Bits are
+ * processed 64 at a time with word shifts; the first bit of a block is
+ * its LSB and bytes are taken in little-endian order.
+ * 
+ * One instance keeps one line history, so use separate instances for the
+ * transmit and receive directions.
+ */
+class MultiplicativeScrambler {
+private:
+    uint64_t polynomial;   // Bit k-1 set for each x^k term (constant term implied)
+    uint64_t history;      // Last 64 line bits, most recent in the MSB
+    int min_tap;           // Smallest tap distance
+    
+    /**
+     * @brief Contribution of the feedback taps from the previous block
+     * @return XOR of all taps that reach back into history
+     */
+    uint64_t historyTerms() const;
+    
+    /**
+     * @brief Contribution of the feedback taps within the current block
+     * @param line Line bits of the current block
+     * @return XOR of all taps that fall inside the block
+     */
+    uint64_t blockTerms(uint64_t line) const;
+    
+    /**
+     * @brief Append line bits to the history
+     * @param line Line bits of the current block
+     * @param bits Number of valid bits in line (1-64)
+     */
+    void pushHistory(uint64_t line, int bits);
+
+public:
+    /**
+     * @brief Constructor
+     * @param polynomial Tap mask, bit k-1 set for each x^k term
+     * @param initial_state Initial line history
+     * @throw std::invalid_argument if polynomial is zero
+     */
+    explicit MultiplicativeScrambler(uint64_t polynomial, uint64_t initial_state = ~0ULL);
+    
+    /**
+     * @brief Scramble one 64-bit block
+     * @param data Payload bits, first bit in the LSB
+     * @return Scrambled line bits
+     */
+    uint64_t scrambleBlock(uint64_t data);
+    
+    /**
+     * @brief Descramble one 64-bit block
+     * @param line Received line bits, first bit in the LSB
+     * @return Recovered payload bits
+     */
+    uint64_t descrambleBlock(uint64_t line);
+    
+    /**
+     * @brief Scramble a buffer in place
+     * @param data Buffer to scramble
+     * @param len Buffer length in bytes
+     */
+    void scramble(uint8_t* data, size_t len);
+    
+    /**
+     * @brief Descramble a buffer in place
+     * @param data Buffer to descramble
+     * @param len Buffer length in bytes
+     */
+    void descramble(uint8_t* data, size_t len);
+    
+    /**
+     * @brief Replace the line history
+     * @param state New history, most recent bit in the MSB
+     */
+    void reset(uint64_t state = ~0ULL) { history = state; }
+    
+    /**
+     * @brief Get the line history
+     * @return Last 64 line bits, most recent in the MSB
+     */
+    uint64_t getState() const { return history; }
+};
+
+#endif // SCRAMBLER_H
@@ -0,0 +1,299 @@
+#include "sequence_file.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'L', 'F', 'S', 'R', 'S', 'E', 'Q', '1'};
+constexpr uint32_t FILE_VERSION = 1;
+constexpr size_t DATA_OFFSET = 4096;
+constexpr size_t HEADER_BYTES = 128;
+constexpr size_t HEADER_CHECKSUM_AT = 124;
+
+// Packed bytes collected before each write()
+constexpr size_t WRITE_BUFFER_BYTES = 1 << 20;
+
+void putLE(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLE(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t packedBytes(uint64_t bits) {
+    return bits / 8 + (bits % 8 != 0);
+}
+
+} // namespace
+
+bool BitSequenceView::at(uint64_t index) const {
+    if (index >= count) {
+        throw std::out_of_range("Bit index beyond the end of the sequence");
+    }
+    return (*this)[index];
+}
+
+uint64_t BitSequenceView::extract(uint64_t index, unsigned bits) const {
+    if (bits == 0 || bits > 64 || index > count || count - index < bits) {
+        throw std::out_of_range("Bit range beyond the end of the sequence");
+    }
+    // At most nine bytes, each contributing the bits from the current
+    // position to the end of the byte
+    uint64_t result = 0;
+    uint64_t position = first_bit + index;
+    unsigned taken = 0;
+    while (taken < bits) {
+        uint8_t byte = bytes[position >> 3];
+        if (msb_first) {
+            byte = static_cast<uint8_t>(((byte * 0x0202020202ULL) & 0x010884422010ULL) % 1023);
+        }
+        const unsigned shift = position & 7;
+        const unsigned take = std::min(8 - shift, bits - taken);
+        result |= static_cast<uint64_t>((byte >> shift) & ((1U << take) - 1)) << taken;
+        taken += take;
+        position += take;
+    }
+    return result;
+}
+
+BitSequenceView BitSequenceView::slice(uint64_t index, uint64_t bits) const {
+    if (index > count || count - index < bits) {
+        throw std::out_of_range("Bit range beyond the end of the sequence");
+    }
+    return BitSequenceView(bytes, bits, getBitOrder(), first_bit + index);
+}
+
+uint64_t BitSequenceView::countOnes() const {
+    // Bit order does not matter for whole bytes; only the partial bytes at
+    // either end are counted bit by bit
+    uint64_t ones = 0;
+    uint64_t index = 0;
+    while (index < count && ((first_bit + index) & 7) != 0) {
+        ones += (*this)[index++];
+    }
+    const uint8_t* whole = bytes + ((first_bit + index) >> 3);
+    const uint64_t whole_bytes = (count - index) / 8;
+    uint64_t i = 0;
+    for (; i + 8 <= whole_bytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, whole + i, 8);
+        ones += static_cast<uint64_t>(__builtin_popcountll(word));
+    }
+    for (; i < whole_bytes; i++) {
+        ones += static_cast<uint64_t>(__builtin_popcount(whole[i]));
+    }
+    for (index += whole_bytes * 8; index < count; index++) {
+        ones += (*this)[index];
+    }
+    return ones;
+}
+
+SequenceFileWriter::SequenceFileWriter(const std::string& file_path, const SequenceFileInfo& header)
+    : path(file_path), info(header), crc(CRC64_XZ) {
+    info.bit_count = 0;
+    info.checksum = 0;
+    crc_register = crc.begin();
+    fd = ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw systemError("Cannot create " + file_path, errno);
+    }
+    buffer.reserve(WRITE_BUFFER_BYTES);
+}
+
+SequenceFileWriter::~SequenceFileWriter() {
+    if (!finished) {
+        try {
+            finish();
+        } catch (...) {
+            // Destructors must not throw; call finish() to see the error
+        }
+    }
+}
+
+void SequenceFileWriter::flush() {
+    if (buffer.empty()) {
+        return;
+    }
+    crc_register = crc.update(crc_register, buffer.data(), buffer.size());
+    const uint64_t stored = packedBytes(info.bit_count) - buffer.size();
+    writeAll(fd, buffer.data(), buffer.size(), DATA_OFFSET + stored);
+    buffer.clear();
+}
+
+void SequenceFileWriter::append(const uint8_t* data, uint64_t bits) {
+    if (finished || partial) {
+        throw std::logic_error("Cannot append after a partial byte or after finish()");
+    }
+    const uint64_t whole = bits / 8;
+    const unsigned rest = bits % 8;
+    uint64_t done = 0;
+    while (done < whole) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(whole - done, WRITE_BUFFER_BYTES - buffer.size()));
+        buffer.insert(buffer.end(), data + done, data + done + n);
+        done += n;
+        info.bit_count += 8 * static_cast<uint64_t>(n);
+        if (buffer.size() == WRITE_BUFFER_BYTES) {
+            flush();
+        }
+    }
+    if (rest != 0) {
+        // Keep the first rest bits of the last byte, in the file's order
+        const uint8_t mask = info.bit_order == BitOrder::MsbFirst
+            ? static_cast<uint8_t>(0xFF00 >> rest) : static_cast<uint8_t>((1U << rest) - 1);
+        buffer.push_back(data[whole] & mask);
+        info.bit_count += rest;
+        partial = true;
+    }
+}
+
+SequenceFileInfo SequenceFileWriter::finish() {
+    if (finished) {
+        return info;
+    }
+    finished = true;
+    try {
+        flush();
+        info.checksum = crc.finish(crc_register);
+
+        uint8_t header[HEADER_BYTES] = {};
+        std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+        putLE(header + 8, FILE_VERSION, 4);
+        putLE(header + 12, DATA_OFFSET, 4);
+        putLE(header + 16, info.bit_count, 8);
+        putLE(header + 24, info.start_offset, 8);
+        putLE(header + 32, info.seed, 8);
+        putLE(header + 40, info.polynomial, 8);
+        header[48] = info.register_size;
+        header[49] = info.configuration == LFSRConfiguration::Galois ? 1 : 0;
+        header[50] = info.bit_order == BitOrder::MsbFirst ? 1 : 0;
+        putLE(header + 56, info.checksum, 8);
+        putLE(header + HEADER_CHECKSUM_AT, CRC(CRC32_ISO_HDLC).compute(header, HEADER_CHECKSUM_AT), 4);
+
+        // Pad the header page even when there is no data
+        const uint64_t end = DATA_OFFSET + packedBytes(info.bit_count);
+        if (::ftruncate(fd, static_cast<off_t>(end)) != 0) {
+            throw systemError("Cannot size " + path, errno);
+        }
+        writeAll(fd, header, sizeof(header), 0);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw systemError("Cannot close " + path, errno);
+    }
+    return info;
+}
+
+SequenceFileInfo writeSequenceFile(const std::string& path, const LFSR& generator,
+                                   uint64_t start_offset, uint64_t bits) {
+    SequenceFileInfo header;
+    header.register_size = generator.getSize();
+    header.polynomial = generator.getPolynomial();
+    header.configuration = LFSRConfiguration::Fibonacci;
+    header.seed = generator.getState();
+    header.start_offset = start_offset;
+    header.bit_order = BitOrder::LsbFirst;
+
+    SequenceFileWriter writer(path, header);
+    LFSR stream = generator;
+    stream.jump(start_offset % generator.getMaxPeriod());
+    std::vector<uint8_t> chunk(WRITE_BUFFER_BYTES);
+    for (uint64_t done = 0; done < bits;) {
+        const uint64_t n = std::min<uint64_t>(bits - done, 8 * static_cast<uint64_t>(chunk.size()));
+        stream.fill(chunk.data(), static_cast<size_t>(packedBytes(n)));
+        writer.append(chunk.data(), n);
+        done += n;
+    }
+    return writer.finish();
+}
+
+SequenceFile::SequenceFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw systemError("Cannot open " + path, errno);
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw systemError("Cannot stat " + path, error);
+    }
+    if (static_cast<uint64_t>(status.st_size) < DATA_OFFSET) {
+        ::close(fd);
+        throw std::runtime_error("Not a sequence file (too short): " + path);
+    }
+    map_bytes = static_cast<size_t>(status.st_size);
+    mapping = ::mmap(nullptr, map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw systemError("Cannot map " + path, error);
+    }
+
+    const uint8_t* header = static_cast<const uint8_t*>(mapping);
+    auto reject = [&](const char* why) {
+        ::munmap(mapping, map_bytes);
+        mapping = nullptr;
+        return std::runtime_error(std::string(why) + ": " + path);
+    };
+    if (std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        throw reject("Not a sequence file");
+    }
+    if (getLE(header + 8, 4) != FILE_VERSION) {
+        throw reject("Unsupported sequence file version");
+    }
+    if (getLE(header + HEADER_CHECKSUM_AT, 4) != CRC(CRC32_ISO_HDLC).compute(header, HEADER_CHECKSUM_AT)) {
+        throw reject("Damaged sequence file header");
+    }
+    const uint64_t data_offset = getLE(header + 12, 4);
+    info.bit_count = getLE(header + 16, 8);
+    info.start_offset = getLE(header + 24, 8);
+    info.seed = getLE(header + 32, 8);
+    info.polynomial = getLE(header + 40, 8);
+    info.register_size = header[48];
+    info.configuration = header[49] ? LFSRConfiguration::Galois : LFSRConfiguration::Fibonacci;
+    info.bit_order = header[50] ? BitOrder::MsbFirst : BitOrder::LsbFirst;
+    info.checksum = getLE(header + 56, 8);
+    if (data_offset < HEADER_BYTES || data_offset % DATA_OFFSET != 0 || header[49] > 1 || header[50] > 1 ||
+        info.register_size > 64 || data_offset > map_bytes ||
+        packedBytes(info.bit_count) > map_bytes - data_offset) {
+        throw reject("Inconsistent sequence file header");
+    }
+    packed = header + data_offset;
+}
+
+SequenceFile::~SequenceFile() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, map_bytes);
+    }
+}
+
+bool SequenceFile::verifyChecksum(unsigned threads) const {
+    CRC crc(CRC64_XZ);
+    return crc.computeParallel(packed, static_cast<size_t>(packedBytes(info.bit_count)), threads) == info.checksum;
+}
+
+LFSR SequenceFile::makeGenerator() const {
+    if (info.register_size < 2 || info.configuration != LFSRConfiguration::Fibonacci) {
+        throw std::logic_error("Sequence file does not describe a Fibonacci register");
+    }
+    LFSR generator(info.register_size, info.polynomial, info.seed);
+    generator.jump(info.start_offset % generator.getMaxPeriod());
+    return generator;
+}
@@ -0,0 +1,267 @@
+#ifndef SEQUENCE_FILE_H
+#define SEQUENCE_FILE_H
+
+#include "lfsr.h"
+#include "presets.h"
+#include "crc.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct SequenceFileInfo
+ * @brief Self-describing header of a packed bit sequence file
+ *
+ * The register fields use LFSR's convention (getPolynomial(), getState())
+ * and describe where the bits came from; captures that were not generated
+ * by a known register leave register_size at 0.
+ */
+struct SequenceFileInfo {
+    uint8_t register_size = 0;     // Register size in bits (0 if unknown)
+    uint64_t polynomial = 0;       // Feedback mask below x^register_size
+    LFSRConfiguration configuration = LFSRConfiguration::Fibonacci;
+    uint64_t seed = 0;             // Register state at sequence bit 0
+    uint64_t start_offset = 0;     // Sequence bit of the first stored bit
+    BitOrder bit_order = BitOrder::LsbFirst;  // Packing of bits into bytes
+    uint64_t bit_count = 0;        // Bits stored; set by the writer
+    uint64_t checksum = 0;         // CRC-64/XZ of the packed data; set by the writer
+};
+
+/**
+ * @class BitSequenceView
+ * @brief Read-only, zero-copy view of packed bits
+ *
+ * Bit i of the view is bit first_bit + i of the packed bytes, counting in
+ * the given bit order. Views are cheap to copy and slice; the bytes must
+ * outlive them.
+ */
+class BitSequenceView {
+private:
+    const uint8_t* bytes;    // Packed data
+    uint64_t first_bit;      // Bit of bytes at index 0 of the view
+    uint64_t count;          // Bits in the view
+    bool msb_first;          // Bit 7 of each byte comes first
+
+public:
+    /**
+     * @brief Constructor
+     * @param data Packed bytes
+     * @param bits Number of bits in the view
+     * @param order Packing of bits into bytes
+     * @param offset Bits of data to skip
+     */
+    BitSequenceView(const uint8_t* data = nullptr, uint64_t bits = 0,
+                    BitOrder order = BitOrder::LsbFirst, uint64_t offset = 0)
+        : bytes(data), first_bit(offset), count(bits), msb_first(order == BitOrder::MsbFirst) {}
+
+    /**
+     * @brief Get the number of bits
+     * @return Length of the view
+     */
+    uint64_t size() const { return count; }
+
+    /**
+     * @brief Get one bit without bounds checking
+     * @param index Bit index, less than size()
+     * @return The bit
+     */
+    bool operator[](uint64_t index) const {
+        const uint64_t bit = first_bit + index;
+        const unsigned shift = msb_first ? 7 - (bit & 7) : (bit & 7);
+        return (bytes[bit >> 3] >> shift) & 1;
+    }
+
+    /**
+     * @brief Get one bit
+     * @param index Bit index
+     * @return The bit
+     * @throw std::out_of_range if index is not less than size()
+     */
+    bool at(uint64_t index) const;
+
+    /**
+     * @brief Get up to 64 consecutive bits
+     * @param index First bit
+     * @param bits Number of bits (1-64)
+     * @return The bits, the first in the LSB (as LFSR::nextBlock())
+     * @throw std::out_of_range if the range does not fit in the view
+     */
+    uint64_t extract(uint64_t index, unsigned bits) const;
+
+    /**
+     * @brief Get part of the view
+     * @param index First bit
+     * @param bits Number of bits
+     * @return View of the same bytes
+     * @throw std::out_of_range if the range does not fit in the view
+     */
+    BitSequenceView slice(uint64_t index, uint64_t bits) const;
+
+    /**
+     * @brief Count the set bits
+     * @return Number of ones in the view
+     */
+    uint64_t countOnes() const;
+
+    /**
+     * @brief Get the underlying bytes
+     * @return Packed data, starting with the byte holding bit 0 of the view
+     */
+    const uint8_t* data() const { return bytes + (first_bit >> 3); }
+
+    /**
+     * @brief Get the packing of bits into bytes
+     * @return Bit order
+     */
+    BitOrder getBitOrder() const { return msb_first ? BitOrder::MsbFirst : BitOrder::LsbFirst; }
+};
+
+/**
+ * @class SequenceFileWriter
+ * @brief Writes a packed bit sequence file
+ *
+ * File layout, all integers little-endian:
+ *
+ *     0   char[8]  "LFSRSEQ1"
+ *     8   uint32   format version (1)
+ *     12  uint32   data offset (4096)
+ *     16  uint64   bit count
+ *     24  uint64   start offset in bits
+ *     32  uint64   seed
+ *     40  uint64   polynomial
+ *     48  uint8    register size
+ *     49  uint8    configuration (0 Fibonacci, 1 Galois)
+ *     50  uint8    bit order (0 LSB first, 1 MSB first)
+ *     56  uint64   CRC-64/XZ of the packed data
+ *     124 uint32   CRC-32/ISO-HDLC of bytes 0-123
+ *
+ * Unused header bytes are zero. The packed data starts at the data
+ * offset, page-aligned so that a mapping of the file can be used in
+ * place, and takes ceil(bit count / 8) bytes; unused bits of the last
+ * byte are zero.
+ */
+class SequenceFileWriter {
+private:
+    int fd;
+    std::string path;
+    SequenceFileInfo info;
+    CRC crc;
+    uint64_t crc_register;
+    std::vector<uint8_t> buffer;    // Packed bytes not yet written
+    bool partial = false;           // The last append ended inside a byte
+    bool finished = false;
+
+    void flush();
+
+public:
+    /**
+     * @brief Constructor: create the file
+     * @param file_path Destination, replaced if it exists
+     * @param header Register description, start offset and bit order;
+     *        bit_count and checksum are ignored
+     * @throw std::runtime_error if the file cannot be created
+     */
+    SequenceFileWriter(const std::string& file_path, const SequenceFileInfo& header);
+
+    SequenceFileWriter(const SequenceFileWriter&) = delete;
+    SequenceFileWriter& operator=(const SequenceFileWriter&) = delete;
+
+    /**
+     * @brief Destructor: finish the file if finish() was not called
+     */
+    ~SequenceFileWriter();
+
+    /**
+     * @brief Append packed bits
+     * @param data Bits packed in the file's bit order
+     * @param bits Number of bits; only the last append may end inside a byte
+     * @throw std::logic_error after a partial-byte append or finish()
+     * @throw std::runtime_error on write errors
+     */
+    void append(const uint8_t* data, uint64_t bits);
+
+    /**
+     * @brief Write the header and close the file
+     * @return Header as written, with bit count and checksum
+     * @throw std::runtime_error on write errors
+     */
+    SequenceFileInfo finish();
+};
+
+/**
+ * @brief Archive part of a register's sequence
+ * @param path Destination, replaced if it exists
+ * @param generator Register at sequence bit 0, not modified
+ * @param start_offset First sequence bit to store
+ * @param bits Number of bits
+ * @return Header as written
+ * @throw std::runtime_error on write errors
+ *
+ * Bits are generated with jump-ahead and LFSR::fill(), LSB first.
+ */
+SequenceFileInfo writeSequenceFile(const std::string& path, const LFSR& generator,
+                                   uint64_t start_offset, uint64_t bits);
+
+/**
+ * @class SequenceFile
+ * @brief Memory-mapped, read-only packed bit sequence file
+ *
+ * Opening reads and checks the header only; the data is mapped, not
+ * read, so files of any size open at once and pages are faulted in as
+ * they are touched. The data checksum is checked on request.
+ */
+class SequenceFile {
+private:
+    SequenceFileInfo info;
+    void* mapping = nullptr;
+    size_t map_bytes = 0;
+    const uint8_t* packed = nullptr;
+
+public:
+    /**
+     * @brief Constructor: map a file
+     * @param path File written by SequenceFileWriter
+     * @throw std::runtime_error if the file cannot be mapped, is not a
+     *        sequence file, or has a damaged or inconsistent header
+     */
+    explicit SequenceFile(const std::string& path);
+
+    SequenceFile(const SequenceFile&) = delete;
+    SequenceFile& operator=(const SequenceFile&) = delete;
+
+    /**
+     * @brief Destructor: unmap the file
+     */
+    ~SequenceFile();
+
+    /**
+     * @brief Get the header
+     * @return Header fields
+     */
+    const SequenceFileInfo& getInfo() const { return info; }
+
+    /**
+     * @brief Get the stored bits
+     * @return View into the mapping, valid while this object exists
+     */
+    BitSequenceView bits() const {
+        return BitSequenceView(packed, info.bit_count, info.bit_order);
+    }
+
+    /**
+     * @brief Check the data against the header checksum
+     * @param threads Worker count (0 means one per hardware thread)
+     * @return true if the CRC-64 matches
+     */
+    bool verifyChecksum(unsigned threads = 0) const;
+
+    /**
+     * @brief Rebuild the register the bits were generated from
+     * @return Register at the first stored bit
+     * @throw std::logic_error if the header names no Fibonacci register
+     */
+    LFSR makeGenerator() const;
+};
+
+#endif // SEQUENCE_FILE_H
@@ -0,0 +1,243 @@
+#include "spreading_codes.h"
+#include "presets.h"
+#include "gf2poly.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// G2 delays in chips for PRN 1-32 (IS-GPS-200, Table 3-Ia)
+const uint16_t GPS_G2_DELAYS[32] = {
+    5, 6, 7, 8, 17, 18, 139, 140, 141, 251, 252, 254, 255, 256, 257, 258,
+    469, 470, 471, 472, 473, 474, 509, 512, 513, 514, 515, 516, 859, 860, 861, 862
+};
+
+inline bool packedBit(const std::vector<uint64_t>& code, uint64_t t) {
+    return (code[t / 64] >> (t % 64)) & 1;
+}
+
+// One period of the register's output, packed
+std::vector<uint64_t> packPeriod(LFSR generator, uint32_t length) {
+    std::vector<uint64_t> code((length + 63) / 64);
+    generator.fillBlocks(code.data(), code.size());
+    if (length % 64 != 0) {
+        code.back() &= (1ULL << (length % 64)) - 1;
+    }
+    return code;
+}
+
+// v[t] = u[q * t mod length]
+std::vector<uint64_t> decimate(const std::vector<uint64_t>& u, uint32_t length, uint32_t q) {
+    std::vector<uint64_t> v(u.size(), 0);
+    uint64_t source = 0;
+    for (uint32_t t = 0; t < length; t++) {
+        v[t / 64] |= uint64_t(packedBit(u, source)) << (t % 64);
+        source = (source + q) % length;
+    }
+    return v;
+}
+
+void requireMaximal(const LFSR& generator) {
+    const int n = generator.getSize();
+    if (n < 3 || n > 16) {
+        throw std::invalid_argument("Spreading code degree must be between 3 and 16");
+    }
+    // x has order exactly 2^n - 1 mod P: x^(2^n - 1) = 1, and x^((2^n - 1) / p)
+    // differs from 1 for every prime p dividing 2^n - 1
+    const uint64_t order = generator.getMaxPeriod();
+    const uint64_t polynomial = generator.getPolynomial();
+    bool maximal = gf2PowX(order, polynomial, n) == 1;
+    uint64_t rest = order;
+    for (uint64_t p = 3; maximal && rest > 1; p += 2) {
+        if (p * p > rest) {
+            p = rest;
+        }
+        if (rest % p == 0) {
+            maximal = gf2PowX(order / p, polynomial, n) != 1;
+            while (rest % p == 0) {
+                rest /= p;
+            }
+        }
+    }
+    if (!maximal) {
+        throw std::invalid_argument("Spreading code polynomial does not give period 2^n - 1");
+    }
+}
+
+} // namespace
+
+SpreadingCodeFamily::SpreadingCodeFamily(uint32_t period, int32_t bound)
+    : length(period), words_per_code((period + 63) / 64), code_count(0),
+      correlation_bound(bound) {
+}
+
+void SpreadingCodeFamily::addCode(const std::vector<uint64_t>& code) {
+    chips.insert(chips.end(), code.begin(), code.end());
+    code_count++;
+}
+
+void SpreadingCodeFamily::addShiftedSum(const std::vector<uint64_t>& u,
+                                        const std::vector<uint64_t>& v, uint32_t shift) {
+    const size_t base = chips.size();
+    chips.resize(base + words_per_code);
+    uint32_t position = shift;
+    for (size_t w = 0; w < words_per_code; w++) {
+        chips[base + w] = u[w] ^ readChips(v.data(), position);
+        position = static_cast<uint32_t>((position + 64) % length);
+    }
+    if (length % 64 != 0) {
+        chips.back() &= (1ULL << (length % 64)) - 1;
+    }
+    code_count++;
+}
+
+uint64_t SpreadingCodeFamily::readChips(const uint64_t* code, uint32_t position) const {
+    uint64_t value = 0;
+    uint32_t filled = 0;
+    while (true) {
+        const size_t word = position / 64;
+        const uint32_t bit = position % 64;
+        uint64_t bits = code[word] >> bit;
+        if (bit != 0 && word + 1 < words_per_code) {
+            bits |= code[word + 1] << (64 - bit);
+        }
+        const uint32_t available = length - position;
+        if (available >= 64 - filled) {
+            return value | (bits << filled);
+        }
+        // The period ends inside this window: continue from chip 0
+        value |= (bits & ((1ULL << available) - 1)) << filled;
+        filled += available;
+        position = 0;
+    }
+}
+
+SpreadingCodeFamily SpreadingCodeFamily::goldFromPair(const std::vector<uint64_t>& u,
+                                                      const std::vector<uint64_t>& v, int degree) {
+    const uint32_t period = (1u << degree) - 1;
+    SpreadingCodeFamily family(period, (1 << ((degree + 2) / 2)) + 1);
+    family.chips.reserve((size_t(period) + 2) * family.words_per_code);
+    family.addCode(u);
+    family.addCode(v);
+    for (uint32_t shift = 0; shift < period; shift++) {
+        family.addShiftedSum(u, v, shift);
+    }
+    return family;
+}
+
+SpreadingCodeFamily SpreadingCodeFamily::gold(const LFSR& first, const LFSR& second) {
+    requireMaximal(first);
+    requireMaximal(second);
+    if (first.getSize() != second.getSize()) {
+        throw std::invalid_argument("Gold code generators must have the same degree");
+    }
+    const uint32_t period = static_cast<uint32_t>(first.getMaxPeriod());
+    return goldFromPair(packPeriod(first, period), packPeriod(second, period), first.getSize());
+}
+
+SpreadingCodeFamily SpreadingCodeFamily::gold(int degree) {
+    if (degree < 3 || degree > 16 || degree % 4 == 0) {
+        throw std::invalid_argument("Gold codes need a degree in [3, 16] that is not a multiple of 4");
+    }
+    // Decimation by 2^k + 1 gives a preferred pair when gcd(n, k) is 1
+    // (odd n, k = 1) or 2 (n = 2 mod 4, k = 2)
+    LFSR first(static_cast<uint8_t>(degree));
+    const uint32_t period = static_cast<uint32_t>(first.getMaxPeriod());
+    const std::vector<uint64_t> u = packPeriod(first, period);
+    return goldFromPair(u, decimate(u, period, degree % 2 ? 3 : 5), degree);
+}
+
+SpreadingCodeFamily SpreadingCodeFamily::kasami(int degree) {
+    if (degree < 4 || degree > 16 || degree % 2 != 0) {
+        throw std::invalid_argument("Kasami codes need an even degree in [4, 16]");
+    }
+    LFSR generator(static_cast<uint8_t>(degree));
+    const uint32_t period = static_cast<uint32_t>(generator.getMaxPeriod());
+    const uint32_t half = (1u << (degree / 2)) - 1;
+    const std::vector<uint64_t> u = packPeriod(generator, period);
+    // The decimated sequence repeats every 2^(n/2) - 1 chips
+    const std::vector<uint64_t> w = decimate(u, period, half + 2);
+
+    SpreadingCodeFamily family(period, static_cast<int32_t>(half) + 2);
+    family.chips.reserve((size_t(half) + 1) * family.words_per_code);
+    family.addCode(u);
+    for (uint32_t shift = 0; shift < half; shift++) {
+        family.addShiftedSum(u, w, shift);
+    }
+    return family;
+}
+
+SpreadingCodeFamily SpreadingCodeFamily::gpsCA() {
+    LFSRPreset g1 = {"GPS-G1", "GPS C/A G1, 1 + x^3 + x^10",
+                     10, (1ULL << 2) | (1ULL << 9), LFSRConfiguration::Fibonacci,
+                     OutputTap::LastStage, 0x3FF, BitOrder::LsbFirst, false, {}};
+    LFSRPreset g2 = {"GPS-G2", "GPS C/A G2, 1 + x^2 + x^3 + x^6 + x^8 + x^9 + x^10",
+                     10, 0x3A6, LFSRConfiguration::Fibonacci,
+                     OutputTap::LastStage, 0x3FF, BitOrder::LsbFirst, false, {}};
+    const uint32_t period = 1023;
+    const std::vector<uint64_t> u = packPeriod(makeLFSR(g1), period);
+    const std::vector<uint64_t> v = packPeriod(makeLFSR(g2), period);
+
+    SpreadingCodeFamily family(period, 65);
+    family.chips.reserve(32 * family.words_per_code);
+    for (uint16_t delay : GPS_G2_DELAYS) {
+        // G2 delayed by d chips: v[t - d] = v[t + period - d]
+        family.addShiftedSum(u, v, period - delay);
+    }
+    return family;
+}
+
+bool SpreadingCodeFamily::getChip(size_t index, uint64_t chip) const {
+    chip %= length;
+    return (getCode(index)[chip / 64] >> (chip % 64)) & 1;
+}
+
+void SpreadingCodeFamily::fill(size_t index, uint64_t chip_offset, uint64_t* out, size_t words) const {
+    const uint64_t* code = getCode(index);
+    uint32_t position = static_cast<uint32_t>(chip_offset % length);
+    for (size_t w = 0; w < words; w++) {
+        out[w] = readChips(code, position);
+        position = static_cast<uint32_t>((position + 64) % length);
+    }
+}
+
+std::vector<int32_t> SpreadingCodeFamily::correlate(size_t a, size_t b) const {
+    const uint64_t* first = getCode(a);
+    const uint64_t* second = getCode(b);
+    const uint64_t last_mask = (length % 64) ? (1ULL << (length % 64)) - 1 : ~0ULL;
+    std::vector<int32_t> result(length);
+
+    for (uint32_t shift = 0; shift < length; shift++) {
+        int32_t differing = 0;
+        uint32_t position = shift;
+        for (size_t w = 0; w < words_per_code; w++) {
+            uint64_t diff = first[w] ^ readChips(second, position);
+            if (w + 1 == words_per_code) diff &= last_mask;
+            differing += __builtin_popcountll(diff);
+            position = static_cast<uint32_t>((position + 64) % length);
+        }
+        result[shift] = static_cast<int32_t>(length) - 2 * differing;
+    }
+    return result;
+}
+
+int32_t SpreadingCodeFamily::peakCorrelation(size_t a, size_t b) const {
+    const std::vector<int32_t> values = correlate(a, b);
+    int32_t peak = 0;
+    for (uint32_t shift = (a == b) ? 1 : 0; shift < length; shift++) {
+        peak = std::max(peak, std::abs(values[shift]));
+    }
+    return peak;
+}
+
+bool SpreadingCodeFamily::verifyCorrelation() const {
+    for (size_t a = 0; a < code_count; a++) {
+        for (size_t b = a; b < code_count; b++) {
+            if (peakCorrelation(a, b) > correlation_bound) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
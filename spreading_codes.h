@@ -0,0 +1,179 @@
+#ifndef SPREADING_CODES_H
+#define SPREADING_CODES_H
+
+#include "lfsr.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class SpreadingCodeFamily
+ * @brief Gold and Kasami code families as packed chip sequences
+ *
+ * Every code of a family is a period of 2^n - 1 chips stored in
+ * ceil(length / 64) words, chip t in bit t % 64 of word t / 64, with the
+ * unused bits of the last word zero. A chip value of 0 stands for +1 and
+ * 1 for -1, so the periodic correlation of two codes is the length minus
+ * twice the number of differing chips.
+ *
+ * Members are XORs of an m-sequence with shifts of a second sequence;
+ * the whole family is produced at construction with word-wide XORs of
+ * the packed periods, so no per-chip register steps are involved.
+ */
+class SpreadingCodeFamily {
+private:
+    uint32_t length;             // Code period in chips, 2^n - 1
+    size_t words_per_code;       // Packed words per code
+    size_t code_count;           // Number of codes in the family
+    int32_t correlation_bound;   // Largest |correlation| the family guarantees
+    std::vector<uint64_t> chips; // All codes, words_per_code words each
+
+    SpreadingCodeFamily(uint32_t period, int32_t bound);
+
+    /**
+     * @brief Append u XOR (v advanced by shift chips) as a new code
+     */
+    void addShiftedSum(const std::vector<uint64_t>& u, const std::vector<uint64_t>& v,
+                       uint32_t shift);
+
+    /**
+     * @brief Build a Gold family from two packed m-sequence periods
+     */
+    static SpreadingCodeFamily goldFromPair(const std::vector<uint64_t>& u,
+                                            const std::vector<uint64_t>& v, int degree);
+
+    /**
+     * @brief Append a packed period as a new code
+     */
+    void addCode(const std::vector<uint64_t>& code);
+
+    /**
+     * @brief Read 64 chips of a periodic code starting at a position
+     * @param code Packed period
+     * @param position First chip, below the period
+     * @return Chips position .. position + 63, wrapping around the period
+     */
+    uint64_t readChips(const uint64_t* code, uint32_t position) const;
+
+public:
+    /**
+     * @brief Gold family from a preferred pair of m-sequences
+     * @param first Generator of the first m-sequence
+     * @param second Generator of the second m-sequence, same degree
+     * @return 2^n + 1 codes: first, second, then first XOR second
+     *         advanced by 0 .. 2^n - 2 chips
+     * @throw std::invalid_argument if the degrees differ or are not in
+     *        [3, 16], or a polynomial does not give period 2^n - 1
+     *
+     * The correlation bound holds only for preferred pairs; the caller
+     * is responsible for choosing one (see verifyCorrelation()).
+     */
+    static SpreadingCodeFamily gold(const LFSR& first, const LFSR& second);
+
+    /**
+     * @brief Gold family of a given degree
+     * @param degree Register length, 3-16 and not a multiple of 4
+     * @return Family built from the default m-sequence and its
+     *         decimation by 3 (odd degree) or 5 (degree 2 mod 4)
+     * @throw std::invalid_argument if degree is unsupported
+     */
+    static SpreadingCodeFamily gold(int degree);
+
+    /**
+     * @brief Small Kasami family
+     * @param degree Even register length, 4-16
+     * @return 2^(n/2) codes: the m-sequence, then its XOR with each shift
+     *         of its decimation by 2^(n/2) + 1
+     * @throw std::invalid_argument if degree is unsupported
+     */
+    static SpreadingCodeFamily kasami(int degree);
+
+    /**
+     * @brief GPS L1 C/A codes
+     * @return 32 codes of 1023 chips; code i is PRN i + 1
+     *
+     * G1 = 1 + x^3 + x^10 and G2 = 1 + x^2 + x^3 + x^6 + x^8 + x^9 + x^10,
+     * both started from all ones, with the G2 delays of IS-GPS-200.
+     */
+    static SpreadingCodeFamily gpsCA();
+
+    /**
+     * @brief Get number of codes
+     * @return Family size
+     */
+    size_t getCodeCount() const { return code_count; }
+
+    /**
+     * @brief Get code period
+     * @return Chips per code
+     */
+    uint32_t getLength() const { return length; }
+
+    /**
+     * @brief Get packed code size
+     * @return Words per code
+     */
+    size_t getWordsPerCode() const { return words_per_code; }
+
+    /**
+     * @brief Get one packed code
+     * @param index Code index
+     * @return getWordsPerCode() words
+     */
+    const uint64_t* getCode(size_t index) const { return &chips[index * words_per_code]; }
+
+    /**
+     * @brief Get all codes at once
+     * @return getCodeCount() packed codes, back to back
+     */
+    const std::vector<uint64_t>& getPackedCodes() const { return chips; }
+
+    /**
+     * @brief Get a single chip
+     * @param index Code index
+     * @param chip Chip position (taken modulo the period)
+     * @return Chip bit
+     */
+    bool getChip(size_t index, uint64_t chip) const;
+
+    /**
+     * @brief Generate a packed chip stream spanning several periods
+     * @param index Code index
+     * @param chip_offset Position of the first chip
+     * @param out Destination, chip_offset + 64 * w + b in bit b of word w
+     * @param words Number of words
+     */
+    void fill(size_t index, uint64_t chip_offset, uint64_t* out, size_t words) const;
+
+    /**
+     * @brief Periodic correlation at every shift
+     * @param a First code index
+     * @param b Second code index
+     * @return Entry s is sum over t of (-1)^(a[t] XOR b[t + s])
+     */
+    std::vector<int32_t> correlate(size_t a, size_t b) const;
+
+    /**
+     * @brief Largest correlation magnitude between two codes
+     * @return Peak over all shifts, excluding shift 0 when a == b
+     */
+    int32_t peakCorrelation(size_t a, size_t b) const;
+
+    /**
+     * @brief Get the family's theoretical correlation bound
+     * @return 2^((n+1)/2) + 1 or 2^((n+2)/2) + 1 for Gold codes,
+     *         2^(n/2) + 1 for Kasami codes
+     */
+    int32_t getCorrelationBound() const { return correlation_bound; }
+
+    /**
+     * @brief Check every pair and every autocorrelation sidelobe
+     * @return true if none exceeds getCorrelationBound()
+     *
+     * Cost grows with the square of the family size; it takes seconds
+     * for families of around a thousand codes.
+     */
+    bool verifyCorrelation() const;
+};
+
+#endif // SPREADING_CODES_H
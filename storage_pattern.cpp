@@ -0,0 +1,735 @@
+#include "storage_pattern.h"
+#include "gf2poly.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define STORAGE_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STORAGE_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Alignment of I/O buffers, enough for O_DIRECT on any logical block size
+constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+#ifdef STORAGE_HAVE_IO_URING
+
+// Minimal io_uring submission and completion queues for reads and writes
+class IORing {
+private:
+    int ring_fd = -1;
+    void* sq_map = MAP_FAILED;
+    void* cq_map = MAP_FAILED;
+    void* sqe_map = MAP_FAILED;
+    size_t sq_bytes = 0, cq_bytes = 0, sqe_bytes = 0;
+    unsigned *sq_tail = nullptr, *sq_mask = nullptr, *sq_array = nullptr;
+    unsigned *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned pending = 0;  // Prepared but not yet submitted
+
+public:
+    IORing() = default;
+    IORing(const IORing&) = delete;
+    IORing& operator=(const IORing&) = delete;
+
+    ~IORing() {
+        if (sqe_map != MAP_FAILED) ::munmap(sqe_map, sqe_bytes);
+        if (cq_map != MAP_FAILED) ::munmap(cq_map, cq_bytes);
+        if (sq_map != MAP_FAILED) ::munmap(sq_map, sq_bytes);
+        if (ring_fd >= 0) ::close(ring_fd);
+    }
+
+    // Set up a ring with room for entries requests; false if unsupported
+    bool open(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0) {
+            return false;
+        }
+        sq_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqe_bytes = params.sq_entries * sizeof(io_uring_sqe);
+        sq_map = ::mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd, IORING_OFF_SQ_RING);
+        cq_map = ::mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd, IORING_OFF_CQ_RING);
+        sqe_map = ::mmap(nullptr, sqe_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring_fd, IORING_OFF_SQES);
+        if (sq_map == MAP_FAILED || cq_map == MAP_FAILED || sqe_map == MAP_FAILED) {
+            return false;
+        }
+        uint8_t* sq = static_cast<uint8_t*>(sq_map);
+        uint8_t* cq = static_cast<uint8_t*>(cq_map);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        sqes = static_cast<io_uring_sqe*>(sqe_map);
+        return true;
+    }
+
+    // Queue a read or write; the caller keeps no more requests in flight
+    // than entries
+    void prepare(bool write, int fd, void* data, unsigned len, uint64_t offset, uint64_t tag) {
+        const unsigned tail = *sq_tail;
+        const unsigned index = tail & *sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = len;
+        sqe.off = offset;
+        sqe.user_data = tag;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        pending++;
+    }
+
+    // Submit queued writes, blocking until at least wait have completed
+    void submit(unsigned wait) {
+        while (pending > 0 || wait > 0) {
+            long result = ::syscall(__NR_io_uring_enter, ring_fd, pending, wait,
+                                    wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw systemError("io_uring_enter failed", errno);
+            }
+            pending -= static_cast<unsigned>(result);
+            wait = 0;
+        }
+    }
+
+    // Take one completion if there is one
+    bool reap(uint64_t& tag, int& result) {
+        const unsigned head = *cq_head;
+        if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        const io_uring_cqe& cqe = cqes[head & *cq_mask];
+        tag = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+
+#else
+
+// Stand-in where io_uring is unavailable; open() always fails
+class IORing {
+public:
+    bool open(unsigned) { return false; }
+    void prepare(bool, int, void*, unsigned, uint64_t, uint64_t) {}
+    void submit(unsigned) {}
+    bool reap(uint64_t&, int&) { return false; }
+};
+
+#endif // STORAGE_HAVE_IO_URING
+
+struct FreeDeleter {
+    void operator()(void* p) const { std::free(p); }
+};
+
+using Buffer = std::unique_ptr<uint8_t, FreeDeleter>;
+
+// Open for direct I/O if asked and supported, else through the page cache
+int openStorage(const std::string& path, int flags, bool direct, bool& used_direct) {
+    int fd = -1;
+    used_direct = false;
+    if (direct) {
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        used_direct = fd >= 0;
+    }
+    if (fd < 0) {
+        // tmpfs and some network file systems reject O_DIRECT
+        fd = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        throw systemError("Cannot open " + path, errno);
+    }
+    return fd;
+}
+
+std::vector<Buffer> allocateBuffers(size_t count, size_t bytes) {
+    std::vector<Buffer> buffers;
+    for (size_t i = 0; i < count; i++) {
+        void* buffer = std::aligned_alloc(BUFFER_ALIGNMENT, bytes);
+        if (buffer == nullptr) {
+            throw std::bad_alloc();
+        }
+        buffers.emplace_back(static_cast<uint8_t*>(buffer));
+    }
+    return buffers;
+}
+
+// Read up to len bytes with pread(), stopping early only at end of file.
+// Under O_DIRECT any short read is the end of the file: the next pread()
+// would start off-alignment and fail with EINVAL
+size_t readAll(int fd, uint8_t* data, size_t len, uint64_t offset, bool direct) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t got = ::pread(fd, data + total, len - total, static_cast<off_t>(offset + total));
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Read failed", errno);
+        }
+        if (got == 0) {
+            break;
+        }
+        total += static_cast<size_t>(got);
+        if (direct && total < len) {
+            break;
+        }
+    }
+    return total;
+}
+
+bool blocksEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+    return std::memcmp(a, b, len) == 0;
+}
+
+#ifdef STORAGE_HAVE_AVX2
+
+// Blocks are nearly always equal, so accumulate differences without
+// branching and test once at the end
+__attribute__((target("avx2")))
+bool blocksEqualAVX2(const uint8_t* a, const uint8_t* b, size_t len) {
+    __m256i diff = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const __m256i* x = reinterpret_cast<const __m256i*>(a + i);
+        const __m256i* y = reinterpret_cast<const __m256i*>(b + i);
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(_mm256_loadu_si256(x), _mm256_loadu_si256(y)));
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(_mm256_loadu_si256(x + 1), _mm256_loadu_si256(y + 1)));
+    }
+    return _mm256_testz_si256(diff, diff) && blocksEqual(a + i, b + i, len - i);
+}
+
+#endif // STORAGE_HAVE_AVX2
+
+// Word of a block as stored, little-endian
+uint64_t loadWord(const uint8_t* block, size_t index) {
+    uint64_t word;
+    std::memcpy(&word, block + 8 * index, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// Append a fault, extending the last range when it continues it
+void addFault(std::vector<StorageFault>& faults, const StorageFault& fault) {
+    if (!faults.empty()) {
+        StorageFault& last = faults.back();
+        if (last.kind == fault.kind && last.offset + last.bytes == fault.offset &&
+            (fault.kind != StorageFaultKind::Misplaced ||
+             last.source_offset + last.bytes == fault.source_offset)) {
+            last.bytes += fault.bytes;
+            return;
+        }
+    }
+    faults.push_back(fault);
+}
+
+void validateRequests(uint64_t offset, uint64_t bytes, size_t block_bytes, const StorageIOOptions& options) {
+    if (offset % block_bytes != 0 || bytes % block_bytes != 0) {
+        throw std::invalid_argument("Offset and length must be multiples of the block size");
+    }
+    if (options.io_bytes == 0 || options.io_bytes % block_bytes != 0 || options.queue_depth == 0) {
+        throw std::invalid_argument("Request size must be a multiple of the block size and queue depth non-zero");
+    }
+}
+
+} // namespace
+
+
+StoragePattern::StoragePattern(uint64_t pattern_seed, size_t block_bytes)
+    : source(LFSR::makeDefaultSource(pattern_seed)),
+      seed(pattern_seed), block_words(block_bytes / 8), use_avx2(false) {
+
+    if (block_bytes == 0 || block_bytes % 512 != 0) {
+        throw std::invalid_argument("Block size must be a non-zero multiple of 512 bytes");
+    }
+
+    // Row i of the Hankel matrix holds sequence bits a_i .. a_{i+63}; a
+    // state v at sequence position t satisfies v = H * (x^t mod P), so
+    // the inverse maps states back to powers of x
+    LFSR ahead = source;
+    const uint64_t low = source.getState();
+    const uint64_t high = ahead.nextBlock();
+    uint64_t rows[64];
+    for (int i = 0; i < 64; i++) {
+        rows[i] = i == 0 ? low : (low >> i) | (high << (64 - i));
+        state_to_power[i] = 1ULL << i;
+    }
+    for (int column = 0; column < 64; column++) {
+        int pivot = column;
+        while (((rows[pivot] >> column) & 1) == 0) {
+            pivot++;
+        }
+        std::swap(rows[pivot], rows[column]);
+        std::swap(state_to_power[pivot], state_to_power[column]);
+        for (int i = 0; i < 64; i++) {
+            if (i != column && ((rows[i] >> column) & 1)) {
+                rows[i] ^= rows[column];
+                state_to_power[i] ^= state_to_power[column];
+            }
+        }
+    }
+#ifdef STORAGE_HAVE_AVX2
+    use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+void StoragePattern::generate(uint64_t first_block, void* out, size_t blocks) const {
+    LFSR stream = source;
+    stream.jumpBytes(first_block * block_words * 8);
+
+    uint64_t* words = static_cast<uint64_t*>(out);
+    for (size_t b = 0; b < blocks; b++, words += block_words) {
+        stream.fillBlocks(words, block_words);
+        words[0] = first_block + b;
+        words[1] = seed;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        for (size_t i = 0; i < block_words; i++) {
+            words[i] = __builtin_bswap64(words[i]);
+        }
+#endif
+    }
+}
+
+bool StoragePattern::locateBlock(const void* data, uint64_t& block) const {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const uint64_t state = loadWord(bytes, 2);
+
+    // Cheap filter: pattern words follow the register recurrence
+    LFSR probe = source;
+    uint64_t successor;
+    if (state == 0) {
+        return false;
+    }
+    probe.setState(state);
+    probe.fillBlocks(&successor, 1);
+    if (successor != loadWord(bytes, 3)) {
+        return false;
+    }
+
+    uint64_t power = 0;
+    for (int i = 0; i < 64; i++) {
+        power |= static_cast<uint64_t>(__builtin_parityll(state_to_power[i] & state)) << i;
+    }
+    // Stream word m ends at sequence position 64 * (m + 1)
+    const uint64_t position = gf2LogX(power, source.getPolynomial(), 64);
+    if (position == 0 || position % 64 != 0) {
+        return false;
+    }
+    const uint64_t word = position / 64 - 1;
+    if (word % block_words != 2) {
+        return false;
+    }
+
+    std::vector<uint64_t> expected(block_words);
+    generate(word / block_words, expected.data(), 1);
+    if (!blocksEqual(bytes, reinterpret_cast<const uint8_t*>(expected.data()), getBlockBytes())) {
+        return false;
+    }
+    block = word / block_words;
+    return true;
+}
+
+StorageWriteResult StoragePattern::writeFile(const std::string& path, uint64_t offset, uint64_t bytes,
+                                             const StorageIOOptions& options) const {
+    const size_t block_bytes = getBlockBytes();
+    validateRequests(offset, bytes, block_bytes, options);
+
+    const auto start = std::chrono::steady_clock::now();
+    StorageWriteResult result{0, 0.0, false, false};
+    const int fd = openStorage(path, O_WRONLY | O_CREAT, options.direct, result.used_direct);
+
+    const uint64_t requests = (bytes + options.io_bytes - 1) / options.io_bytes;
+    const size_t slots = static_cast<size_t>(std::min<uint64_t>(options.queue_depth, std::max<uint64_t>(1, requests)));
+    std::vector<Buffer> buffers;
+    try {
+        buffers = allocateBuffers(slots, options.io_bytes);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    IORing ring;
+    result.used_io_uring = options.use_io_uring && ring.open(static_cast<unsigned>(slots));
+
+    // Generators fill free buffers with any pending request; the calling
+    // thread submits them as they become ready and recycles the buffers
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<size_t> free_slots;
+    std::deque<std::pair<size_t, uint64_t>> ready;
+    uint64_t next_request = 0;
+    bool stop = false;
+    for (size_t i = 0; i < slots; i++) {
+        free_slots.push_back(i);
+    }
+
+    auto requestBytes = [&](uint64_t request) {
+        return static_cast<size_t>(std::min<uint64_t>(options.io_bytes, bytes - request * options.io_bytes));
+    };
+    auto generator = [&]() {
+        for (;;) {
+            size_t slot;
+            uint64_t request;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&] { return stop || next_request >= requests || !free_slots.empty(); });
+                if (stop || next_request >= requests) {
+                    return;
+                }
+                slot = free_slots.front();
+                free_slots.pop_front();
+                request = next_request++;
+            }
+            const uint64_t position = offset + request * options.io_bytes;
+            generate(position / block_bytes, buffers[slot].get(), requestBytes(request) / block_bytes);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ready.emplace_back(slot, request);
+            }
+            changed.notify_all();
+        }
+    };
+    auto release = [&](size_t slot) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            free_slots.push_back(slot);
+        }
+        changed.notify_all();
+    };
+
+    unsigned thread_count = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = static_cast<unsigned>(std::min<uint64_t>(thread_count, std::max<uint64_t>(1, requests)));
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < thread_count && requests > 0; i++) {
+        workers.emplace_back(generator);
+    }
+
+    std::vector<uint64_t> slot_request(slots);
+    size_t in_flight = 0;
+    try {
+        uint64_t completed = 0;
+        while (completed < requests) {
+            std::deque<std::pair<size_t, uint64_t>> batch;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (in_flight == 0) {
+                    changed.wait(guard, [&] { return !ready.empty(); });
+                }
+                batch.swap(ready);
+            }
+            for (const auto& item : batch) {
+                const size_t slot = item.first;
+                const uint64_t request = item.second;
+                const uint64_t position = offset + request * options.io_bytes;
+                if (result.used_io_uring) {
+                    slot_request[slot] = request;
+                    ring.prepare(true, fd, buffers[slot].get(), static_cast<unsigned>(requestBytes(request)),
+                                 position, slot);
+                    in_flight++;
+                } else {
+                    writeAll(fd, buffers[slot].get(), requestBytes(request), position);
+                    result.bytes_written += requestBytes(request);
+                    completed++;
+                    release(slot);
+                }
+            }
+            if (result.used_io_uring) {
+                // Block for a completion only when there was nothing new to submit
+                ring.submit(batch.empty() ? 1 : 0);
+                uint64_t tag;
+                int status;
+                while (ring.reap(tag, status)) {
+                    const size_t slot = static_cast<size_t>(tag);
+                    const uint64_t request = slot_request[slot];
+                    const size_t len = requestBytes(request);
+                    in_flight--;
+                    if (status < 0) {
+                        throw systemError("Write failed", -status);
+                    }
+                    if (static_cast<size_t>(status) < len) {
+                        // Finish a short write synchronously
+                        writeAll(fd, buffers[slot].get() + status, len - status,
+                                 offset + request * options.io_bytes + status);
+                    }
+                    result.bytes_written += len;
+                    completed++;
+                    release(slot);
+                }
+            }
+        }
+        if (options.sync && ::fdatasync(fd) != 0) {
+            throw systemError("Sync failed", errno);
+        }
+    } catch (...) {
+        // The kernel may still be reading the buffers of queued writes
+        try {
+            uint64_t tag;
+            int status;
+            for (; in_flight > 0; in_flight--) {
+                while (!ring.reap(tag, status)) {
+                    ring.submit(1);
+                }
+            }
+        } catch (...) {
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        changed.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        ::close(fd);
+        throw;
+    }
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    ::close(fd);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+StorageVerifyResult StoragePattern::verifyFile(const std::string& path, uint64_t offset, uint64_t bytes,
+                                               const StorageIOOptions& options) const {
+    const size_t block_bytes = getBlockBytes();
+    validateRequests(offset, bytes, block_bytes, options);
+
+    const auto start = std::chrono::steady_clock::now();
+    StorageVerifyResult result{bytes, 0, {}, 0.0, false, false};
+    const int fd = openStorage(path, O_RDONLY, options.direct, result.used_direct);
+
+    const uint64_t requests = (bytes + options.io_bytes - 1) / options.io_bytes;
+    const size_t slots = static_cast<size_t>(std::min<uint64_t>(options.queue_depth, std::max<uint64_t>(1, requests)));
+    std::vector<Buffer> buffers;
+    try {
+        buffers = allocateBuffers(slots, options.io_bytes);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    IORing ring;
+    result.used_io_uring = options.use_io_uring && ring.open(static_cast<unsigned>(slots));
+
+    // The calling thread keeps reads in flight; checkers regenerate the
+    // expected data for each filled buffer and hand the buffer back
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<size_t> free_slots, filled;
+    std::vector<uint64_t> slot_request(slots);
+    std::vector<size_t> slot_bytes(slots);
+    bool reading_done = false;
+    for (size_t i = 0; i < slots; i++) {
+        free_slots.push_back(i);
+    }
+
+    auto requestBytes = [&](uint64_t request) {
+        return static_cast<size_t>(std::min<uint64_t>(options.io_bytes, bytes - request * options.io_bytes));
+    };
+    auto compare = [&](const uint8_t* a, const uint8_t* b) {
+#ifdef STORAGE_HAVE_AVX2
+        if (use_avx2) {
+            return blocksEqualAVX2(a, b, block_bytes);
+        }
+#endif
+        return blocksEqual(a, b, block_bytes);
+    };
+
+    unsigned thread_count = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = static_cast<unsigned>(std::min<uint64_t>(thread_count, std::max<uint64_t>(1, requests)));
+    std::vector<std::vector<StorageFault>> thread_faults(thread_count);
+
+    auto checker = [&](size_t index) {
+        std::vector<uint64_t> expected(options.io_bytes / 8);
+        const uint8_t* reference = reinterpret_cast<const uint8_t*>(expected.data());
+        for (;;) {
+            size_t slot;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&] { return reading_done || !filled.empty(); });
+                if (filled.empty()) {
+                    return;
+                }
+                slot = filled.front();
+                filled.pop_front();
+            }
+            const uint64_t first_block = (offset + slot_request[slot] * options.io_bytes) / block_bytes;
+            const size_t count = requestBytes(slot_request[slot]) / block_bytes;
+            const uint8_t* data = buffers[slot].get();
+            generate(first_block, expected.data(), count);
+            for (size_t k = 0; k < count; k++) {
+                const uint64_t block = first_block + k;
+                const uint8_t* actual = data + k * block_bytes;
+                StorageFault fault{block * block_bytes, block_bytes, StorageFaultKind::Corrupt, 0};
+                uint64_t source_block;
+                if ((k + 1) * block_bytes > slot_bytes[slot]) {
+                    fault.kind = StorageFaultKind::Missing;
+                } else if (compare(actual, reference + k * block_bytes)) {
+                    continue;
+                } else if (locateBlock(actual, source_block) && source_block != block) {
+                    fault.kind = StorageFaultKind::Misplaced;
+                    fault.source_offset = source_block * block_bytes;
+                }
+                addFault(thread_faults[index], fault);
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                free_slots.push_back(slot);
+            }
+            changed.notify_all();
+        }
+    };
+    auto fill = [&](size_t slot, size_t got) {
+        slot_bytes[slot] = got;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            filled.push_back(slot);
+        }
+        changed.notify_all();
+    };
+    auto finish = [&]() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            reading_done = true;
+        }
+        changed.notify_all();
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < thread_count && requests > 0; i++) {
+        workers.emplace_back(checker, i);
+    }
+
+    size_t in_flight = 0;
+    try {
+        uint64_t next_request = 0;
+        while (next_request < requests || in_flight > 0) {
+            std::vector<size_t> batch;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (in_flight == 0) {
+                    changed.wait(guard, [&] { return !free_slots.empty(); });
+                }
+                while (!free_slots.empty() && next_request + batch.size() < requests) {
+                    batch.push_back(free_slots.front());
+                    free_slots.pop_front();
+                }
+            }
+            for (size_t slot : batch) {
+                const uint64_t request = next_request++;
+                const uint64_t position = offset + request * options.io_bytes;
+                slot_request[slot] = request;
+                if (result.used_io_uring) {
+                    ring.prepare(false, fd, buffers[slot].get(), static_cast<unsigned>(requestBytes(request)),
+                                 position, slot);
+                    in_flight++;
+                } else {
+                    fill(slot, readAll(fd, buffers[slot].get(), requestBytes(request), position, result.used_direct));
+                }
+            }
+            if (result.used_io_uring) {
+                ring.submit(batch.empty() ? 1 : 0);
+                uint64_t tag;
+                int status;
+                while (ring.reap(tag, status)) {
+                    const size_t slot = static_cast<size_t>(tag);
+                    const size_t len = requestBytes(slot_request[slot]);
+                    in_flight--;
+                    if (status < 0) {
+                        throw systemError("Read failed", -status);
+                    }
+                    size_t got = static_cast<size_t>(status);
+                    if (got < len && got > 0 && !result.used_direct) {
+                        // Short buffered reads stop only at end of file; confirm synchronously
+                        got += readAll(fd, buffers[slot].get() + got, len - got,
+                                       offset + slot_request[slot] * options.io_bytes + got, false);
+                    }
+                    fill(slot, got);
+                }
+            }
+        }
+    } catch (...) {
+        try {
+            uint64_t tag;
+            int status;
+            for (; in_flight > 0; in_flight--) {
+                while (!ring.reap(tag, status)) {
+                    ring.submit(1);
+                }
+            }
+        } catch (...) {
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            filled.clear();
+        }
+        finish();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        ::close(fd);
+        throw;
+    }
+
+    finish();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    ::close(fd);
+
+    std::vector<StorageFault> all;
+    for (const auto& faults : thread_faults) {
+        all.insert(all.end(), faults.begin(), faults.end());
+    }
+    std::sort(all.begin(), all.end(),
+              [](const StorageFault& a, const StorageFault& b) { return a.offset < b.offset; });
+    for (const auto& fault : all) {
+        addFault(result.faults, fault);
+        result.bad_bytes += fault.bytes;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,179 @@
+#ifndef STORAGE_PATTERN_H
+#define STORAGE_PATTERN_H
+
+#include "lfsr.h"
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct StorageIOOptions
+ * @brief How StoragePattern drives the device when writing or verifying
+ */
+struct StorageIOOptions {
+    size_t io_bytes = 1 << 20;     // Bytes per request
+    unsigned queue_depth = 32;     // Requests in flight (and I/O buffers)
+    unsigned threads = 0;          // Generator or checker threads (0 means one per hardware thread)
+    bool direct = true;            // Open with O_DIRECT, bypassing the page cache
+    bool use_io_uring = true;      // Submit through io_uring where available
+    bool sync = true;              // fdatasync() after writing
+};
+
+/**
+ * @struct StorageWriteResult
+ * @brief What StoragePattern::writeFile() did
+ */
+struct StorageWriteResult {
+    uint64_t bytes_written;  // Bytes written
+    double seconds;          // Wall time including the final sync
+    bool used_direct;        // O_DIRECT was accepted by the file system
+    bool used_io_uring;      // Requests went through io_uring, not pwrite()
+};
+
+/**
+ * @enum StorageFaultKind
+ * @brief Why a range of blocks failed verification
+ */
+enum class StorageFaultKind {
+    Corrupt,    // Content is not a pattern block, or has damaged bits
+    Misplaced,  // An intact pattern block that belongs elsewhere
+    Missing     // Beyond the end of the file
+};
+
+/**
+ * @struct StorageFault
+ * @brief Run of consecutive failing blocks of one kind
+ */
+struct StorageFault {
+    uint64_t offset;         // First byte of the run
+    uint64_t bytes;          // Length of the run
+    StorageFaultKind kind;   // What is wrong
+    uint64_t source_offset;  // Misplaced runs: where the data was meant to go
+};
+
+/**
+ * @struct StorageVerifyResult
+ * @brief What StoragePattern::verifyFile() found
+ */
+struct StorageVerifyResult {
+    uint64_t bytes_checked;             // Bytes compared
+    uint64_t bad_bytes;                 // Bytes in failing blocks
+    std::vector<StorageFault> faults;   // Failing runs, by offset
+    double seconds;                     // Wall time
+    bool used_direct;                   // O_DIRECT was accepted by the file system
+    bool used_io_uring;                 // Requests went through io_uring, not pread()
+};
+
+/**
+ * @class StoragePattern
+ * @brief Deterministic, position-tagged test data for disks and files
+ *
+ * Storage is divided into blocks of block_bytes. Block b holds 64-bit
+ * little-endian words b * W .. b * W + W - 1 of the register stream
+ * (W = block_bytes / 8), except that word 0 is replaced by b and word 1
+ * by the pattern seed. Every block is therefore unique, defeating
+ * deduplication and compression, and both its position and its content
+ * follow from the block alone: any block can be generated by jump-ahead
+ * without the data before it.
+ *
+ * writeFile() generates request-sized buffers on a pool of threads and
+ * submits them as O_DIRECT writes through io_uring, keeping queue_depth
+ * requests in flight. verifyFile() is the reverse: queued O_DIRECT reads,
+ * each buffer regenerated by jump-ahead and compared with AVX2 on a pool
+ * of checker threads. The ring is driven with the raw system calls, so no
+ * library is needed; where io_uring is unavailable each request goes
+ * through pwrite() or pread() instead.
+ *
+ * A block that does not match is located from its content alone: its
+ * third word is a state of the 64-bit register, which the inverse of the
+ * sequence's Hankel matrix maps to x^t mod P(x), and the discrete log t
+ * (gf2LogX()) gives the stream position the block was generated for. An
+ * intact block found at the wrong place is a lost or misdirected write,
+ * reported with the offset it belongs to.
+ */
+class StoragePattern {
+private:
+    LFSR source;          // Stream at block 0
+    uint64_t seed;        // Tag stored in every block
+    size_t block_words;   // 64-bit words per block
+    bool use_avx2;        // AVX2 compare is available
+    
+    // Rows of the inverse Hankel matrix: register state to x^t mod P(x)
+    std::array<uint64_t, 64> state_to_power;
+
+public:
+    /**
+     * @brief Constructor
+     * @param pattern_seed Register seed, also stored in each block
+     *        (0 means use default)
+     * @param block_bytes Block size, a multiple of 512
+     * @throw std::invalid_argument if block_bytes is invalid
+     *
+     * The register is x^64 + x^4 + x^3 + x + 1, as in ErrorChannel.
+     */
+    explicit StoragePattern(uint64_t pattern_seed = 0, size_t block_bytes = 4096);
+
+    /**
+     * @brief Generate consecutive blocks
+     * @param first_block Index of the first block
+     * @param out Destination, blocks * block_bytes bytes, 8-byte aligned
+     * @param blocks Number of blocks
+     */
+    void generate(uint64_t first_block, void* out, size_t blocks) const;
+
+    /**
+     * @brief Write the pattern into part of a file or block device
+     * @param path File or device, created if missing (never truncated)
+     * @param offset First byte, a multiple of the block size
+     * @param bytes Length, a multiple of the block size
+     * @param options Request size, queue depth and threading
+     * @return Bytes written, time and the I/O path used
+     * @throw std::invalid_argument if the geometry is invalid
+     * @throw std::runtime_error if the file cannot be opened or written
+     *
+     * Block numbers are absolute, offset / block_bytes for the first one,
+     * so a file can be written in pieces or from several processes.
+     */
+    StorageWriteResult writeFile(const std::string& path, uint64_t offset, uint64_t bytes,
+                                 const StorageIOOptions& options = StorageIOOptions()) const;
+
+    /**
+     * @brief Read part of a file or device back and compare with the pattern
+     * @param path File or device
+     * @param offset First byte, a multiple of the block size
+     * @param bytes Length, a multiple of the block size
+     * @param options Request size, queue depth and threading
+     * @return Failing runs with their kind, and the I/O path used
+     * @throw std::invalid_argument if the geometry is invalid
+     * @throw std::runtime_error if the file cannot be opened or read
+     */
+    StorageVerifyResult verifyFile(const std::string& path, uint64_t offset, uint64_t bytes,
+                                   const StorageIOOptions& options = StorageIOOptions()) const;
+
+    /**
+     * @brief Find which block some data was generated for
+     * @param data One block of data
+     * @param block Receives the block number
+     * @return true if data is exactly the pattern of some block
+     *
+     * Uses the content after the header only, by discrete logarithm, then
+     * checks the whole block including the header.
+     */
+    bool locateBlock(const void* data, uint64_t& block) const;
+
+    /**
+     * @brief Get block size
+     * @return Bytes per block
+     */
+    size_t getBlockBytes() const { return block_words * 8; }
+
+    /**
+     * @brief Get pattern seed
+     * @return Seed stored in word 1 of every block
+     */
+    uint64_t getSeed() const { return seed; }
+};
+
+#endif // STORAGE_PATTERN_H
@@ -0,0 +1,213 @@
+#include "stream_output.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+// Pipe capacity requested before streaming
+constexpr int PIPE_BYTES = 1 << 20;
+
+// Buffer size when the destination is not a pipe
+constexpr size_t DEFAULT_BUFFER_BYTES = 1 << 20;
+
+// Page-aligned anonymous buffers, unmapped when the stream ends
+struct BufferSet {
+    std::vector<uint8_t*> data;
+    size_t bytes;
+
+    explicit BufferSet(size_t buffer_bytes) : bytes(buffer_bytes) {}
+    ~BufferSet() {
+        for (uint8_t* buffer : data) {
+            ::munmap(buffer, bytes);
+        }
+    }
+
+    static uint8_t* map(size_t len) {
+        void* buffer = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffer == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return static_cast<uint8_t*>(buffer);
+    }
+
+    // Gifted pages belong to the pipe and its readers, which may splice or
+    // tee them onward and see later writes; swap in fresh pages instead
+    void replace(size_t slot) {
+        uint8_t* fresh = map(bytes);
+        ::munmap(data[slot], bytes);
+        data[slot] = fresh;
+    }
+};
+
+// Bytes handed over, or -1 with errno set
+ssize_t handOver(int fd, const uint8_t* data, size_t len, bool& splice) {
+#ifdef SPLICE_F_GIFT
+    if (splice) {
+        iovec chunk{const_cast<uint8_t*>(data), len};
+        ssize_t written = ::vmsplice(fd, &chunk, 1, SPLICE_F_GIFT);
+        if (written >= 0 || (errno != EINVAL && errno != ENOSYS)) {
+            return written;
+        }
+        splice = false;
+    }
+#else
+    splice = false;
+#endif
+    return ::write(fd, data, len);
+}
+
+} // namespace
+
+StreamResult streamSequence(int fd, const LFSR& generator, uint64_t offset, uint64_t bytes,
+                            const StreamOptions& options) {
+    StreamResult result{0, false, false};
+    if (bytes == 0) {
+        return result;
+    }
+
+    struct stat info;
+    const bool is_pipe = ::fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+    bool splice = options.use_vmsplice && is_pipe;
+    size_t pipe_bytes = 0;
+    if (is_pipe) {
+        ::fcntl(fd, F_SETPIPE_SZ, PIPE_BYTES);
+        int capacity = ::fcntl(fd, F_GETPIPE_SZ);
+        pipe_bytes = capacity > 0 ? static_cast<size_t>(capacity) : 0;
+    }
+    size_t buffer_bytes = options.buffer_bytes;
+    if (buffer_bytes == 0) {
+        buffer_bytes = pipe_bytes ? pipe_bytes : DEFAULT_BUFFER_BYTES;
+    }
+    buffer_bytes = (buffer_bytes + 4095) / 4096 * 4096;
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t chunks = bytes == STREAM_UNLIMITED ? STREAM_UNLIMITED : (bytes + buffer_bytes - 1) / buffer_bytes;
+    threads = static_cast<unsigned>(std::min<uint64_t>(threads, chunks));
+    const size_t slots = threads + 1;
+    BufferSet buffers(buffer_bytes);
+    for (size_t i = 0; i < slots; i++) {
+        buffers.data.push_back(BufferSet::map(buffer_bytes));
+    }
+
+    // Generators fill free buffers with chunks in increasing order; the
+    // calling thread writes them out in order
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<size_t> free_slots;
+    std::map<uint64_t, size_t> ready;
+    uint64_t next_chunk = 0;
+    bool stop = false;
+    for (size_t i = 0; i < slots; i++) {
+        free_slots.push_back(i);
+    }
+
+    auto chunkBytes = [&](uint64_t chunk) {
+        if (bytes == STREAM_UNLIMITED) {
+            return buffer_bytes;
+        }
+        return static_cast<size_t>(std::min<uint64_t>(buffer_bytes, bytes - chunk * buffer_bytes));
+    };
+    auto generatorThread = [&]() {
+        for (;;) {
+            size_t slot;
+            uint64_t chunk;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&] { return stop || next_chunk >= chunks || !free_slots.empty(); });
+                if (stop || next_chunk >= chunks) {
+                    return;
+                }
+                slot = free_slots.front();
+                free_slots.pop_front();
+                chunk = next_chunk++;
+            }
+            LFSR stream = generator;
+            stream.jumpBytes(chunk * buffer_bytes + offset);
+            stream.fill(buffers.data[slot], chunkBytes(chunk));
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ready.emplace(chunk, slot);
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(generatorThread);
+    }
+
+    auto release = [&](size_t slot) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            free_slots.push_back(slot);
+        }
+        changed.notify_all();
+    };
+    auto shutdown = [&]() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        changed.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    };
+
+    try {
+        for (uint64_t chunk = 0; chunk < chunks && !result.reader_closed; chunk++) {
+            size_t slot;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                changed.wait(guard, [&] { return ready.count(chunk) != 0; });
+                slot = ready[chunk];
+                ready.erase(chunk);
+            }
+            const uint8_t* data = buffers.data[slot];
+            size_t len = chunkBytes(chunk);
+            bool gifted = false;
+            while (len > 0) {
+                ssize_t written = handOver(fd, data, len, splice);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == EPIPE) {
+                        result.reader_closed = true;
+                        break;
+                    }
+                    throw std::runtime_error(std::string("Stream write failed: ") + std::strerror(errno));
+                }
+                gifted = gifted || splice;
+                data += written;
+                len -= static_cast<size_t>(written);
+                result.bytes_written += static_cast<uint64_t>(written);
+            }
+            result.used_vmsplice = result.used_vmsplice || gifted;
+            if (gifted) {
+                buffers.replace(slot);
+            }
+            release(slot);
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+    shutdown();
+    return result;
+}
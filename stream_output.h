@@ -0,0 +1,59 @@
+#ifndef STREAM_OUTPUT_H
+#define STREAM_OUTPUT_H
+
+#include "lfsr.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Byte count meaning "until the reader goes away"
+ */
+constexpr uint64_t STREAM_UNLIMITED = ~0ULL;
+
+/**
+ * @struct StreamOptions
+ * @brief How streamSequence() produces and hands over data
+ */
+struct StreamOptions {
+    size_t buffer_bytes = 0;    // Bytes per buffer (0 means the pipe size, or 1 MiB)
+    unsigned threads = 0;       // Generator threads (0 means one per hardware thread)
+    bool use_vmsplice = true;   // Gift pages to pipes instead of copying
+};
+
+/**
+ * @struct StreamResult
+ * @brief What streamSequence() did
+ */
+struct StreamResult {
+    uint64_t bytes_written;  // Bytes accepted by the reader
+    bool reader_closed;      // Stopped because the reader closed (EPIPE)
+    bool used_vmsplice;      // Data went through vmsplice(), not write()
+};
+
+/**
+ * @brief Write the byte stream of a register to a file descriptor
+ * @param fd Destination: a pipe, file, socket or terminal
+ * @param generator Register at the start of the sequence, not modified
+ * @param offset Bytes of the sequence to skip first
+ * @param bytes Bytes to write, or STREAM_UNLIMITED
+ * @param options Buffering, threading and splice use
+ * @return Bytes written and how the stream ended
+ * @throw std::runtime_error on write errors other than EPIPE
+ *
+ * The bytes are those of LFSR::fill() after jumping offset bytes ahead.
+ * Page-aligned buffers are filled in parallel, each by jump-ahead to its
+ * own offset, and written in order. Into a pipe, each buffer is handed
+ * over with vmsplice(SPLICE_F_GIFT), so the reader gets the pages without
+ * a copy. Gifted pages are never written again, even after the pipe has
+ * drained, since a reader may have spliced or teed them elsewhere: the
+ * buffer is unmapped and replaced by fresh pages. Other descriptors, or
+ * kernels without vmsplice(), get write(). The pipe is enlarged to 1 MiB
+ * where the system allows it.
+ *
+ * SIGPIPE is not touched: callers that want EPIPE reported rather than
+ * the default termination must ignore the signal.
+ */
+StreamResult streamSequence(int fd, const LFSR& generator, uint64_t offset, uint64_t bytes,
+                            const StreamOptions& options = StreamOptions());
+
+#endif // STREAM_OUTPUT_H
@@ -0,0 +1,43 @@
+#include "sys_util.h"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Futex words must be lock-free");
+
+std::runtime_error systemError(const std::string& what, int error) {
+    return std::runtime_error(what + ": " + std::strerror(error));
+}
+
+void writeAll(int fd, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t written = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Write failed", errno);
+        }
+        data += written;
+        len -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+}
+
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* timeout) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void publish(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting) {
+    seq.fetch_add(1);
+    if (waiting.load()) {
+        futexWake(seq);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef SYS_UTIL_H
+#define SYS_UTIL_H
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+/**
+ * @file sys_util.h
+ * @brief System call helpers shared by the library's modules
+ *
+ * Internal to the library: error reporting for failed calls, whole-buffer
+ * writes, and the futex operations behind the shared-memory rings.
+ */
+
+/**
+ * @brief Build the exception for a failed system call
+ * @param what Description of the operation
+ * @param error errno value
+ * @return Exception whose message is what followed by strerror(error)
+ */
+std::runtime_error systemError(const std::string& what, int error);
+
+/**
+ * @brief Write a whole buffer with pwrite(), continuing after short writes
+ * @param fd File descriptor
+ * @param data Bytes to write
+ * @param len Number of bytes
+ * @param offset File offset of the first byte
+ * @throw std::runtime_error on write errors
+ */
+void writeAll(int fd, const uint8_t* data, size_t len, uint64_t offset);
+
+/**
+ * @brief Sleep while a process-shared futex word holds a value
+ * @param word Futex word, possibly in shared memory
+ * @param expected Value seen before deciding to sleep
+ * @param timeout Relative limit on the sleep (nullptr means none)
+ *
+ * Returns at once if the word no longer holds expected; callers re-check
+ * their condition afterwards, as wake-ups may be spurious.
+ */
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* timeout = nullptr);
+
+/**
+ * @brief Wake every process sleeping on a futex word
+ * @param word Futex word
+ */
+void futexWake(std::atomic<uint32_t>& word);
+
+/**
+ * @brief Bump a futex word and wake its sleepers, if any announced themselves
+ * @param seq Futex word
+ * @param waiting Set by sleepers before they wait on seq
+ */
+void publish(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting);
+
+#endif // SYS_UTIL_H
@@ -1,6 +1,1345 @@
 #include "lfsr.h"
+#include "scrambler.h"
+#include "presets.h"
+#include "prbs.h"
+#include "error_channel.h"
+#include "crc.h"
+#include "cyclic_code.h"
+#include "galois_field.h"
+#include "spreading_codes.h"
+#include "correlator.h"
+#include "despreader.h"
+#include "distributions.h"
+#include "dither.h"
+#include "permutation.h"
+#include "pointer_chase.h"
+#include "memory_test.h"
+#include "storage_pattern.h"
+#include "stream_output.h"
+#include "generator_daemon.h"
+#include "block_ring.h"
+#include "sequence_file.h"
+#include "text_format.h"
+#include "gf2poly.h"
 #include <iostream>
 #include <bitset>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+static void check(const char* name, bool passed) {
+    std::cout << name << ": " << (passed ? "PASSED" : "FAILED") << "\n";
+    if (!passed) failures++;
+}
+
+static void testBulkGeneration() {
+    std::cout << "\nTesting bulk generation:\n";
+
+    LFSR bitwise(16, 0xACE1);
+    LFSR bulk(16, 0xACE1);
+    std::vector<uint8_t> expected(1003), actual(1003);
+    for (auto& byte : expected) byte = bitwise.nextByte();
+    bulk.fill(actual.data(), actual.size());
+    check("fill() matches nextByte()", expected == actual &&
+          bulk.getState() == bitwise.getState());
+
+    LFSR stepped(12, 0x5A5);
+    LFSR jumped(12, 0x5A5);
+    for (int i = 0; i < 12345; i++) stepped.nextBit();
+    jumped.jump(12345);
+    check("jump() matches stepping", stepped.getState() == jumped.getState());
+
+    // 2^61 bytes is 2^64 bits, one step past a 64-bit register's period
+    LFSR by_bytes = LFSR::makeDefaultSource(7), by_bits = by_bytes;
+    by_bytes.jumpBytes(1ULL << 61);
+    by_bits.jump(1);
+    LFSR small_bytes(12, 0x5A5);
+    small_bytes.jumpBytes(12345);
+    jumped.jump(8 * 12345 - 12345);
+    check("jumpBytes() matches jump()", by_bytes.getState() == by_bits.getState() &&
+                                        small_bytes.getState() == jumped.getState());
+
+    // Sparse 64-bit registers use the shift kernel instead of the tables
+    LFSR serial(64, 0x1B, 0x123456789ABCDEFULL);
+    LFSR wide(64, 0x1B, 0x123456789ABCDEFULL);
+    std::vector<uint64_t> blocks(40);
+    wide.fillBlocks(blocks.data(), blocks.size());
+    bool same = true;
+    for (uint64_t block : blocks) same = same && serial.nextBlock() == block;
+    check("Shift kernel matches table kernel", same && serial.getState() == wide.getState());
+}
+
+static void testScrambler() {
+    std::cout << "\nTesting additive scrambler:\n";
+
+    std::vector<uint8_t> original(777);
+    for (size_t i = 0; i < original.size(); i++) original[i] = static_cast<uint8_t>(i * 31);
+
+    AdditiveScrambler tx(LFSR(15, 0x7FFF));
+    AdditiveScrambler rx(LFSR(15, 0x7FFF));
+    std::vector<uint8_t> data = original;
+    tx.scramble(data.data(), 300);
+    tx.scramble(data.data() + 300, data.size() - 300);
+    std::vector<uint8_t> scrambled = data;
+    rx.descramble(data.data(), data.size());
+    check("Scramble/descramble round trip", data == original && scrambled != original);
+
+    // Out-of-order processing at explicit offsets
+    std::vector<uint8_t> pieces = original;
+    tx.scrambleAt(500, pieces.data() + 500, pieces.size() - 500);
+    tx.scrambleAt(0, pieces.data(), 123);
+    tx.scrambleAt(123, pieces.data() + 123, 377);
+    check("Offset-based scrambling", pieces == scrambled);
+}
+
+static void testMultiplicativeScrambler() {
+    std::cout << "\nTesting self-synchronizing scrambler:\n";
+
+    const uint64_t poly = (1ULL << 38) | (1ULL << 57);  // 1 + x^39 + x^58
+    std::vector<uint8_t> original(203);
+    LFSR(16, 0xBEEF).fill(original.data(), original.size());
+
+    // Bit-serial reference: s[i] = d[i] ^ s[i-39] ^ s[i-58]
+    std::vector<int> line_bits(58, 1);
+    std::vector<uint8_t> expected(original.size(), 0);
+    for (size_t i = 0; i < original.size() * 8; i++) {
+        size_t n = line_bits.size();
+        int bit = ((original[i / 8] >> (i % 8)) & 1) ^ line_bits[n - 39] ^ line_bits[n - 58];
+        line_bits.push_back(bit);
+        expected[i / 8] |= static_cast<uint8_t>(bit << (i % 8));
+    }
+
+    MultiplicativeScrambler tx(poly);
+    std::vector<uint8_t> data = original;
+    tx.scramble(data.data(), 13);
+    tx.scramble(data.data() + 13, data.size() - 13);
+    check("Block scrambler matches bit-serial reference", data == expected);
+
+    // A descrambler with the wrong history recovers after the first block
+    MultiplicativeScrambler rx(poly, 0x123456789ULL);
+    rx.descramble(data.data(), data.size());
+    check("Descrambler self-synchronizes",
+          std::equal(data.begin() + 8, data.end(), original.begin() + 8));
+}
+
+static void testPresets() {
+    std::cout << "\nTesting standard presets:\n";
+
+    bool vectors_match = true;
+    for (const auto& preset : getPresets()) {
+        PresetGenerator generator(preset);
+        std::vector<uint8_t> output(preset.reference.size());
+        generator.fill(output.data(), output.size());
+        if (output != preset.reference) {
+            std::cout << "  mismatch: " << preset.name << "\n";
+            vectors_match = false;
+        }
+    }
+    check("Preset reference vectors", vectors_match);
+
+    // Jump-ahead on a preset agrees with generating through the stream
+    PresetGenerator streamed(findPreset("PRBS31"));
+    PresetGenerator skipped(findPreset("PRBS31"));
+    std::vector<uint8_t> discard(4096), expected(64), actual(64);
+    streamed.fill(discard.data(), discard.size());
+    streamed.fill(expected.data(), expected.size());
+    skipped.jump(discard.size() * 8);
+    skipped.fill(actual.data(), actual.size());
+    check("Preset jump-ahead", expected == actual);
+
+    // Custom registers: the period walk works up to 24 bits and refuses beyond
+    bool walk_refused = false;
+    try {
+        LFSR(64, LFSR::maximalPolynomial(64), 1).selfTest();
+    } catch (const std::invalid_argument&) {
+        walk_refused = true;
+    }
+    check("Custom register self-test", LFSR(20, LFSR::maximalPolynomial(20), 1).selfTest() && walk_refused);
+}
+
+static void testPRBSChecker() {
+    std::cout << "\nTesting PRBS checker:\n";
+
+    const LFSRPreset& preset = findPreset("O.150-23");
+    PresetGenerator source(preset);
+    source.jump(12345);  // Checker must not depend on the stream phase
+    std::vector<uint8_t> stream(65536);
+    source.fill(stream.data(), stream.size());
+
+    const size_t flips[] = {5000, 5001, 9000, 20000, 40000, 65000};
+    for (size_t byte : flips) stream[byte] ^= 0x10;
+
+    PRBSChecker checker(preset);
+    checker.process(stream.data(), 1001);
+    checker.process(stream.data() + 1001, stream.size() - 1001);
+    check("Checker locks and counts injected errors",
+          checker.isLocked() && checker.getBitErrors() == 6);
+
+    // A burst of unrelated data drops sync; the checker then relocks
+    std::vector<uint8_t> garbage(4096);
+    LFSR(16, 0x1234).fill(garbage.data(), garbage.size());
+    checker.process(garbage.data(), garbage.size());
+    bool lost = !checker.isLocked() && checker.getSyncLosses() == 1;
+    std::vector<uint8_t> more(8192);
+    source.fill(more.data(), more.size());
+    checker.process(more.data(), more.size());
+    check("Checker detects loss of sync and resynchronizes", lost && checker.isLocked());
+}
+
+static uint64_t countSetBits(const std::vector<uint8_t>& data) {
+    uint64_t count = 0;
+    for (uint8_t byte : data) count += __builtin_popcount(byte);
+    return count;
+}
+
+static void testErrorChannel() {
+    std::cout << "\nTesting error injection channel:\n";
+
+    std::vector<uint8_t> data(1 << 20, 0);
+    ErrorChannel channel(1e-3, 42);
+    uint64_t injected = channel.apply(data.data(), 1000);
+    injected += channel.apply(data.data() + 1000, data.size() - 1000);
+    double expected = 1e-3 * data.size() * 8;
+    check("Independent errors at requested BER",
+          injected == countSetBits(data) && injected > expected * 0.95 && injected < expected * 1.05);
+
+    // Bursty channel: average BER follows the stationary state mix
+    std::fill(data.begin(), data.end(), 0);
+    ErrorChannel bursty(1e-5, 0.1, 1e-4, 1e-2, 7);
+    injected = bursty.apply(data.data(), data.size());
+    double bad_share = 1e-4 / (1e-4 + 1e-2);
+    expected = (bad_share * 0.1 + (1 - bad_share) * 1e-5) * data.size() * 8;
+    check("Gilbert-Elliott burst errors",
+          injected == countSetBits(data) && injected > expected * 0.7 && injected < expected * 1.3);
+}
+
+// Bit-at-a-time CRC straight from the Rocksoft model definition
+static uint64_t referenceCRC(const CRCParameters& p, const uint8_t* data, size_t len) {
+    const uint64_t top = 1ULL << (p.width - 1);
+    const uint64_t mask = top | (top - 1);
+    uint64_t reg = p.init & mask;
+    for (size_t i = 0; i < len; i++) {
+        for (int b = 0; b < 8; b++) {
+            int bit = p.reflect_in ? (data[i] >> b) & 1 : (data[i] >> (7 - b)) & 1;
+            bool feedback = ((reg & top) != 0) != (bit != 0);
+            reg = (reg << 1) & mask;
+            if (feedback) reg ^= p.polynomial & mask;
+        }
+    }
+    if (p.reflect_out) {
+        uint64_t reflected = 0;
+        for (int i = 0; i < p.width; i++) reflected |= ((reg >> i) & 1) << (p.width - 1 - i);
+        reg = reflected;
+    }
+    return (reg ^ p.xor_out) & mask;
+}
+
+static void testCRC() {
+    std::cout << "\nTesting CRC engine:\n";
+
+    const CRCParameters* catalog[] = {&CRC8_SMBUS, &CRC16_ARC, &CRC16_CCITT_FALSE, &CRC32_ISO_HDLC,
+                                      &CRC32_ISCSI, &CRC32_BZIP2, &CRC64_XZ, &CRC64_ECMA_182};
+    std::vector<uint8_t> data(1500);
+    LFSR(31, 9, 77).fill(data.data(), data.size());
+
+    bool check_values = true;
+    bool matches_reference = true;
+    for (const CRCParameters* params : catalog) {
+        CRC crc(*params);
+        check_values = check_values && crc.selfTest();
+        for (size_t len : {0, 1, 15, 16, 127, 128, 200, 1500}) {
+            if (crc.compute(data.data(), len) != referenceCRC(*params, data.data(), len)) {
+                std::cout << "  mismatch: " << params->name << " length " << len << "\n";
+                matches_reference = false;
+            }
+        }
+    }
+    check("CRC catalog check values", check_values);
+    check("CRC tables and folding match bitwise model", matches_reference);
+
+    // Odd width and streaming updates
+    const CRCParameters crc12 = {"CRC-12/DECT", 12, 0x80F, 0, false, false, 0, 0xF5B};
+    CRC engine(crc12);
+    uint64_t reg = engine.update(engine.begin(), data.data(), 700);
+    reg = engine.update(reg, data.data() + 700, 800);
+    check("CRC streaming with non-byte width",
+          engine.selfTest() && engine.finish(reg) == referenceCRC(crc12, data.data(), 1500));
+}
+
+static void testCRCCombine() {
+    std::cout << "\nTesting CRC combine and parallel checksums:\n";
+
+    std::vector<uint8_t> data(1 << 20);
+    LFSR(64, 0x1B, 99).fill(data.data(), data.size());
+
+    bool combined = true;
+    for (const CRCParameters* params : {&CRC32_ISO_HDLC, &CRC32_BZIP2, &CRC64_XZ, &CRC16_CCITT_FALSE}) {
+        CRC crc(*params);
+        for (size_t split : {0, 1, 1000, 65536, 999999}) {
+            uint64_t a = crc.compute(data.data(), split);
+            uint64_t b = crc.compute(data.data() + split, data.size() - split);
+            combined = combined &&
+                crc.combine(a, b, data.size() - split) == crc.compute(data.data(), data.size());
+        }
+    }
+    check("CRC combine", combined);
+
+    CRC crc(CRC32_ISCSI);
+    uint64_t expected = crc.compute(data.data(), data.size());
+    check("Parallel CRC", crc.computeParallel(data.data(), data.size(), 5) == expected);
+
+    char path[] = "/tmp/test_lfsr_crcXXXXXX";
+    int fd = mkstemp(path);
+    bool written = fd >= 0 && write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+    if (fd >= 0) close(fd);
+    check("Memory-mapped file CRC", written && crcFile(crc, path, 3) == expected);
+    unlink(path);
+}
+
+static void testCyclicCode() {
+    std::cout << "\nTesting cyclic code encoder:\n";
+
+    // BCH(31, 21), g(x) = x^10 + x^9 + x^8 + x^6 + x^5 + x^3 + 1
+    const int n = 31, k = 21;
+    const uint64_t generator = 0x369;
+    CyclicCode code(n, k, generator);
+
+    std::vector<uint8_t> messages(1000 * code.getMessageBytes());
+    LFSR(16, 0x4321).fill(messages.data(), messages.size());
+    for (size_t i = 0; i < messages.size(); i += code.getMessageBytes()) {
+        messages[i] &= 0x1F;  // 21 bits in 3 bytes
+    }
+    std::vector<uint64_t> parities(1000);
+    code.encodeBatch(messages.data(), parities.size(), parities.data());
+
+    // Bit-serial long division of m(x) * x^10 by g(x)
+    bool matches = true;
+    for (size_t m = 0; m < parities.size(); m++) {
+        const uint8_t* message = &messages[m * code.getMessageBytes()];
+        uint64_t value = (uint64_t(message[0]) << 16) | (message[1] << 8) | message[2];
+        uint64_t remainder = value << 10;
+        for (int bit = n - 1; bit >= 10; bit--) {
+            if ((remainder >> bit) & 1) remainder ^= (generator | (1ULL << 10)) << (bit - 10);
+        }
+        matches = matches && remainder == parities[m] && code.syndrome(message, parities[m]) == 0;
+    }
+    check("BCH(31,21) parity matches long division", matches);
+
+    std::vector<uint8_t> corrupted(messages.begin(), messages.begin() + 3);
+    corrupted[1] ^= 0x04;
+    check("Syndrome detects errors", code.syndrome(corrupted.data(), parities[0]) != 0 &&
+                                     code.syndrome(messages.data(), parities[0] ^ 2) != 0);
+
+    bool rejected = false;
+    try {
+        CyclicCode invalid(31, 21, 0x36B);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check("Generator must divide x^n - 1", rejected);
+}
+
+static void testGaloisField() {
+    std::cout << "\nTesting GF(2^n) arithmetic:\n";
+
+    bool primitive = true;
+    for (uint8_t n = 3; n <= 16; n++) {
+        primitive = primitive && LFSR(n).selfTest();
+    }
+    check("Default polynomials have full period", primitive);
+
+    bool tables = true;
+    for (int n = 3; n <= 16; n++) {
+        GaloisField field(n);
+        for (uint32_t a = 1; a < field.getSize(); a += 1 + a / 64) {
+            uint16_t b = static_cast<uint16_t>((a * 2654435761u) % (field.getSize() - 1) + 1);
+            uint16_t product = field.multiply(static_cast<uint16_t>(a), b);
+            tables = tables && field.exp(field.log(static_cast<uint16_t>(a))) == a &&
+                     product == gf2MulMod(a, b, field.getPolynomial(), n) &&
+                     field.divide(product, b) == a &&
+                     field.multiply(field.inverse(b), b) == 1;
+        }
+    }
+    check("Log/antilog tables match polynomial product", tables);
+
+    GaloisField gf256(8);
+    std::vector<uint8_t> src(1000 + 13), base(src.size());
+    LFSR(16, 0x2468).fill(src.data(), src.size());
+    LFSR(16, 0x1357).fill(base.data(), base.size());
+    bool regions = true;
+    for (GFKernel kernel : {GFKernel::Scalar, GFKernel::SSSE3, GFKernel::AVX2, GFKernel::GFNI}) {
+        if (!GaloisField::isKernelSupported(kernel)) continue;
+        gf256.setKernel(kernel);
+        for (uint16_t c : {0, 1, 2, 0x53, 0xFF}) {
+            std::vector<uint8_t> product(src.size()), sum = base;
+            gf256.multiplyRegion(src.data(), product.data(), src.size(), c);
+            gf256.multiplyAddRegion(src.data(), sum.data(), src.size(), c);
+            for (size_t i = 0; i < src.size(); i++) {
+                uint8_t expected = static_cast<uint8_t>(gf256.multiply(src[i], c));
+                regions = regions && product[i] == expected && sum[i] == (base[i] ^ expected);
+            }
+        }
+    }
+    check("Region kernels match scalar multiply", regions);
+
+    GaloisField gf8(8);
+    uint8_t region[4] = {1, 2, 3, 4};
+    int refused = 0;
+    try { gf8.multiply(256, 1); } catch (const std::invalid_argument&) { refused++; }
+    try { gf8.power(300, 2); } catch (const std::invalid_argument&) { refused++; }
+    try { gf8.multiplyRegion(region, region, 4, 300); } catch (const std::invalid_argument&) { refused++; }
+    check("Non-elements are rejected", refused == 3);
+}
+
+static void testSpreadingCodes() {
+    std::cout << "\nTesting spreading code families:\n";
+
+    // First ten chips of PRN 1 and PRN 2 are 1440 and 1620 in octal
+    SpreadingCodeFamily gps = SpreadingCodeFamily::gpsCA();
+    auto firstChips = [&gps](size_t prn) {
+        int value = 0;
+        for (int t = 0; t < 10; t++) value = (value << 1) | gps.getChip(prn - 1, t);
+        return value;
+    };
+    check("GPS C/A codes match IS-GPS-200", gps.getCodeCount() == 32 &&
+                                            firstChips(1) == 01440 && firstChips(2) == 01620);
+    check("GPS C/A cross-correlation within 65", gps.verifyCorrelation());
+
+    SpreadingCodeFamily gold = SpreadingCodeFamily::gold(7);
+    SpreadingCodeFamily kasami = SpreadingCodeFamily::kasami(8);
+    check("Gold and Kasami families meet their bounds",
+          gold.getCodeCount() == 129 && gold.getCorrelationBound() == 17 && gold.verifyCorrelation() &&
+          kasami.getCodeCount() == 16 && kasami.getCorrelationBound() == 17 && kasami.verifyCorrelation());
+
+    // x^4 + x^3 + x^2 + x + 1 gives x^15 = 1 but only period 5
+    bool rejected = false;
+    try {
+        SpreadingCodeFamily::gold(LFSR(4, 0xF, 1), LFSR(4, 0x9, 1));
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check("Non-primitive polynomial is rejected", rejected);
+
+    // Packed streams continue across periods
+    std::vector<uint64_t> stream(40);
+    gps.fill(4, 1000, stream.data(), stream.size());
+    bool continuous = true;
+    for (size_t t = 0; t < stream.size() * 64; t++) {
+        continuous = continuous && ((stream[t / 64] >> (t % 64)) & 1) == gps.getChip(4, 1000 + t);
+    }
+    check("Packed chip stream spans periods", continuous);
+}
+
+static void testCorrelator() {
+    std::cout << "\nTesting m-sequence correlator:\n";
+
+    bool matches = true;
+    for (uint8_t n : {7, 10}) {
+        LFSR reference(n, 0x55);
+        MSequenceCorrelator correlator(reference);
+        const uint32_t length = correlator.getLength();
+        const size_t blocks = 11;
+
+        std::vector<int> chips(length);
+        LFSR copy = reference;
+        for (auto& chip : chips) chip = copy.nextBit() ? -1 : 1;
+
+        std::vector<float> samples(blocks * length), out(samples.size());
+        ErrorChannel noise(0.5, n);
+        for (size_t i = 0; i < samples.size(); i++) {
+            samples[i] = static_cast<float>(i % 13) - 6.0f;
+        }
+        std::vector<uint8_t> signs((samples.size() + 7) / 8);
+        noise.apply(signs.data(), signs.size());
+        for (size_t i = 0; i < samples.size(); i++) {
+            if ((signs[i / 8] >> (i % 8)) & 1) samples[i] = -samples[i];
+        }
+        correlator.correlateBatch(samples.data(), blocks, out.data());
+
+        for (size_t b = 0; b < blocks; b++) {
+            for (uint32_t tau = 0; tau < length; tau += 3) {
+                double direct = 0;
+                for (uint32_t t = 0; t < length; t++) {
+                    direct += samples[b * length + t] * chips[(t + length - tau) % length];
+                }
+                matches = matches && std::abs(direct - out[b * length + tau]) < 1e-3;
+            }
+        }
+    }
+    check("Fast transform matches direct correlation", matches);
+
+    // A received m-sequence with two echoes shows peaks at their delays
+    LFSR reference(12, 1);
+    MSequenceCorrelator correlator(reference);
+    const uint32_t length = correlator.getLength();
+    std::vector<float> chips(length), received(length), response(length);
+    for (auto& chip : chips) chip = reference.nextBit() ? -1.0f : 1.0f;
+    for (uint32_t t = 0; t < length; t++) {
+        received[t] = chips[t] + 0.5f * chips[(t + length - 9) % length];
+    }
+    correlator.correlate(received.data(), response.data());
+    check("Channel estimate recovers echo", std::abs(response[0] - (length - 0.5f)) < 0.01f &&
+                                            std::abs(response[9] - (0.5f * length - 1.0f)) < 0.01f);
+}
+
+static void testDespreader() {
+    std::cout << "\nTesting DSSS despreader:\n";
+
+    // Five GPS codes (one group of four plus one), 1023 chips per symbol
+    SpreadingCodeFamily gps = SpreadingCodeFamily::gpsCA();
+    const size_t symbols = 20, factor = gps.getLength(), codes = 5;
+    const size_t words = (symbols * factor + 63) / 64;
+    std::vector<std::vector<uint64_t>> streams(codes, std::vector<uint64_t>(words));
+    std::vector<const uint64_t*> pointers;
+    for (size_t c = 0; c < codes; c++) {
+        gps.fill(c, 0, streams[c].data(), words);
+        pointers.push_back(streams[c].data());
+    }
+    auto chip = [&streams](size_t c, size_t i) { return (streams[c][i / 64] >> (i % 64)) & 1; };
+
+    // Symbols of code 2 plus random samples
+    std::vector<uint8_t> data(symbols), noise(symbols * factor);
+    LFSR(16, 0x7777).fill(data.data(), data.size());
+    LFSR(16, 0x5A5A).fill(noise.data(), noise.size());
+    std::vector<int16_t> samples(symbols * factor);
+    std::vector<float> samples_f(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        int spread = ((data[i / factor] & 1) ^ chip(2, i)) ? -100 : 100;
+        samples[i] = static_cast<int16_t>(spread + static_cast<int8_t>(noise[i]) * 2);
+        samples_f[i] = samples[i] * 0.25f;
+    }
+
+    std::vector<int32_t> sums(codes * symbols);
+    std::vector<float> sums_f(codes * symbols);
+    despread(samples.data(), symbols, factor, pointers.data(), codes, sums.data());
+    despread(samples_f.data(), symbols, factor, pointers.data(), codes, sums_f.data());
+
+    bool matches = true;
+    for (size_t c = 0; c < codes; c++) {
+        for (size_t s = 0; s < symbols; s++) {
+            int32_t expected = 0;
+            for (size_t k = 0; k < factor; k++) {
+                size_t i = s * factor + k;
+                expected += chip(c, i) ? -samples[i] : samples[i];
+            }
+            matches = matches && sums[c * symbols + s] == expected &&
+                      std::abs(sums_f[c * symbols + s] - expected * 0.25f) < 0.5f;
+        }
+    }
+    check("Despread sums match per-chip reference", matches);
+
+    bool recovered = true;
+    for (size_t s = 0; s < symbols; s++) {
+        recovered = recovered && (sums[2 * symbols + s] < 0) == ((data[s] & 1) != 0) &&
+                    std::abs(sums[2 * symbols + s]) > 4 * std::abs(sums[s]);
+    }
+    check("Despreading recovers symbols of one code", recovered);
+
+    bool rejected = false;
+    try {
+        despread(samples.data(), 0, 65536, pointers.data(), codes, sums.data());
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    check("16-bit despreading rejects sums beyond 32 bits", rejected);
+}
+
+static void testDistributions() {
+    std::cout << "\nTesting bulk variate generation:\n";
+
+    VariateGenerator generator(12345);
+    std::vector<float> floats(100001);
+    std::vector<double> doubles(50001);
+    generator.fillUniform(floats.data(), floats.size());
+    generator.fillUniform(doubles.data(), doubles.size());
+    double float_sum = 0, double_sum = 0;
+    bool in_range = true;
+    for (float f : floats) {
+        in_range = in_range && f >= 0.0f && f < 1.0f;
+        float_sum += f;
+    }
+    for (double d : doubles) {
+        in_range = in_range && d >= 0.0 && d < 1.0;
+        double_sum += d;
+    }
+    check("Uniform variates in [0, 1) with mean 1/2",
+          in_range && std::abs(float_sum / floats.size() - 0.5) < 0.01 &&
+          std::abs(double_sum / doubles.size() - 0.5) < 0.01);
+
+    // Lemire with a range rejecting about 30% of words, against a
+    // sequential reference over the same stream
+    const uint32_t range = 3000000000u;
+    LFSR stream = generator.getSource();
+    std::vector<uint64_t> blocks(100);
+    stream.fillBlocks(blocks.data(), blocks.size());
+    std::vector<uint32_t> bounded(100);
+    generator.fillBounded(bounded.data(), bounded.size(), range);
+    const uint32_t threshold = (0u - range) % range;
+    size_t produced = 0;
+    bool sequential = true;
+    for (size_t i = 0; i < 200 && produced < bounded.size(); i++) {
+        uint64_t product = (blocks[i / 2] >> (32 * (i % 2)) & 0xFFFFFFFFu) * range;
+        if (static_cast<uint32_t>(product) >= threshold) {
+            sequential = sequential && bounded[produced++] == (product >> 32);
+        }
+    }
+    check("Bounded integers follow Lemire's method", sequential && produced == bounded.size());
+
+    std::vector<uint32_t> dice(60000);
+    generator.fillBounded(dice.data(), dice.size(), 6);
+    std::vector<int> histogram(7, 0);
+    for (uint32_t d : dice) histogram[std::min<uint32_t>(d, 6)]++;
+    bool uniform = histogram[6] == 0;
+    for (int face = 0; face < 6; face++) uniform = uniform && std::abs(histogram[face] - 10000) < 400;
+    check("Bounded integers are uniform", uniform);
+
+    std::vector<uint8_t> trials(100003);
+    generator.fillBernoulli(trials.data(), trials.size(), 0.3);
+    size_t successes = std::count(trials.begin(), trials.end(), 1);
+    size_t others = trials.size() - successes - std::count(trials.begin(), trials.end(), 0);
+    generator.fillBernoulli(trials.data(), 1000, 1.0);
+    bool certain = std::all_of(trials.begin(), trials.begin() + 1000, [](uint8_t t) { return t == 1; });
+    generator.fillBernoulli(trials.data(), 1000, 0.0);
+    bool impossible = std::all_of(trials.begin(), trials.begin() + 1000, [](uint8_t t) { return t == 0; });
+    check("Bernoulli trials at requested probability",
+          others == 0 && std::abs(double(successes) / trials.size() - 0.3) < 0.01 && certain && impossible);
+
+    // Moments and tail mass of N(0, 2^2)
+    VariateGenerator noise(0xC0FFEE);
+    std::vector<float> gaussian(1000000);
+    noise.fillGaussianAt(0, gaussian.data(), 1000, 2.0f);
+    std::vector<float> replay(gaussian.begin(), gaussian.begin() + 1000);
+    noise.fillGaussian(gaussian.data(), gaussian.size(), 2.0f);
+    double sum = 0, squares = 0;
+    size_t beyond = 0;
+    float peak = 0;
+    for (float g : gaussian) {
+        sum += g;
+        squares += double(g) * g;
+        beyond += std::abs(g) > 4.0f;
+        peak = std::max(peak, std::abs(g));
+    }
+    const double mean = sum / gaussian.size();
+    const double variance = squares / gaussian.size() - mean * mean;
+    check("Gaussian noise has requested sigma and tails",
+          std::abs(mean) < 0.01 && std::abs(variance - 4.0) < 0.03 &&
+          std::abs(beyond / double(gaussian.size()) - 0.0455) < 0.002 && peak < 12.5f);
+
+    // Samples at any offset replay exactly, including odd offsets
+    std::vector<float> window(777);
+    bool replays = std::equal(replay.begin(), replay.end(), gaussian.begin());
+    VariateGenerator rewound(0xC0FFEE);
+    rewound.fillGaussianAt(123457, window.data(), window.size(), 2.0f);
+    replays = replays && std::equal(window.begin(), window.end(), gaussian.begin() + 123457);
+    check("Gaussian noise replays from (seed, offset)", replays);
+}
+
+static void testDither() {
+    std::cout << "\nTesting TPDF dither:\n";
+
+    // Silence dithers to 0 with probability 3/4 and +-1 LSB otherwise;
+    // a constant 0.3 LSB survives on average
+    const size_t channels = 3, frames = 100000;
+    std::vector<float> in(frames * channels);
+    for (size_t f = 0; f < frames; f++) {
+        in[f * channels + 1] = 0.3f / 32768.0f;
+        in[f * channels + 2] = (f % 2) ? 1.5f : -1.5f;
+    }
+    std::vector<int16_t> out(in.size());
+    TPDFDither dither(channels, 99);
+    dither.processInt16(in.data(), out.data(), frames);
+
+    size_t zeros = 0, outside = 0;
+    double level = 0;
+    bool clipped = true;
+    for (size_t f = 0; f < frames; f++) {
+        int16_t silent = out[f * channels];
+        zeros += silent == 0;
+        outside += silent < -1 || silent > 1;
+        level += out[f * channels + 1];
+        clipped = clipped && out[f * channels + 2] == ((f % 2) ? 32767 : -32768);
+    }
+    check("TPDF dither has triangular distribution",
+          outside == 0 && std::abs(zeros / double(frames) - 0.75) < 0.01 &&
+          std::abs(level / frames - 0.3) < 0.01 && clipped);
+
+    // Output is independent of block sizes, and channels differ
+    TPDFDither blocked(channels, 99);
+    std::vector<int16_t> pieces(in.size());
+    blocked.processInt16(in.data(), pieces.data(), 1001);
+    blocked.processInt16(in.data() + 1001 * channels, pieces.data() + 1001 * channels, frames - 1001);
+    bool differ = false;
+    for (size_t f = 0; f < 1000; f++) differ = differ || out[f * channels] != out[f * channels + 1];
+    check("Channel substreams are deterministic", pieces == out && differ);
+
+    // Substreams are spaced by a precomputed jump
+    LFSR spaced(64, LFSR::maximalPolynomial(64), 99), direct = spaced;
+    const uint64_t spacing = spaced.jumpPolynomial(1ULL << 46);
+    spaced.applyJump(spacing, 1ULL << 46);
+    spaced.applyJump(spacing, 1ULL << 46);
+    direct.jump(1ULL << 47);
+    check("Precomputed jump matches jump()", spaced.getState() == direct.getState());
+
+    TPDFDither wide(1, 99);
+    std::vector<float> mono(1003, 0.25f);
+    mono[0] = 1.0f;
+    std::vector<int32_t> out24(mono.size());
+    wide.processInt24(mono.data(), out24.data(), mono.size());
+    bool near = out24[0] == 8388607;
+    for (size_t i = 1; i < mono.size(); i++) near = near && std::abs(out24[i] - 2097152) <= 1;
+    check("24-bit output within one LSB", near);
+
+    // Half an LSB above 0.75 FS, where a float sum has only half-LSB steps;
+    // the dither must still average out to the input
+    TPDFDither loud(1, 7);
+    std::vector<float> level24(1 << 20, 0.75f + 0x1p-24f);
+    std::vector<int32_t> loud24(level24.size());
+    for (size_t done = 0; done < level24.size(); done += 1003) {
+        const size_t n = std::min<size_t>(1003, level24.size() - done);
+        loud.processInt24(level24.data() + done, loud24.data() + done, n);
+    }
+    double sum24 = 0;
+    for (int32_t sample : loud24) sum24 += sample - 6291456;
+    check("24-bit dither is unbiased near 0.75 FS", std::abs(sum24 / loud24.size() - 0.5) < 0.01);
+}
+
+static void testPermutation() {
+    std::cout << "\nTesting permutation iterator:\n";
+
+    // The polynomial table: x^(2^n - 1) = 1 for every size, full period
+    // by stepping for the small ones
+    bool primitive = true;
+    for (int n = 2; n <= 64; n++) {
+        uint64_t polynomial = LFSR::maximalPolynomial(n);
+        uint64_t period = n == 64 ? ~0ULL : (1ULL << n) - 1;
+        primitive = primitive && gf2PowX(period, polynomial, n) == 1;
+        if (n <= 18) {
+            LFSR reg(n, polynomial, 1);
+            uint64_t steps = 0;
+            do {
+                reg.nextBit();
+                steps++;
+            } while (reg.getState() != 1 && steps <= period);
+            primitive = primitive && steps == period;
+        }
+    }
+    check("Maximal polynomials for sizes 2-64", primitive);
+
+    bool exact = true;
+    for (uint64_t n : {1ULL, 2ULL, 3ULL, 4ULL, 1000ULL, 65535ULL, 100001ULL}) {
+        PermutationIterator it(n, 12345);
+        std::vector<bool> seen(n, false);
+        uint64_t value, count = 0;
+        while (it.next(value)) {
+            exact = exact && value < n && !seen[value];
+            if (value < n) seen[value] = true;
+            count++;
+        }
+        exact = exact && count == n;
+    }
+    check("Every value visited exactly once", exact);
+
+    // Parts of a partially consumed iterator cover the rest exactly once
+    const uint64_t n = 50000;
+    PermutationIterator whole(n, 7);
+    std::vector<uint64_t> head(1000);
+    whole.fill(head.data(), head.size());
+    std::vector<uint64_t> rest, merged;
+    uint64_t value;
+    for (PermutationIterator copy = whole; copy.next(value);) rest.push_back(value);
+    for (uint64_t part = 0; part < 7; part++) {
+        PermutationIterator piece = whole.partition(part, 7);
+        while (piece.next(value)) merged.push_back(value);
+    }
+    check("Partitions concatenate to the same order", merged == rest && rest.size() == n - 1000);
+
+    // Huge ranges need no storage; successive values are not shifts
+    PermutationIterator big(~0ULL - 5, 1);
+    std::vector<uint64_t> sample(4);
+    big.fill(sample.data(), sample.size());
+    check("64-bit range uses a 64-bit register",
+          big.getRegisterSize() == 64 && (sample[1] + 1) != ((sample[0] + 1) >> 1) &&
+          big.partition(3, 4).getRemainingPositions() > (1ULL << 61));
+}
+
+static void testPointerChase() {
+    std::cout << "\nTesting pointer chase:\n";
+
+    // Serial and parallel builds give the same single cycle
+    const size_t n = 300001;
+    std::vector<void*> serial(n), parallel(n);
+    buildPointerChase(serial.data(), n, sizeof(void*), 5, 1);
+    buildPointerChase(parallel.data(), n, sizeof(void*), 5, 4);
+    bool same = true;
+    for (size_t i = 0; i < n; i++) {
+        same = same && static_cast<void**>(serial[i]) - serial.data() ==
+                       static_cast<void**>(parallel[i]) - parallel.data();
+    }
+    std::vector<bool> seen(n, false);
+    size_t index = 0, steps = 0;
+    do {
+        seen[index] = true;
+        index = static_cast<void**>(serial[index]) - serial.data();
+        steps++;
+    } while (index != 0 && steps <= n);
+    check("Chain is one cycle through every element",
+          steps == n && std::find(seen.begin(), seen.end(), false) == seen.end() && same);
+
+    PointerChaseBuffer buffer(5000, 64, true, 3);
+    const uint8_t* base = static_cast<const uint8_t*>(buffer.data());
+    const uint8_t* end = static_cast<const uint8_t*>(buffer.chase(5000));
+    check("Mapped chain returns to its head",
+          end == base && buffer.chase(1) != base && buffer.measureLatency(10000) > 0.0);
+}
+
+static void testMemoryTester() {
+    std::cout << "\nTesting memory tester:\n";
+
+    // 125000 words: 244 chunks plus a partial one
+    std::vector<uint64_t> region(125000);
+    const size_t bytes = region.size() * 8;
+    MemoryTester tester(21, 4096, 1);
+    MemoryTestResult clean = tester.run(region.data(), bytes);
+    check("March test passes on good memory",
+          clean.error_count == 0 && clean.words_checked == 2 * region.size());
+
+    // The pattern does not depend on the thread count
+    std::vector<uint64_t> threaded(region.size());
+    tester.write(region.data(), bytes);
+    MemoryTester(21, 4096, 3).write(threaded.data(), bytes);
+    check("Pattern independent of threads", threaded == region);
+
+    region[777] ^= 1ULL << 5;
+    region[124999] ^= 1ULL << 63;
+    MemoryTestResult bad = MemoryTester(21, 4096, 4).verify(region.data(), bytes);
+    bool located = bad.error_count == 2 && bad.failures.size() == 2 &&
+                   bad.failures[0].offset == 777 * 8 && bad.failures[1].offset == 124999 * 8;
+    for (const auto& failure : bad.failures) {
+        located = located && tester.expectedWord(failure.stream_block) == failure.expected &&
+                  (failure.expected ^ failure.actual) != 0;
+    }
+    check("Failures located and replayed by jump", located);
+}
+
+static void testStoragePattern() {
+    std::cout << "\nTesting storage pattern writer:\n";
+
+    StoragePattern pattern(77, 4096);
+    const size_t blocks = 1000;
+    std::vector<uint64_t> whole(blocks * 512), part(3 * 512);
+    pattern.generate(0, whole.data(), blocks);
+    pattern.generate(500, part.data(), 3);
+    check("Blocks are tagged and seekable",
+          whole[500 * 512] == 500 && whole[500 * 512 + 1] == 77 &&
+          std::equal(part.begin(), part.end(), whole.begin() + 500 * 512) &&
+          whole[2] != whole[512 + 2]);
+
+    // Queued O_DIRECT writes, then buffered pwrite(), over the same file
+    char path[] = "/tmp/test_lfsr_patternXXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    StorageIOOptions options;
+    options.io_bytes = 12 * 4096;
+    options.queue_depth = 4;
+    options.threads = 2;
+    StorageWriteResult result = pattern.writeFile(path, 0, blocks * 4096, options);
+    std::vector<uint64_t> file(whole.size());
+    fd = open(path, O_RDONLY);
+    bool read_back = fd >= 0 && pread(fd, file.data(), blocks * 4096, 0) == static_cast<ssize_t>(blocks * 4096);
+    check("Queued writes produce the pattern",
+          read_back && file == whole && result.bytes_written == blocks * 4096);
+
+    options.direct = false;
+    options.use_io_uring = false;
+    pattern.writeFile(path, 100 * 4096, 50 * 4096, options);
+    std::fill(file.begin(), file.end(), 0);
+    read_back = fd >= 0 && pread(fd, file.data(), blocks * 4096, 0) == static_cast<ssize_t>(blocks * 4096);
+    check("pwrite() fallback rewrites the same blocks", read_back && file == whole);
+    if (fd >= 0) close(fd);
+
+    uint64_t located = 0;
+    check("Block located by discrete log",
+          pattern.locateBlock(whole.data() + 777 * 512, located) && located == 777 &&
+          !pattern.locateBlock(file.data() + 1, located));
+
+    options.direct = true;
+    options.use_io_uring = true;
+    StorageVerifyResult clean = pattern.verifyFile(path, 0, blocks * 4096, options);
+
+    // A misdirected write of block 10 over block 20, a flipped bit in
+    // block 30, and two blocks past the end of the file
+    fd = open(path, O_RDWR);
+    bool damaged = fd >= 0 &&
+        pwrite(fd, whole.data() + 10 * 512, 4096, 20 * 4096) == 4096 &&
+        pwrite(fd, "\x55", 1, 30 * 4096 + 100) == 1;
+    if (fd >= 0) close(fd);
+    options.use_io_uring = false;
+    StorageVerifyResult bad = pattern.verifyFile(path, 0, (blocks + 2) * 4096, options);
+    bool found = damaged && bad.faults.size() == 3 && bad.bad_bytes == 4 * 4096 &&
+        bad.faults[0].offset == 20 * 4096 && bad.faults[0].kind == StorageFaultKind::Misplaced &&
+        bad.faults[0].source_offset == 10 * 4096 &&
+        bad.faults[1].offset == 30 * 4096 && bad.faults[1].kind == StorageFaultKind::Corrupt &&
+        bad.faults[2].offset == blocks * 4096 && bad.faults[2].bytes == 2 * 4096 &&
+        bad.faults[2].kind == StorageFaultKind::Missing;
+    check("Verifier reports misplaced, corrupt and missing blocks", clean.faults.empty() && found);
+
+    // A file cut off inside a sector: the direct read ends off-alignment,
+    // and the tail block is reported missing rather than failing the read
+    bool truncated = truncate(path, blocks * 4096 - 1000) == 0;
+    for (bool io_uring : {true, false}) {
+        options.use_io_uring = io_uring;
+        try {
+            StorageVerifyResult cut = pattern.verifyFile(path, (blocks - 12) * 4096, 12 * 4096, options);
+            truncated = truncated && cut.used_direct && cut.faults.size() == 1 &&
+                cut.faults[0].offset == (blocks - 1) * 4096 &&
+                cut.faults[0].kind == StorageFaultKind::Missing;
+        } catch (const std::exception&) {
+            truncated = false;
+        }
+    }
+    check("Verifier reports a truncated file's tail as missing", truncated);
+    unlink(path);
+}
+
+static void testStreamOutput() {
+    std::cout << "\nTesting stream output:\n";
+
+    // An odd length at an odd offset, through vmsplice() and write()
+    const uint64_t offset = 1000;
+    const size_t bytes = 3 * 1024 * 1024 + 5;
+    LFSR generator(64, LFSR::maximalPolynomial(64), 12345);
+    LFSR reference = generator;
+    reference.jump(offset * 8);
+    std::vector<uint8_t> expected(bytes);
+    reference.fill(expected.data(), bytes);
+
+    for (bool splice : {true, false}) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            check("Pipe created", false);
+            return;
+        }
+        std::vector<uint8_t> received;
+        std::thread reader([&]() {
+            uint8_t buffer[65536];
+            ssize_t n;
+            while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+                received.insert(received.end(), buffer, buffer + n);
+            }
+        });
+        StreamOptions options;
+        options.threads = 3;
+        options.use_vmsplice = splice;
+        StreamResult result = streamSequence(fds[1], generator, offset, bytes, options);
+        close(fds[1]);
+        reader.join();
+        close(fds[0]);
+        check(splice ? "Pipe receives the jumped stream (vmsplice)" : "Pipe receives the jumped stream (write)",
+              received == expected && result.bytes_written == bytes && !result.reader_closed &&
+              (splice || !result.used_vmsplice));
+    }
+
+    // A reader that splices the gifted pages into another pipe and looks at
+    // them only after the stream has ended sees them unchanged
+    int source[2], sink[2];
+    bool spliced = false;
+    if (pipe(source) == 0 && pipe(sink) == 0) {
+        const size_t small = 256 * 1024;
+        if (fcntl(sink[1], F_SETPIPE_SZ, 1 << 20) >= static_cast<int>(small)) {
+            std::thread forwarder([&]() {
+                while (splice(source[0], nullptr, sink[1], nullptr, 1 << 20, 0) > 0) {
+                }
+            });
+            StreamOptions options;
+            options.threads = 2;
+            options.buffer_bytes = 16384;
+            StreamResult result = streamSequence(source[1], generator, offset, small, options);
+            close(source[1]);
+            forwarder.join();
+            close(sink[1]);
+            std::vector<uint8_t> received;
+            uint8_t buffer[65536];
+            ssize_t n;
+            while ((n = read(sink[0], buffer, sizeof(buffer))) > 0) {
+                received.insert(received.end(), buffer, buffer + n);
+            }
+            spliced = result.bytes_written == small &&
+                      std::equal(received.begin(), received.end(), expected.begin()) && received.size() == small;
+        } else {
+            close(source[1]);
+            close(sink[1]);
+            spliced = true;  // Pipe cannot hold the stream; nothing to check
+        }
+        close(source[0]);
+        close(sink[0]);
+    }
+    check("Gifted pages are not reused under a splicing reader", spliced);
+
+    // A reader that has gone away ends the stream without an error
+    int fds[2];
+    bool closed = false;
+    if (pipe(fds) == 0) {
+        auto previous = std::signal(SIGPIPE, SIG_IGN);
+        close(fds[0]);
+        StreamResult result = streamSequence(fds[1], generator, 0, STREAM_UNLIMITED);
+        std::signal(SIGPIPE, previous);
+        close(fds[1]);
+        closed = result.reader_closed && result.bytes_written == 0;
+    }
+    check("Closed reader stops an unlimited stream", closed);
+}
+
+static void testGeneratorDaemon() {
+    std::cout << "\nTesting generator daemon:\n";
+
+    const std::string path = "/tmp/test_lfsr_daemon_" + std::to_string(getpid()) + ".sock";
+    DaemonStreamConfig config;
+    config.name = "noise";
+    config.seed = 777;
+    config.substream_bytes = 1 << 20;
+    DaemonOptions options;
+    options.fill_bytes = 4096;
+    std::unique_ptr<GeneratorDaemon> daemon;
+    try {
+        daemon.reset(new GeneratorDaemon(path, {config}, options));
+    } catch (const std::exception& e) {
+        std::cout << "Daemon unavailable: " << e.what() << "\n";
+        check("Daemon started", false);
+        return;
+    }
+    std::thread server([&]() { daemon->run(); });
+
+    // Each client reads its own substream, starting substream_bytes apart;
+    // the small ring forces the daemon to wait for the reader
+    auto expected = [&](uint64_t offset, size_t bytes) {
+        LFSR reference(64, LFSR::maximalPolynomial(64), config.seed);
+        reference.jump(offset * 8);
+        std::vector<uint8_t> out(bytes);
+        reference.fill(out.data(), bytes);
+        return out;
+    };
+    bool matched = true, assigned = true, stalled = true;
+    {
+        GeneratorClient first(path, "noise", DAEMON_NEXT_SUBSTREAM, 8192);
+        GeneratorClient second(path, "noise");
+        GeneratorClient chosen(path, "noise", 5);
+        assigned = first.getSubstream() == 0 && second.getSubstream() == 1 && chosen.getSubstream() == 5 &&
+                   chosen.getStartOffset() == 5u << 20 && first.getRingBytes() == 8192;
+        for (GeneratorClient* client : {&first, &second, &chosen}) {
+            const size_t bytes = 100003;
+            std::vector<uint8_t> received(bytes);
+            size_t got = 0;
+            for (size_t piece = 1; got < bytes; piece = piece * 3 + 1) {
+                got += client->read(received.data() + got, std::min(piece, bytes - got));
+            }
+            matched = matched && received == expected(client->getStartOffset(), bytes);
+        }
+        ClientCounters counters = first.getCounters();
+        stalled = counters.producer_stalls > 0 && counters.bytes_consumed == 100003;
+    }
+    check("Clients receive their substreams", matched);
+    check("Substreams assigned in order", assigned);
+    check("Full ring holds the producer back", stalled);
+
+    bool refused = false;
+    try {
+        GeneratorClient unknown(path, "missing");
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    check("Unknown stream refused", refused);
+
+    DaemonStats stats = queryDaemonStats(path);
+    check("Daemon totals", stats.clients_served == 3 && stats.requests_rejected == 1 &&
+                           stats.bytes_consumed == 3 * 100003 && stats.producer_stalls > 0);
+
+    daemon->stop();
+    server.join();
+    daemon.reset();
+
+    // A regular file in the socket's place is neither replaced nor removed
+    const std::string file_path = "/tmp/test_lfsr_daemon_" + std::to_string(getpid()) + ".txt";
+    FILE* file = std::fopen(file_path.c_str(), "w");
+    bool kept = false;
+    if (file != nullptr) {
+        std::fclose(file);
+        try {
+            GeneratorDaemon misplaced(file_path, {config}, options);
+        } catch (const std::runtime_error&) {
+            kept = access(file_path.c_str(), F_OK) == 0;
+        }
+        std::remove(file_path.c_str());
+    }
+    check("Existing file at socket path kept", kept);
+}
+
+static void testBlockRing() {
+    std::cout << "\nTesting shared block ring:\n";
+
+    // Consumer processes split the blocks between them and check each one
+    const std::string name = "/test_lfsr_ring_" + std::to_string(getpid());
+    const uint64_t offset = 12345;
+    const unsigned consumers = 3;
+    const uint64_t total = 200;
+    BlockRingOptions options;
+    options.block_bytes = 10000;
+    options.blocks = 4;
+    LFSR stream(64, LFSR::maximalPolynomial(64), 4242);
+    std::unique_ptr<BlockRingProducer> producer;
+    try {
+        producer.reset(new BlockRingProducer(name, stream, offset, options));
+    } catch (const std::exception& e) {
+        std::cout << "Shared memory unavailable: " << e.what() << "\n";
+        check("Ring created", false);
+        return;
+    }
+
+    int results[2];
+    if (pipe(results) != 0) {
+        check("Pipe created", false);
+        return;
+    }
+    std::vector<pid_t> children;
+    for (unsigned i = 0; i < consumers; i++) {
+        pid_t child = fork();
+        if (child == 0) {
+            // Blocks claimed, sum of their numbers, and whether all were intact
+            uint64_t report[3] = {0, 0, 1};
+            try {
+                BlockRingConsumer consumer(name);
+                BlockView view;
+                while (consumer.acquire(view)) {
+                    bool placed = view.stream_offset == offset + view.sequence * options.block_bytes;
+                    report[2] &= placed && consumer.verify(view);
+                    report[0]++;
+                    report[1] += view.sequence;
+                    consumer.release(view);
+                }
+            } catch (...) {
+                report[2] = 0;
+            }
+            ssize_t ignored = write(results[1], report, sizeof(report));
+            (void)ignored;
+            _exit(0);
+        }
+        children.push_back(child);
+    }
+    close(results[1]);
+
+    bool produced = true;
+    for (uint64_t i = 0; i < total; i++) {
+        produced = produced && producer->produce();
+    }
+    producer->close();
+    uint64_t claimed = 0, sum = 0, intact = 1;
+    uint64_t report[3];
+    while (read(results[0], report, sizeof(report)) == static_cast<ssize_t>(sizeof(report))) {
+        claimed += report[0];
+        sum += report[1];
+        intact &= report[2];
+    }
+    close(results[0]);
+    for (pid_t child : children) {
+        waitpid(child, nullptr, 0);
+    }
+    BlockRingStats stats = producer->getStats();
+    check("Each block claimed by exactly one consumer",
+          produced && claimed == total && sum == total * (total - 1) / 2);
+    check("Blocks carry their offsets and verify", intact == 1);
+    check("Ring counters", stats.blocks_produced == total && stats.blocks_released == total);
+    check("Closed ring refuses more blocks", !producer->produce());
+    producer.reset();
+
+    // A producer process that exits without closing ends the stream for
+    // its consumers instead of leaving them waiting
+    const std::string orphan_name = name + "_orphan";
+    int ready[2];
+    bool ended = false;
+    if (pipe(ready) == 0) {
+        pid_t child = fork();
+        if (child == 0) {
+            close(ready[0]);
+            BlockRingProducer* orphan = new BlockRingProducer(orphan_name, stream, 0, options);
+            orphan->produce();
+            orphan->produce();
+            char byte = 1;
+            ssize_t ignored = write(ready[1], &byte, 1);
+            (void)ignored;
+            _exit(0);  // Neither closed nor unlinked
+        }
+        close(ready[1]);
+        char byte = 0;
+        if (child > 0 && read(ready[0], &byte, 1) == 1) {
+            waitpid(child, nullptr, 0);
+            BlockRingConsumer consumer(orphan_name);
+            BlockView view;
+            int drained = 0;
+            while (consumer.acquire(view)) {
+                drained++;
+                consumer.release(view);
+            }
+            ended = drained == 2;
+            shm_unlink(orphan_name.c_str());
+        } else if (child > 0) {
+            waitpid(child, nullptr, 0);
+        }
+        close(ready[0]);
+    }
+    check("Consumers notice a producer that died", ended);
+}
+
+static void testSequenceFile() {
+    std::cout << "\nTesting sequence file:\n";
+
+    // An odd number of bits from an odd offset, checked against the register
+    const std::string path = "/tmp/test_lfsr_sequence_" + std::to_string(getpid()) + ".bin";
+    const uint64_t offset = 1001, bits = 100003;
+    LFSR generator(31, LFSR::maximalPolynomial(31), 99);
+    SequenceFileInfo written = writeSequenceFile(path, generator, offset, bits);
+    bool matched = false, sliced = false, header = false, damaged = false;
+    {
+        SequenceFile file(path);
+        const SequenceFileInfo& info = file.getInfo();
+        header = info.bit_count == bits && info.start_offset == offset && info.register_size == 31 &&
+                 info.checksum == written.checksum && file.verifyChecksum(2) &&
+                 reinterpret_cast<uintptr_t>(file.bits().data()) % 4096 == 0;
+        LFSR reference = file.makeGenerator();
+        BitSequenceView view = file.bits();
+        uint64_t ones = 0;
+        matched = view.size() == bits;
+        for (uint64_t i = 0; i < bits && matched; i++) {
+            bool bit = reference.nextBit();
+            matched = view[i] == bit;
+            ones += bit;
+        }
+        BitSequenceView middle = view.slice(777, 5000);
+        sliced = view.countOnes() == ones && middle.extract(3, 64) == view.extract(780, 64) &&
+                 middle.at(4999) == view[5776];
+    }
+
+    // Bit order is honoured and a flipped data bit fails the checksum
+    SequenceFileInfo msb;
+    msb.bit_order = BitOrder::MsbFirst;
+    const uint8_t packed[2] = {0xA5, 0xC0};
+    {
+        SequenceFileWriter writer(path, msb);
+        writer.append(packed, 10);
+    }
+    {
+        SequenceFile file(path);
+        BitSequenceView view = file.bits();
+        damaged = file.verifyChecksum() && view.size() == 10 && view[0] && !view[1] && view[8] && view[9] &&
+                  view.extract(0, 10) == 0x3A5;
+    }
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd >= 0) {
+        const uint8_t flipped = 0xA4;
+        damaged = damaged && pwrite(fd, &flipped, 1, 4096) == 1;
+        close(fd);
+        damaged = damaged && !SequenceFile(path).verifyChecksum();
+    }
+    unlink(path.c_str());
+    check("Header round trip and page-aligned data", header);
+    check("Mapped bits match the register", matched);
+    check("Slices, extraction and counting", sliced);
+    check("MSB-first packing and damage detection", damaged);
+}
+
+static void testTextFormat() {
+    std::cout << "\nTesting text formatting:\n";
+
+    // RFC 4648 vectors, and every kernel against the scalar one at lengths
+    // around each vector width
+    TextFormatter formatter;
+    char out[16];
+    const std::string vectors[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+    bool rfc = true;
+    for (size_t len = 0; len <= 6; len++) {
+        size_t n = formatter.formatBase64(reinterpret_cast<const uint8_t*>("foobar"), len, out);
+        rfc = rfc && std::string(out, n) == vectors[len];
+    }
+    check("Base64 RFC 4648 vectors", rfc);
+
+    LFSR generator(32, LFSR::maximalPolynomial(32), 5150);
+    std::vector<uint8_t> data(300);
+    generator.fill(data.data(), data.size());
+    TextFormatter scalar;
+    scalar.setKernel(TextKernel::Scalar);
+    bool kernels = true;
+    for (TextKernel kernel : {TextKernel::SSSE3, TextKernel::AVX2}) {
+        if (!TextFormatter::isKernelSupported(kernel)) {
+            continue;
+        }
+        TextFormatter simd;
+        simd.setKernel(kernel);
+        for (size_t len = 0; len <= data.size(); len += (len < 70 ? 1 : 37)) {
+            std::vector<char> expected(8 * len + 8), actual(8 * len + 8);
+            for (BitOrder order : {BitOrder::LsbFirst, BitOrder::MsbFirst}) {
+                size_t n = scalar.formatBits(data.data(), 8 * len + 3, expected.data(), order);
+                simd.formatBits(data.data(), 8 * len + 3, actual.data(), order);
+                kernels = kernels && std::equal(expected.begin(), expected.begin() + n, actual.begin());
+            }
+            size_t n = scalar.formatHex(data.data(), len, expected.data(), true);
+            simd.formatHex(data.data(), len, actual.data(), true);
+            kernels = kernels && std::equal(expected.begin(), expected.begin() + n, actual.begin());
+            n = scalar.formatBase64(data.data(), len, expected.data());
+            simd.formatBase64(data.data(), len, actual.data());
+            kernels = kernels && std::equal(expected.begin(), expected.begin() + n, actual.begin());
+        }
+    }
+    check("SIMD kernels match scalar", kernels);
+
+    char bits[12];
+    formatter.formatBits(data.data(), 12, bits);
+    bool ordered = true;
+    for (int i = 0; i < 12; i++) {
+        ordered = ordered && bits[i] == ((data[i / 8] >> (i % 8)) & 1 ? '1' : '0');
+    }
+    check("Bits in sequence order", ordered && LFSR(5, 0x16).getStateString() == "10110");
+
+    // Base64 split at odd places across writes, wrapped into lines
+    int fds[2];
+    bool wrapped = false;
+    if (pipe(fds) == 0) {
+        TextWriterOptions options;
+        options.encoding = TextEncoding::Base64;
+        options.line_chars = 76;
+        options.buffer_bytes = 100;
+        {
+            TextWriter writer(fds[1], options);
+            writer.write(data.data(), 8);
+            writer.write(data.data() + 1, 8 * 100);
+            writer.write(data.data() + 101, 8 * 199);
+        }
+        close(fds[1]);
+        std::string received;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+            received.append(buffer, static_cast<size_t>(n));
+        }
+        close(fds[0]);
+        std::vector<char> whole(TextFormatter::base64Length(data.size()));
+        scalar.formatBase64(data.data(), data.size(), whole.data());
+        std::string expected;
+        for (size_t i = 0; i < whole.size(); i += 76) {
+            expected.append(whole.data() + i, std::min<size_t>(76, whole.size() - i));
+            expected += '\n';
+        }
+        wrapped = received == expected;
+    }
+    check("Buffered writer wraps and carries base64 groups", wrapped);
+}
 
 int main() {
     std::cout << "=== Simple LFSR Test ===\n\n";
@@ -23,7 +1362,33 @@ int main() {
     std::cout << "\nTesting period completion:\n";
     bool test_result = lfsr3.selfTest();
     std::cout << "Period test: " << (test_result ? "PASSED" : "FAILED") << "\n";
+    if (!test_result) failures++;
     
+    testBulkGeneration();
+    testScrambler();
+    testMultiplicativeScrambler();
+    testPresets();
+    testPRBSChecker();
+    testErrorChannel();
+    testCRC();
+    testCRCCombine();
+    testCyclicCode();
+    testGaloisField();
+    testSpreadingCodes();
+    testCorrelator();
+    testDespreader();
+    testDistributions();
+    testDither();
+    testPermutation();
+    testPointerChase();
+    testMemoryTester();
+    testStoragePattern();
+    testStreamOutput();
+    testGeneratorDaemon();
+    testBlockRing();
+    testSequenceFile();
+    testTextFormat();
+
     std::cout << "\n=== Test Complete ===\n";
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,447 @@
+#include "text_format.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TEXT_HAVE_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char HEX_LOWER[] = "0123456789abcdef";
+const char HEX_UPPER[] = "0123456789ABCDEF";
+const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Input bytes formatted per chunk by TextWriter; base64 chunks are whole groups
+constexpr size_t BINARY_CHUNK_BYTES = 8 << 10;
+constexpr size_t HEX_CHUNK_BYTES = 32 << 10;
+constexpr size_t BASE64_CHUNK_BYTES = 48 << 10;
+
+// Eight characters of a byte, first sequence bit first, as one word
+struct BitTables {
+    std::array<uint64_t, 256> lsb_first;
+    std::array<uint64_t, 256> msb_first;
+
+    BitTables() {
+        for (int b = 0; b < 256; b++) {
+            char lsb[8], msb[8];
+            for (int j = 0; j < 8; j++) {
+                lsb[j] = static_cast<char>('0' + ((b >> j) & 1));
+                msb[j] = static_cast<char>('0' + ((b >> (7 - j)) & 1));
+            }
+            std::memcpy(&lsb_first[b], lsb, 8);
+            std::memcpy(&msb_first[b], msb, 8);
+        }
+    }
+};
+
+void bitsScalar(const uint8_t* src, size_t len, char* out, bool msb_first) {
+    static const BitTables tables;
+    const std::array<uint64_t, 256>& table = msb_first ? tables.msb_first : tables.lsb_first;
+    for (size_t i = 0; i < len; i++) {
+        std::memcpy(out + 8 * i, &table[src[i]], 8);
+    }
+}
+
+void hexScalar(const uint8_t* src, size_t len, char* out, const char* digits) {
+    for (size_t i = 0; i < len; i++) {
+        out[2 * i] = digits[src[i] >> 4];
+        out[2 * i + 1] = digits[src[i] & 0x0F];
+    }
+}
+
+// Whole groups only; the caller pads the last one
+void base64Scalar(const uint8_t* src, size_t groups, char* out) {
+    for (size_t g = 0; g < groups; g++) {
+        const uint32_t word = static_cast<uint32_t>(src[0]) << 16 | static_cast<uint32_t>(src[1]) << 8 | src[2];
+        out[0] = BASE64_ALPHABET[word >> 18];
+        out[1] = BASE64_ALPHABET[(word >> 12) & 63];
+        out[2] = BASE64_ALPHABET[(word >> 6) & 63];
+        out[3] = BASE64_ALPHABET[word & 63];
+        src += 3;
+        out += 4;
+    }
+}
+
+#ifdef TEXT_HAVE_SIMD
+
+// Each step spreads two input bytes over 16 lanes; lane j keeps its bit
+// (selected by the mask) and turns into '1' where the bit is set
+__attribute__((target("ssse3")))
+size_t bitsShuffle128(const uint8_t* src, size_t len, char* out, bool msb_first) {
+    const __m128i select = msb_first
+        ? _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1)
+        : _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i first_pair = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i next_pair = _mm_set1_epi8(2);
+    const __m128i zero_char = _mm_set1_epi8('0');
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i spread = first_pair;
+        for (int k = 0; k < 8; k++) {
+            __m128i bytes = _mm_shuffle_epi8(in, spread);
+            __m128i set = _mm_cmpeq_epi8(_mm_and_si128(bytes, select), select);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8 * i + 16 * k), _mm_sub_epi8(zero_char, set));
+            spread = _mm_add_epi8(spread, next_pair);
+        }
+    }
+    return i;
+}
+
+// As bitsShuffle128 with four bytes per step, two in each 128-bit lane
+__attribute__((target("avx2")))
+size_t bitsShuffle256(const uint8_t* src, size_t len, char* out, bool msb_first) {
+    const __m256i select = msb_first
+        ? _mm256_broadcastsi128_si256(_mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1))
+        : _mm256_broadcastsi128_si256(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+    const __m256i first_quad = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                                2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i next_quad = _mm256_set1_epi8(4);
+    const __m256i zero_char = _mm256_set1_epi8('0');
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        const __m256i in = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        __m256i spread = first_quad;
+        for (int k = 0; k < 4; k++) {
+            __m256i bytes = _mm256_shuffle_epi8(in, spread);
+            __m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, select), select);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * i + 32 * k), _mm256_sub_epi8(zero_char, set));
+            spread = _mm256_add_epi8(spread, next_quad);
+        }
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+size_t hexShuffle128(const uint8_t* src, size_t len, char* out, const char* digits) {
+    const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+        __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(in, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t hexShuffle256(const uint8_t* src, size_t len, char* out, const char* digits) {
+    const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        // Quadwords 0 2 1 3, so the in-lane unpacks emit bytes in order
+        __m256i in = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), 0xD8);
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(in, nibble));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_unpacklo_epi8(high, low));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32), _mm256_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+// Spread 12 bytes over 16, one 3-byte group per 32-bit lane, and split
+// each group into four 6-bit indices (W. Mula's multiply method)
+__attribute__((target("ssse3")))
+inline __m128i base64Indices128(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+// Alphabet offset by index range: 0-25 'A', 26-51 'a' - 26, 52-61
+// '0' - 52, 62 '+' - 62, 63 '/' - 63, looked up by a shuffle
+__attribute__((target("ssse3")))
+inline __m128i base64Ascii128(__m128i indices) {
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+}
+
+// Reads 16 bytes per 12 consumed, so stops 4 bytes short of the end
+__attribute__((target("ssse3")))
+size_t base64Shuffle128(const uint8_t* src, size_t len, char* out) {
+    size_t i = 0, o = 0;
+    for (; i + 16 <= len; i += 12, o += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), base64Ascii128(base64Indices128(in)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t base64Shuffle256(const uint8_t* src, size_t len, char* out) {
+    const __m256i spread = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m256i offsets = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                      '+' - 62, '/' - 63, 'A', 0, 0));
+    size_t i = 0, o = 0;
+    for (; i + 28 <= len; i += 24, o += 32) {
+        // Two 12-byte groups, one per lane
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), 1);
+        in = _mm256_shuffle_epi8(in, spread);
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o),
+                            _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range)));
+    }
+    return i;
+}
+
+#endif // TEXT_HAVE_SIMD
+
+} // namespace
+
+TextFormatter::TextFormatter() : kernel(TextKernel::Scalar) {
+    if (isKernelSupported(TextKernel::AVX2)) {
+        kernel = TextKernel::AVX2;
+    } else if (isKernelSupported(TextKernel::SSSE3)) {
+        kernel = TextKernel::SSSE3;
+    }
+}
+
+size_t TextFormatter::formatBits(const uint8_t* packed, uint64_t bits, char* out, BitOrder order) const {
+    const bool msb_first = order == BitOrder::MsbFirst;
+    const size_t whole = static_cast<size_t>(bits / 8);
+    size_t done = 0;
+#ifdef TEXT_HAVE_SIMD
+    if (kernel == TextKernel::AVX2) {
+        done = bitsShuffle256(packed, whole, out, msb_first);
+    } else if (kernel == TextKernel::SSSE3) {
+        done = bitsShuffle128(packed, whole, out, msb_first);
+    }
+#endif
+    bitsScalar(packed + done, whole - done, out + 8 * done, msb_first);
+    for (unsigned j = 0; j < bits % 8; j++) {
+        const unsigned shift = msb_first ? 7 - j : j;
+        out[8 * whole + j] = static_cast<char>('0' + ((packed[whole] >> shift) & 1));
+    }
+    return static_cast<size_t>(bits);
+}
+
+size_t TextFormatter::formatHex(const uint8_t* data, size_t len, char* out, bool upper_case) const {
+    const char* digits = upper_case ? HEX_UPPER : HEX_LOWER;
+    size_t done = 0;
+#ifdef TEXT_HAVE_SIMD
+    if (kernel == TextKernel::AVX2) {
+        done = hexShuffle256(data, len, out, digits);
+    } else if (kernel == TextKernel::SSSE3) {
+        done = hexShuffle128(data, len, out, digits);
+    }
+#endif
+    hexScalar(data + done, len - done, out + 2 * done, digits);
+    return 2 * len;
+}
+
+size_t TextFormatter::formatBase64(const uint8_t* data, size_t len, char* out) const {
+    size_t done = 0;
+#ifdef TEXT_HAVE_SIMD
+    if (kernel == TextKernel::AVX2) {
+        done = base64Shuffle256(data, len, out);
+    } else if (kernel == TextKernel::SSSE3) {
+        done = base64Shuffle128(data, len, out);
+    }
+#endif
+    const size_t groups = (len - done) / 3;
+    base64Scalar(data + done, groups, out + done / 3 * 4);
+    done += 3 * groups;
+    char* tail = out + done / 3 * 4;
+    if (len - done == 1) {
+        tail[0] = BASE64_ALPHABET[data[done] >> 2];
+        tail[1] = BASE64_ALPHABET[(data[done] & 3) << 4];
+        tail[2] = '=';
+        tail[3] = '=';
+    } else if (len - done == 2) {
+        tail[0] = BASE64_ALPHABET[data[done] >> 2];
+        tail[1] = BASE64_ALPHABET[(data[done] & 3) << 4 | data[done + 1] >> 4];
+        tail[2] = BASE64_ALPHABET[(data[done + 1] & 15) << 2];
+        tail[3] = '=';
+    }
+    return base64Length(len);
+}
+
+bool TextFormatter::isKernelSupported(TextKernel kernel) {
+    switch (kernel) {
+    case TextKernel::Scalar:
+        return true;
+#ifdef TEXT_HAVE_SIMD
+    case TextKernel::SSSE3:
+        return __builtin_cpu_supports("ssse3");
+    case TextKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+void TextFormatter::setKernel(TextKernel new_kernel) {
+    if (!isKernelSupported(new_kernel)) {
+        throw std::invalid_argument("Text kernel not supported on this CPU");
+    }
+    kernel = new_kernel;
+}
+
+TextWriter::TextWriter(int output, const TextWriterOptions& writer_options)
+    : fd(output), options(writer_options), carry{0, 0} {
+    if (options.buffer_bytes == 0) {
+        throw std::invalid_argument("Text writer needs a non-empty buffer");
+    }
+    buffer.reserve(options.buffer_bytes + 1);
+    scratch.resize(8 * BINARY_CHUNK_BYTES + 8);
+}
+
+TextWriter::~TextWriter() {
+    try {
+        finish();
+    } catch (...) {
+        // Destructors must not throw; call finish() to see the error
+    }
+}
+
+void TextWriter::flush() {
+    const char* data = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0 && !reader_closed) {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EPIPE) {
+                reader_closed = true;
+                break;
+            }
+            throw std::runtime_error(std::string("Text write failed: ") + std::strerror(errno));
+        }
+        data += written;
+        left -= static_cast<size_t>(written);
+    }
+    buffer.clear();
+}
+
+void TextWriter::emit(const char* text, size_t len) {
+    while (len > 0) {
+        size_t take = std::min(len, options.buffer_bytes - buffer.size());
+        if (options.line_chars != 0) {
+            take = std::min(take, options.line_chars - column);
+        }
+        buffer.insert(buffer.end(), text, text + take);
+        text += take;
+        len -= take;
+        chars_written += take;
+        if (options.line_chars != 0 && (column += take) == options.line_chars) {
+            // May go one past the limit; the buffer has room for it
+            buffer.push_back('\n');
+            chars_written++;
+            column = 0;
+        }
+        if (buffer.size() >= options.buffer_bytes) {
+            flush();
+        }
+    }
+}
+
+void TextWriter::encode(const uint8_t* data, uint64_t bits) {
+    size_t chars = 0;
+    switch (options.encoding) {
+    case TextEncoding::Binary:
+        chars = formatter.formatBits(data, bits, scratch.data(), options.bit_order);
+        break;
+    case TextEncoding::Hex:
+        chars = formatter.formatHex(data, static_cast<size_t>(bits / 8), scratch.data(), options.upper_case);
+        break;
+    case TextEncoding::Base64:
+        chars = formatter.formatBase64(data, static_cast<size_t>(bits / 8), scratch.data());
+        break;
+    }
+    emit(scratch.data(), chars);
+}
+
+void TextWriter::write(const uint8_t* data, uint64_t bits) {
+    if (options.encoding != TextEncoding::Binary && bits % 8 != 0) {
+        throw std::invalid_argument("Hex and base64 output take whole bytes");
+    }
+    uint64_t len = bits / 8;
+    switch (options.encoding) {
+    case TextEncoding::Binary:
+        for (; len > BINARY_CHUNK_BYTES; len -= BINARY_CHUNK_BYTES, bits -= 8 * BINARY_CHUNK_BYTES) {
+            encode(data, 8 * BINARY_CHUNK_BYTES);
+            data += BINARY_CHUNK_BYTES;
+        }
+        if (bits != 0) {
+            encode(data, bits);
+        }
+        break;
+    case TextEncoding::Hex:
+        for (; len > 0; len -= std::min<uint64_t>(len, HEX_CHUNK_BYTES)) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(len, HEX_CHUNK_BYTES));
+            encode(data, 8 * static_cast<uint64_t>(n));
+            data += n;
+        }
+        break;
+    case TextEncoding::Base64:
+        // Complete a group left over from the previous call first
+        while (carried != 0 && len > 0) {
+            if (carried == 2) {
+                const uint8_t group[3] = {carry[0], carry[1], *data};
+                encode(group, 24);
+                carried = 0;
+            } else {
+                carry[carried++] = *data;
+            }
+            data++;
+            len--;
+        }
+        while (len >= 3) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(len / 3 * 3, BASE64_CHUNK_BYTES));
+            encode(data, 8 * static_cast<uint64_t>(n));
+            data += n;
+            len -= n;
+        }
+        while (len > 0) {
+            carry[carried++] = *data++;
+            len--;
+        }
+        break;
+    }
+}
+
+void TextWriter::finish() {
+    if (carried != 0) {
+        encode(carry, 8 * static_cast<uint64_t>(carried));
+        carried = 0;
+    }
+    if (options.line_chars != 0 && column != 0) {
+        buffer.push_back('\n');
+        chars_written++;
+        column = 0;
+    }
+    flush();
+}
@@ -0,0 +1,200 @@
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include "presets.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @enum TextKernel
+ * @brief Implementation of the text encoders
+ */
+enum class TextKernel {
+    Scalar,   // One byte at a time through lookup tables
+    SSSE3,    // PSHUFB expansion, 16 output characters per step
+    AVX2      // VPSHUFB expansion, 32 output characters per step
+};
+
+/**
+ * @class TextFormatter
+ * @brief Packed bits to ASCII binary, hex and base64
+ *
+ * Binary text expands each input byte into eight '0'/'1' characters: the
+ * byte is broadcast across a vector, each lane is masked with its own bit
+ * and compared, and the comparison mask is subtracted from '0'. Hex looks
+ * nibbles up in a 16-entry table with a byte shuffle. Base64 spreads each
+ * 3-byte group over four bytes with one shuffle, extracts the 6-bit
+ * fields with two multiplies, and maps them to the alphabet with a
+ * shuffled offset table. The fastest supported kernel is selected at
+ * construction; every kernel produces the same text.
+ */
+class TextFormatter {
+private:
+    TextKernel kernel;   // Kernel in use
+
+public:
+    /**
+     * @brief Constructor: select the fastest kernel for this CPU
+     */
+    TextFormatter();
+
+    /**
+     * @brief Write bits as '0' and '1' characters
+     * @param packed Packed bits
+     * @param bits Number of bits
+     * @param out Destination, bits characters (not terminated)
+     * @param order Packing of bits into bytes; characters follow sequence order
+     * @return Characters written
+     */
+    size_t formatBits(const uint8_t* packed, uint64_t bits, char* out,
+                      BitOrder order = BitOrder::LsbFirst) const;
+
+    /**
+     * @brief Write bytes as hex digits, high nibble first
+     * @param data Input bytes
+     * @param len Number of bytes
+     * @param out Destination, 2 * len characters (not terminated)
+     * @param upper_case Use 'A'-'F' instead of 'a'-'f'
+     * @return Characters written
+     */
+    size_t formatHex(const uint8_t* data, size_t len, char* out, bool upper_case = false) const;
+
+    /**
+     * @brief Write bytes as base64 (RFC 4648, padded)
+     * @param data Input bytes
+     * @param len Number of bytes
+     * @param out Destination, base64Length(len) characters (not terminated)
+     * @return Characters written
+     */
+    size_t formatBase64(const uint8_t* data, size_t len, char* out) const;
+
+    /**
+     * @brief Get the base64 length of some bytes
+     * @param len Number of input bytes
+     * @return 4 * ceil(len / 3)
+     */
+    static size_t base64Length(size_t len) { return (len + 2) / 3 * 4; }
+
+    /**
+     * @brief Check whether this CPU can run a kernel
+     * @return true if kernel is available
+     */
+    static bool isKernelSupported(TextKernel kernel);
+
+    /**
+     * @brief Select the kernel
+     * @param kernel Kernel to use
+     * @throw std::invalid_argument if the CPU does not support it
+     */
+    void setKernel(TextKernel kernel);
+
+    /**
+     * @brief Get the kernel in use
+     * @return Selected kernel
+     */
+    TextKernel getKernel() const { return kernel; }
+};
+
+/**
+ * @enum TextEncoding
+ * @brief Output format of TextWriter
+ */
+enum class TextEncoding {
+    Binary,   // '0' and '1' per bit
+    Hex,      // Two hex digits per byte
+    Base64    // RFC 4648 base64
+};
+
+/**
+ * @struct TextWriterOptions
+ * @brief How TextWriter formats its output
+ */
+struct TextWriterOptions {
+    TextEncoding encoding = TextEncoding::Binary;
+    BitOrder bit_order = BitOrder::LsbFirst;  // Binary: packing of the input
+    bool upper_case = false;                  // Hex: 'A'-'F'
+    size_t line_chars = 0;                    // Characters per line (0 means no line breaks)
+    size_t buffer_bytes = 1 << 20;            // Output collected before each write()
+};
+
+/**
+ * @class TextWriter
+ * @brief Buffered text dump of packed data to a file descriptor
+ *
+ * Input is formatted in large chunks with TextFormatter, broken into
+ * lines if requested, and written with one write() per buffer, so the
+ * cost per bit is a few instructions rather than an iostream call.
+ * Base64 input may be split across write() calls at any byte; hex and
+ * base64 take whole bytes, binary any number of bits per call.
+ *
+ * A reader that goes away (EPIPE) is not an error: the writer discards
+ * further output and reports it through isReaderClosed(). As with
+ * streamSequence(), callers must ignore SIGPIPE to see it.
+ */
+class TextWriter {
+private:
+    int fd;
+    TextWriterOptions options;
+    TextFormatter formatter;
+    std::vector<char> buffer;      // Output not yet written
+    std::vector<char> scratch;     // Formatted text before line breaking
+    uint8_t carry[2];              // Base64 input waiting for a full group
+    size_t carried = 0;
+    size_t column = 0;             // Characters on the current line
+    uint64_t chars_written = 0;
+    bool reader_closed = false;    // A write failed with EPIPE
+
+    void flush();
+    void emit(const char* text, size_t len);
+    void encode(const uint8_t* data, uint64_t bits);
+
+public:
+    /**
+     * @brief Constructor
+     * @param output File descriptor, not closed by the writer
+     * @param writer_options Encoding, line length and buffering
+     * @throw std::invalid_argument if the buffer size is zero
+     */
+    explicit TextWriter(int output, const TextWriterOptions& writer_options = TextWriterOptions());
+
+    TextWriter(const TextWriter&) = delete;
+    TextWriter& operator=(const TextWriter&) = delete;
+
+    /**
+     * @brief Destructor: finish the output if finish() was not called
+     */
+    ~TextWriter();
+
+    /**
+     * @brief Format and queue data
+     * @param data Packed input
+     * @param bits Number of bits, a multiple of 8 unless the encoding is binary
+     * @throw std::invalid_argument if bits is not allowed by the encoding
+     * @throw std::runtime_error on write errors other than EPIPE
+     */
+    void write(const uint8_t* data, uint64_t bits);
+
+    /**
+     * @brief Pad base64, end the last line and write everything out
+     * @throw std::runtime_error on write errors other than EPIPE
+     *
+     * The writer can be used again afterwards, starting a new line.
+     */
+    void finish();
+
+    /**
+     * @brief Get the characters produced so far
+     * @return Count including line breaks and queued output
+     */
+    uint64_t getCharsWritten() const { return chars_written; }
+
+    /**
+     * @brief Check whether the reader has gone away
+     * @return true once a write failed with EPIPE
+     */
+    bool isReaderClosed() const { return reader_closed; }
+};
+
+#endif // TEXT_FORMAT_H